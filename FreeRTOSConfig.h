@@ -63,6 +63,7 @@
 #define configUSE_NEWLIB_REENTRANT 0
 #define configENABLE_BACKWARD_COMPATIBILITY 0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2 /* Index 1 is ir_loopback's verdict */
 
 /* System */
 #define configSTACK_DEPTH_TYPE uint32_t
@@ -75,15 +76,23 @@
 #define configAPPLICATION_ALLOCATED_HEAP 0
 
 /* Hook function related definitions. */
-#define configCHECK_FOR_STACK_OVERFLOW 0
+#define configCHECK_FOR_STACK_OVERFLOW 2 /* Hook in task_monitor.c */
 #define configUSE_MALLOC_FAILED_HOOK 0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
+/* Run time counters are in microseconds from the timer the SDK already runs, one register read
+ * per context switch. They wrap every 71 minutes, task_monitor.c only uses differences. */
+#ifndef __ASSEMBLER__
+#include "hardware/timer.h"
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() time_us_32()
+
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES 0
 #define configMAX_CO_ROUTINE_PRIORITIES 1
@@ -0,0 +1,66 @@
+#include "cmd_gen.hpp"
+
+extern "C" {
+#include "aircon_presets.h"
+#include "pico/stdlib.h"
+}
+
+static constexpr AirconPreset make_preset(AirconMode mode, AirconFanSpeed fan_speed,
+                                          uint8_t temperature) {
+  AirconPreset preset{};
+  preset.state.update_type = AC_UPDATE_AIRCON_MODE;
+  preset.state.mode        = mode;
+  preset.state.fan_speed   = fan_speed;
+  preset.state.temperature = temperature;
+
+  aircon::Frame frame =
+      aircon::encode_frame(AC_UPDATE_AIRCON_MODE, mode, fan_speed, temperature, 0, 0);
+  aircon::Timeline timeline = aircon::encode_timeline(frame);
+  for (size_t i = 0; i < frame.size(); i++) {
+    preset.frame.bytes[i] = frame[i];
+  }
+  for (size_t i = 0; i < timeline.size(); i++) {
+    preset.symbols[i] = timeline[i];
+  }
+  return preset;
+}
+
+// constexpr, so the table is built by the compiler and never copied to RAM at startup
+constexpr AirconPreset aircon_presets[AC_PRESET_COUNT] __in_flash("aircon_presets") = {
+#define AIRCON_PRESET(id, mode, fan_speed, temperature) make_preset(mode, fan_speed, temperature),
+#include "aircon_presets.def"
+#undef AIRCON_PRESET
+};
+
+// Every preset must carry a distinct state, or aircon_preset_find() would only ever return the
+// first of them
+static constexpr bool aircon_presets_distinct() {
+  for (size_t i = 0; i < AC_PRESET_COUNT; i++) {
+    for (size_t j = i + 1; j < AC_PRESET_COUNT; j++) {
+      const AirconState &a = aircon_presets[i].state;
+      const AirconState &b = aircon_presets[j].state;
+      if (a.mode == b.mode && a.fan_speed == b.fan_speed && a.temperature == b.temperature) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(aircon_presets_distinct(), "Duplicate entry in aircon_presets.def");
+
+const struct AirconPreset *aircon_preset_find(enum AirconUpdateType update_type,
+                                              enum AirconMode mode, enum AirconFanSpeed fan_speed,
+                                              uint8_t temperature, uint16_t timer_on_duration,
+                                              uint16_t timer_off_duration) {
+  if (update_type != AC_UPDATE_AIRCON_MODE || timer_on_duration != 0 || timer_off_duration != 0) {
+    return NULL;
+  }
+
+  for (const AirconPreset &preset : aircon_presets) {
+    if (preset.state.mode == mode && preset.state.fan_speed == fan_speed &&
+        preset.state.temperature == temperature) {
+      return &preset;
+    }
+  }
+  return NULL;
+}
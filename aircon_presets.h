@@ -0,0 +1,34 @@
+#ifndef AIRCON_PRESETS_H
+#define AIRCON_PRESETS_H
+
+#include "cmd_gen.h"
+#include "ir_timeline.h"
+#include "stdint.h"
+
+// Ready to transmit frames and symbol timelines for common commands, generated at compile time
+// from aircon_presets.def and kept in flash. The transmitter's DMA reads the timeline straight
+// from XIP, so sending a preset needs no RAM buffer and no encoding. The host test
+// aircon_presets_test checks every preset against the runtime encoders.
+
+enum AirconPresetId {
+#define AIRCON_PRESET(id, mode, fan_speed, temperature) id,
+#include "aircon_presets.def"
+#undef AIRCON_PRESET
+  AC_PRESET_COUNT,
+};
+
+struct AirconPreset {
+  struct AirconState state;
+  struct AirconFrame frame;
+  uint32_t           symbols[IR_TIMELINE_SYMBOL_COUNT];
+};
+
+extern const struct AirconPreset aircon_presets[AC_PRESET_COUNT];
+
+// Returns the preset for a frame, or NULL if it isn't one
+const struct AirconPreset *aircon_preset_find(enum AirconUpdateType update_type,
+                                              enum AirconMode mode, enum AirconFanSpeed fan_speed,
+                                              uint8_t temperature, uint16_t timer_on_duration,
+                                              uint16_t timer_off_duration);
+
+#endif  // AIRCON_PRESETS_H
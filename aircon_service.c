@@ -0,0 +1,245 @@
+#include "aircon_service.h"
+
+#include "FreeRTOS.h"
+#include "event_log.h"
+#include "ir_send.h"
+#include "queue.h"
+#include "task.h"
+
+#define AIRCON_SERVICE_QUEUE_LENGTH 16
+// Requests closer together than this end up in the same frames. A frame is ~0.6 s of airtime,
+// so waiting a fraction of that for a button press burst to finish is cheap.
+#define AIRCON_SERVICE_WINDOW_MS 200
+// A burst that never pauses is still sent this long after its first request
+#define AIRCON_SERVICE_MAX_HOLD_MS 1000
+// Most frames a batch can need: the climate settings and each timer
+#define AIRCON_SERVICE_MAX_FRAMES 3
+
+struct AirconZone {
+  QueueHandle_t queue;
+
+  // `current` is what was last transmitted, `desired` is what requests have asked for
+  struct AirconSettings current;
+  struct AirconSettings desired;
+  bool                  synced;
+
+  struct AirconServiceStats counters;
+};
+
+static struct AirconZone aircon_zones[IR_SEND_MAX_EMITTERS];
+static uint              aircon_zone_count;
+
+void aircon_service_init(const uint *pins, const struct AirconSettings *initial, uint zones) {
+  hard_assert(zones <= IR_SEND_MAX_EMITTERS);
+  ir_send_init(pins, zones);
+
+  for (uint i = 0; i < zones; i++) {
+    struct AirconZone *zone = &aircon_zones[i];
+
+    zone->queue   = xQueueCreate(AIRCON_SERVICE_QUEUE_LENGTH, sizeof(struct AirconRequest));
+    zone->current = initial[i];
+    zone->desired = initial[i];
+    zone->synced  = false;
+    hard_assert(zone->queue != NULL);
+  }
+  aircon_zone_count = zones;
+}
+
+int32_t aircon_service_request(uint zone, struct AirconRequest *request) {
+  if (zone >= aircon_zone_count) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+  request->submitted_us = time_us_32();
+  if (xQueueSend(aircon_zones[zone].queue, request, 0) != pdPASS) {
+    return PICO_ERROR_INSUFFICIENT_RESOURCES;
+  }
+  return PICO_ERROR_NONE;
+}
+
+int32_t aircon_service_set_mode(uint zone, enum AirconMode mode) {
+  struct AirconRequest request = {.fields = AC_REQUEST_MODE, .mode = mode};
+  return aircon_service_request(zone, &request);
+}
+
+int32_t aircon_service_set_fan_speed(uint zone, enum AirconFanSpeed fan_speed) {
+  struct AirconRequest request = {.fields = AC_REQUEST_FAN_SPEED, .fan_speed = fan_speed};
+  return aircon_service_request(zone, &request);
+}
+
+int32_t aircon_service_set_temperature(uint zone, uint8_t temperature) {
+  struct AirconRequest request = {.fields = AC_REQUEST_TEMPERATURE, .temperature = temperature};
+  return aircon_service_request(zone, &request);
+}
+
+int32_t aircon_service_step_temperature(uint zone, int8_t step) {
+  struct AirconRequest request = {.fields           = AC_REQUEST_TEMPERATURE_STEP,
+                                  .temperature_step = step};
+  return aircon_service_request(zone, &request);
+}
+
+int32_t aircon_service_set_timer_on(uint zone, uint16_t minutes) {
+  struct AirconRequest request = {.fields = AC_REQUEST_TIMER_ON, .timer_on_duration = minutes};
+  return aircon_service_request(zone, &request);
+}
+
+int32_t aircon_service_set_timer_off(uint zone, uint16_t minutes) {
+  struct AirconRequest request = {.fields = AC_REQUEST_TIMER_OFF, .timer_off_duration = minutes};
+  return aircon_service_request(zone, &request);
+}
+
+void aircon_service_stats(uint zone, struct AirconServiceStats *stats) {
+  *stats = aircon_zones[zone].counters;
+}
+
+static uint8_t aircon_service_clamp_temperature(int32_t temperature) {
+  return temperature < AC_TEMPERATURE_MIN ? AC_TEMPERATURE_MIN :
+         temperature > AC_TEMPERATURE_MAX ? AC_TEMPERATURE_MAX :
+                                            (uint8_t)temperature;
+}
+
+// Later requests win, steps accumulate on whatever the temperature is by then
+static void aircon_service_apply(struct AirconSettings *settings,
+                                 const struct AirconRequest *request) {
+  if (request->fields & AC_REQUEST_MODE) {
+    settings->mode = request->mode;
+  }
+  if (request->fields & AC_REQUEST_FAN_SPEED) {
+    settings->fan_speed = request->fan_speed;
+  }
+  if (request->fields & AC_REQUEST_TEMPERATURE) {
+    settings->temperature = aircon_service_clamp_temperature(request->temperature);
+  }
+  if (request->fields & AC_REQUEST_TEMPERATURE_STEP) {
+    settings->temperature =
+        aircon_service_clamp_temperature(settings->temperature + request->temperature_step);
+  }
+  if (request->fields & AC_REQUEST_TIMER_ON) {
+    settings->timer_on_duration = request->timer_on_duration & 0xFFF;
+  }
+  if (request->fields & AC_REQUEST_TIMER_OFF) {
+    settings->timer_off_duration = request->timer_off_duration & 0xFFF;
+  }
+}
+
+// Picks the update type of each frame that takes `current` to `desired`, and updates `current`
+// to what the aircon will be set to once they've been sent. Each frame carries the full state;
+// the update type tells the aircon which of it to act on.
+static uint32_t aircon_service_plan(struct AirconSettings *current,
+                                    const struct AirconSettings *desired, bool synced,
+                                    enum AirconUpdateType *frames) {
+  uint32_t count = 0;
+
+  bool mode_changed        = !synced || current->mode != desired->mode;
+  bool fan_speed_changed   = current->fan_speed != desired->fan_speed;
+  bool temperature_changed = current->temperature != desired->temperature;
+
+  // While the aircon stays off, fan and temperature changes wait for the frame that turns it on
+  if (mode_changed || desired->mode != AC_MODE_OFF) {
+    if (mode_changed || (fan_speed_changed && temperature_changed)) {
+      frames[count++] = AC_UPDATE_AIRCON_MODE;
+    } else if (temperature_changed) {
+      frames[count++] =
+          desired->temperature > current->temperature ? AC_UPDATE_TEMP_UP : AC_UPDATE_TEMP_DOWN;
+    } else if (fan_speed_changed) {
+      frames[count++] = AC_UPDATE_FAN_SPEED;
+    }
+    if (count > 0) {
+      current->mode        = desired->mode;
+      current->fan_speed   = desired->fan_speed;
+      current->temperature = desired->temperature;
+    }
+  }
+
+  if (current->timer_on_duration != desired->timer_on_duration) {
+    frames[count++]            = AC_UPDATE_TIMER_ON;
+    current->timer_on_duration = desired->timer_on_duration;
+  }
+  if (current->timer_off_duration != desired->timer_off_duration) {
+    frames[count++]             = AC_UPDATE_TIMER_OFF;
+    current->timer_off_duration = desired->timer_off_duration;
+  }
+
+  return count;
+}
+
+int32_t aircon_service_step(uint zone_index) {
+  if (zone_index >= aircon_zone_count) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+  struct AirconZone *zone = &aircon_zones[zone_index];
+
+  struct AirconRequest request;
+  if (xQueueReceive(zone->queue, &request, portMAX_DELAY) != pdPASS) {
+    return PICO_ERROR_NO_DATA;
+  }
+
+  // Keep merging until no request has arrived for a whole window, or the burst has been held
+  // for the longest it may be
+  uint32_t   requests  = 0;
+  uint32_t   oldest_us = request.submitted_us;
+  TickType_t hold_end  = xTaskGetTickCount() + pdMS_TO_TICKS(AIRCON_SERVICE_MAX_HOLD_MS);
+  do {
+    aircon_service_apply(&zone->desired, &request);
+    requests++;
+    if ((int32_t)(request.submitted_us - oldest_us) < 0) {
+      oldest_us = request.submitted_us;
+    }
+
+    TickType_t now       = xTaskGetTickCount();
+    int32_t    remaining = (int32_t)(hold_end - now);
+    if (remaining > (int32_t)pdMS_TO_TICKS(AIRCON_SERVICE_WINDOW_MS)) {
+      remaining = (int32_t)pdMS_TO_TICKS(AIRCON_SERVICE_WINDOW_MS);
+    }
+    if (remaining <= 0 || xQueueReceive(zone->queue, &request, (TickType_t)remaining) != pdPASS) {
+      break;
+    }
+  } while (1);
+
+  // Settings are only considered sent once they have been, so a refused frame is retried by the
+  // next batch
+  struct AirconSettings next = zone->current;
+  enum AirconUpdateType frames[AIRCON_SERVICE_MAX_FRAMES];
+  uint32_t count = aircon_service_plan(&next, &zone->desired, zone->synced, frames);
+
+  int32_t err = PICO_ERROR_NONE;
+  for (uint32_t i = 0; i < count; i++) {
+    // Returns once the frame is queued in the PIO FIFO, or once the receiver has seen it if the
+    // zone's emitter is loopback checked
+    err = send_aircon_command_blocking(zone_index, frames[i], next.mode, next.fan_speed,
+                                       next.temperature, next.timer_on_duration,
+                                       next.timer_off_duration);
+    if (err) {
+      zone->counters.errors++;
+      break;
+    }
+
+    uint32_t latency               = time_us_32() - oldest_us;
+    zone->counters.last_latency_us = latency;
+    if (latency > zone->counters.max_latency_us) {
+      zone->counters.max_latency_us = latency;
+    }
+    zone->counters.frames++;
+    EVENT_LOG3(LOG_AIRCON_FRAME, zone_index << 8 | frames[i], requests, latency);
+  }
+
+  if (err == PICO_ERROR_NONE) {
+    zone->current = next;
+    zone->synced  = true;
+  }
+
+  zone->counters.requests += requests;
+  zone->counters.batches++;
+  if (requests > count) {
+    zone->counters.saved += requests - count;
+  }
+
+  return err == PICO_ERROR_NONE ? (int32_t)count : err;
+}
+
+void aircon_service_task(void *params) {
+  uint zone = (uint)(uintptr_t)params;
+
+  while (1) {
+    aircon_service_step(zone);
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef AIRCON_SERVICE_H
+#define AIRCON_SERVICE_H
+
+#include "cmd_gen.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+
+// Owns the IR emitters. Any task can request changes to the aircon's settings; the service
+// applies them to a desired state and, once requests have stopped arriving for a short window,
+// sends the fewest frames that bring the aircon from its last transmitted state to the desired
+// one. Every frame carries the full state, so a burst of requests rarely costs more than one. A
+// burst that keeps going is sent after at most a second, so it can't hold the aircon off.
+//
+// Each zone is one indoor unit with its own emitter (see ir_send.h), request queue, state and
+// task, so zones never wait on each other.
+
+#define AC_TEMPERATURE_MIN 16
+#define AC_TEMPERATURE_MAX 32
+
+struct AirconSettings {
+  uint8_t  mode;       // enum AirconMode
+  uint8_t  fan_speed;  // enum AirconFanSpeed
+  uint8_t  temperature;
+  uint16_t timer_on_duration;  // Minutes, 0 for none
+  uint16_t timer_off_duration;
+};
+
+enum AirconRequestField {
+  AC_REQUEST_MODE             = 1 << 0,
+  AC_REQUEST_FAN_SPEED        = 1 << 1,
+  AC_REQUEST_TEMPERATURE      = 1 << 2,  // Absolute
+  AC_REQUEST_TEMPERATURE_STEP = 1 << 3,  // Relative to the desired temperature
+  AC_REQUEST_TIMER_ON         = 1 << 4,
+  AC_REQUEST_TIMER_OFF        = 1 << 5,
+};
+
+struct AirconRequest {
+  uint8_t  fields;  // enum AirconRequestField bits
+  uint8_t  mode;
+  uint8_t  fan_speed;
+  uint8_t  temperature;
+  int8_t   temperature_step;
+  uint16_t timer_on_duration;
+  uint16_t timer_off_duration;
+  uint32_t submitted_us;  // Set by aircon_service_request()
+};
+
+struct AirconServiceStats {
+  uint32_t requests;  // Requests taken off the queue
+  uint32_t batches;   // Windows that were merged and planned
+  uint32_t frames;    // Frames transmitted
+  uint32_t saved;     // Transmissions saved by merging, requests minus frames per batch
+  uint32_t errors;    // Frames the transmitter refused
+  // From the oldest request behind a frame to the frame being handed to the transmitter
+  uint32_t last_latency_us;
+  uint32_t max_latency_us;
+};
+
+// Sets up an emitter on each pin and a zone for each emitter. `initial` holds what each aircon
+// is assumed to be set to; the first batch for a zone always sends the climate settings since
+// nothing confirms that assumption. Call once, before the tasks start.
+void aircon_service_init(const uint *pins, const struct AirconSettings *initial, uint zones);
+
+// Queues a request for a zone without blocking. Returns PICO_ERROR_INSUFFICIENT_RESOURCES if the
+// zone's queue is full. Safe from any task on either core.
+int32_t aircon_service_request(uint zone, struct AirconRequest *request);
+
+int32_t aircon_service_set_mode(uint zone, enum AirconMode mode);
+int32_t aircon_service_set_fan_speed(uint zone, enum AirconFanSpeed fan_speed);
+int32_t aircon_service_set_temperature(uint zone, uint8_t temperature);
+int32_t aircon_service_step_temperature(uint zone, int8_t step);
+int32_t aircon_service_set_timer_on(uint zone, uint16_t minutes);
+int32_t aircon_service_set_timer_off(uint zone, uint16_t minutes);
+
+// Counters are updated by the zone's task only, individually consistent
+void aircon_service_stats(uint zone, struct AirconServiceStats *stats);
+
+// One batch for a zone: waits for a request, merges everything that follows it until the window
+// passes without one, and transmits the result. Returns the number of frames sent, or an error.
+// The zone's task calls this in a loop. Exposed for harnesses that step the service themselves.
+int32_t aircon_service_step(uint zone);
+
+// One task per zone. `params` is the zone index, cast to a pointer.
+void aircon_service_task(void *params);
+
+#endif  // AIRCON_SERVICE_H
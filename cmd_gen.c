@@ -5,16 +5,20 @@
 const uint8_t command_preamble[3]                = {0x01, 0x10, 0x00};
 uint8_t       command_buffer[COMMAND_BYTE_COUNT] = {0};
 
-uint8_t decomposed_buffer[COMMAND_BYTE_COUNT] = {0};
-
-uint8_t *populate_command_buffer(enum AirconUpdateType update_type, enum AirconMode mode,
-                                 enum AirconFanSpeed fan_speed, uint8_t temperature,
-                                 uint16_t timer_on_duration, uint16_t timer_off_duration) {
-  printf(
-      "Update Type %u, Aircon Mode: %u, Fan Speed %u, Temperature %u, On Duration %u, Off Duration "
-      "%u\n",
-      update_type, mode, fan_speed, temperature, timer_on_duration, timer_off_duration);
+// Expands four data bytes into their data/inverse pairs, two output words at a time.
+// Assumes a little endian target (RP2040 and the host).
+static inline void aircon_frame_pair_word(uint8_t *out, uint32_t data) {
+  uint32_t lo = (data & 0x000000FF) | ((data & 0x0000FF00) << 8);
+  uint32_t hi = ((data >> 16) & 0x000000FF) | ((data >> 8) & 0x00FF0000);
+  lo |= (~lo & 0x00FF00FF) << 8;
+  hi |= (~hi & 0x00FF00FF) << 8;
+  memcpy(out, &lo, sizeof(lo));
+  memcpy(out + 4, &hi, sizeof(hi));
+}
 
+void aircon_frame_encode(struct AirconFrame *frame, enum AirconUpdateType update_type,
+                         enum AirconMode mode, enum AirconFanSpeed fan_speed, uint8_t temperature,
+                         uint16_t timer_on_duration, uint16_t timer_off_duration) {
   uint8_t raw_data_buffer[COMMAND_DATA_COUNT] = {0};
 
   raw_data_buffer[0]  = 0x40;                             // Constant
@@ -53,301 +57,157 @@ uint8_t *populate_command_buffer(enum AirconUpdateType update_type, enum AirconM
 
   // Convert to command buffer
   // Every second byte after the first three are the bitwise inverse of the first byte in a pair
-  command_buffer[0] = command_preamble[0];
-  command_buffer[1] = command_preamble[1];
-  command_buffer[2] = command_preamble[2];
-  for (uint8_t i = 0; i < COMMAND_DATA_COUNT; i++) {
-    command_buffer[2 * i + 3] = raw_data_buffer[i];
-    command_buffer[2 * i + 4] = ~raw_data_buffer[i];
+  uint8_t *bytes = frame->bytes;
+  bytes[0]       = command_preamble[0];
+  bytes[1]       = command_preamble[1];
+  bytes[2]       = command_preamble[2];
+
+  uint8_t i = 0;
+  for (; i + 4 <= COMMAND_DATA_COUNT; i += 4) {
+    uint32_t data;
+    memcpy(&data, &raw_data_buffer[i], sizeof(data));
+    aircon_frame_pair_word(&bytes[2 * i + 3], data);
+  }
+  for (; i < COMMAND_DATA_COUNT; i++) {
+    bytes[2 * i + 3] = raw_data_buffer[i];
+    bytes[2 * i + 4] = ~raw_data_buffer[i];
   }
+}
 
+uint8_t *populate_command_buffer(enum AirconUpdateType update_type, enum AirconMode mode,
+                                 enum AirconFanSpeed fan_speed, uint8_t temperature,
+                                 uint16_t timer_on_duration, uint16_t timer_off_duration) {
+  aircon_frame_encode((struct AirconFrame *)command_buffer, update_type, mode, fan_speed,
+                      temperature, timer_on_duration, timer_off_duration);
   return command_buffer;
 }
 
-bool check_symbol(bool logic_level, uint32_t duration_us, bool expected_level, uint32_t min_us,
-                  uint32_t max_us) {
-  return logic_level == expected_level && duration_us >= min_us && duration_us <= max_us;
+// Frame offset of a data byte (the parity byte follows it)
+#define AC_DATA(i)     (3 + 2 * (i))
+#define AC_FRAME_WORDS ((COMMAND_BYTE_COUNT + 3) / 4)
+
+// Expected value and mask for every bit of the frame that doesn't carry state
+static const uint8_t frame_expected[AC_FRAME_WORDS * 4] __attribute__((aligned(4))) = {
+    [0] = 0x01,           [1] = 0x10,           [2] = 0x00,           [AC_DATA(0)] = 0x40,
+    [AC_DATA(1)] = 0xFF,  [AC_DATA(2)] = 0xCC,  [AC_DATA(3)] = 0x92,  [AC_DATA(6)] = 0x00,
+    [AC_DATA(13)] = 0x00, [AC_DATA(14)] = 0x00, [AC_DATA(15)] = 0x80, [AC_DATA(16)] = 0x03,
+    [AC_DATA(17)] = 0x01, [AC_DATA(18)] = 0x88, [AC_DATA(19)] = 0x00, [AC_DATA(20)] = 0x00,
+    [AC_DATA(21)] = 0xFF, [AC_DATA(22)] = 0xFF, [AC_DATA(23)] = 0xFF, [AC_DATA(24)] = 0xFF,
+};
+static const uint8_t frame_mask[AC_FRAME_WORDS * 4] __attribute__((aligned(4))) = {
+    [0] = 0xFF,           [1] = 0xFF,           [2] = 0xFF,           [AC_DATA(0)] = 0xFF,
+    [AC_DATA(1)] = 0xFF,  [AC_DATA(2)] = 0xFF,  [AC_DATA(3)] = 0xFF,  [AC_DATA(5)] = 0x03,
+    [AC_DATA(6)] = 0xFF,  [AC_DATA(7)] = 0x0F,  [AC_DATA(10)] = 0xC0, [AC_DATA(13)] = 0xFF,
+    [AC_DATA(14)] = 0xFF, [AC_DATA(15)] = 0xFF, [AC_DATA(16)] = 0xFF, [AC_DATA(17)] = 0xFF,
+    [AC_DATA(18)] = 0xFF, [AC_DATA(19)] = 0xFF, [AC_DATA(20)] = 0xFF, [AC_DATA(21)] = 0xFF,
+    [AC_DATA(22)] = 0xFF, [AC_DATA(23)] = 0xFF, [AC_DATA(24)] = 0xFF,
+};
+
+static inline uint32_t load_word(const uint8_t *bytes) {
+  uint32_t word;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
 }
 
-void decompose_input(bool logic_level, uint32_t duration_us) {
-  // Decoding the preamble
-  static uint8_t preamble_stage = 0;
-  if (preamble_stage == 0 && logic_level == true) {
-    // This is the time between boot at the start of a packet. We can ignore this.
-    return;
-  } else if (preamble_stage == 0 && check_symbol(logic_level, duration_us, false, 28000, 31000)) {
-    preamble_stage++;
-    return;
-  } else if (preamble_stage == 1 && check_symbol(logic_level, duration_us, true, 48000, 51000)) {
-    preamble_stage++;
-    return;
-  } else if (preamble_stage == 2 && check_symbol(logic_level, duration_us, false, 3300, 3500)) {
-    preamble_stage++;
-    return;
-  } else if (preamble_stage == 3 && check_symbol(logic_level, duration_us, true, 1600, 1700)) {
-    preamble_stage++;
-    return;
-  } else if (preamble_stage == 4) {
-    // Continue to decoding the incoming data
-  } else {
-    printf("Failed preamble check at stage %u\n", preamble_stage);
-    printf("Got %u for %u us\n", logic_level, duration_us);
-    printf("Halting system\n");
-    while (1);
-  }
-
-  // Decoding bytes
-  static uint32_t byte_index          = 0;
-  static uint8_t  incoming_byte       = 0;
-  static uint8_t  incoming_byte_index = 0;
-
-  static bool expected_logic_level = false;
-  static bool parity_byte          = false;
+uint32_t aircon_frame_validate(const struct AirconFrame *frame) {
+  uint8_t padded[AC_FRAME_WORDS * 4] __attribute__((aligned(4))) = {0};
+  memcpy(padded, frame->bytes, COMMAND_BYTE_COUNT);
 
-  // First we need to read in a single byte
-  // Then we need to read in the parity byte
-  if (expected_logic_level == false) {
-    // This is a 38kHz pulse on the LED
-    // The duration is always the same
-    if (check_symbol(logic_level, duration_us, false, 400, 470)) {
-      // Not information
-    } else if (logic_level == false) {
-      // Malformed packet
-      printf("Logic low symbol fell outside of expected duration: %uus for logic low\n",
-             duration_us);
-      printf("Halting system\n");
-      while (1);
-    }
-    expected_logic_level = true;
-  } else if (expected_logic_level == true) {
-    // This is a break in the LED signal
-    // The duration indicates either a zero or a one in the transmission
-    if (check_symbol(logic_level, duration_us, true, 390, 450)) {
-      // Logic zero
-      incoming_byte |= 0 << incoming_byte_index;  // Does nothing
-      printf("Received bit 0\n");
-    } else if (check_symbol(logic_level, duration_us, true, 1230, 1290)) {
-      // Logic one
-      incoming_byte |= 1 << incoming_byte_index;  // Shift 1 into the register
-      printf("Received bit 1\n");
-    } else {
-      printf("Logic high symbol fell outside of expected duration: %uus for logic high\n",
-             duration_us);
-      printf("Halting system\n");
-      while (1);
-    }
-    expected_logic_level = false;
-    if (++incoming_byte_index >= 8) {
-      if (byte_index < 3) {
-        // First three bytes aren't data/parity pairs
-        printf("Received preamble byte %u (0x%X)\n", byte_index, incoming_byte);
-        decomposed_buffer[byte_index] = incoming_byte;
-        byte_index++;
-        incoming_byte       = 0;
-        incoming_byte_index = 0;
-        return;  // Return to skip parity byte swapover
-      } else if (!parity_byte) {
-        // Save raw data byte
-        decomposed_buffer[byte_index] = incoming_byte;
-        printf("Received data byte %d (0x%X)\n", byte_index, decomposed_buffer[byte_index] & 0xFF);
-        byte_index++;
-      } else if (parity_byte && decomposed_buffer[byte_index - 1] != (~incoming_byte & 0xFF)) {
-        // Parity byte failed check
-        printf("Parity Byte Failure: data 0x%X, parity 0x%X\n", decomposed_buffer[byte_index],
-               incoming_byte);
-        printf("Parity Byte value: %u, inverted 0x%X\n", parity_byte, (~incoming_byte & 0xFF));
-        printf("Halting system\n");
-        while (1);
-      } else {
-        // Parity byte check passed
-        printf("Parsed byte %u, with value 0x%X against parity byte (0x%X)\n", byte_index,
-               decomposed_buffer[byte_index - 1], incoming_byte);
-        decomposed_buffer[byte_index] = incoming_byte;
-        byte_index++;
-      }
-      parity_byte         = !parity_byte;
-      incoming_byte       = 0;
-      incoming_byte_index = 0;
-    }
+  // Constant fields, a word at a time. Word 0 also holds the preamble.
+  uint32_t diff     = (load_word(padded) ^ load_word(frame_expected)) & load_word(frame_mask);
+  uint32_t preamble = diff & 0x00FFFFFF;
+  uint32_t constant = diff & 0xFF000000;
+  for (int i = 4; i < AC_FRAME_WORDS * 4; i += 4) {
+    constant |= (load_word(&padded[i]) ^ load_word(&frame_expected[i])) & load_word(&frame_mask[i]);
   }
 
-  // Reset the calculation
-  if (byte_index == COMMAND_BYTE_COUNT) {  // Checked after byte_index++, so -1 isn't needed
-    parse_command_buffer(decomposed_buffer);
-    byte_index     = 0;
-    preamble_stage = 0;
-    parity_byte    = false;
-    memset(decomposed_buffer, 0, COMMAND_BYTE_COUNT);
-    printf("Full message received\n");
+  // Each data byte XOR its parity byte must be 0xFF. The 25 pairs start at byte 3, so check
+  // them as 16 bit lanes over 12 words and a trailing half word.
+  uint32_t parity = 0;
+  for (int i = AC_DATA(0); i + 4 <= AC_DATA(COMMAND_DATA_COUNT - 1); i += 4) {
+    uint32_t word = load_word(&padded[i]);
+    parity |= ((word ^ (word >> 8)) & 0x00FF00FF) ^ 0x00FF00FF;
   }
+  const int last = AC_DATA(COMMAND_DATA_COUNT - 1);
+  parity |= (padded[last] ^ padded[last + 1]) ^ 0xFF;
+
+  return (preamble != 0) * AC_FRAME_PREAMBLE | (constant != 0) * AC_FRAME_CONSTANT |
+         (parity != 0) * AC_FRAME_PARITY;
 }
 
-void parse_command_buffer(uint8_t *command_buffer) {
-  printf("----------------------------------\n");
-  printf("Beginning to parse command buffer!\n");
-  printf("----------------------------------\n");
-  // Convert command buffer into plain text description
-  // Also check that other bits aren't unexpectedly high
-  if (command_buffer[3] != 0x40) {
-    printf("command_buffer[0] != 0x40! 0x%X\n", command_buffer[3]);  // Const
-  }
-  if (command_buffer[5] != 0xFF) {
-    printf("command_buffer[1] != 0xFF! 0x%X\n", command_buffer[5]);  // Const
-  }
-  if (command_buffer[7] != 0xCC) {
-    printf("command_buffer[2] != 0xCC! 0x%X\n", command_buffer[7]);  // Const
-  }
-  if (command_buffer[9] != 0x92) {
-    printf("command_buffer[3] != 0x92! 0x%X\n", command_buffer[9]);  // Const
+uint32_t aircon_frame_decode(const struct AirconFrame *frame, struct AirconState *state) {
+  const uint8_t *bytes      = frame->bytes;
+  uint32_t       violations = aircon_frame_validate(frame);
+
+  state->update_type        = bytes[AC_DATA(4)];
+  state->temperature        = bytes[AC_DATA(5)] >> 2;
+  state->timer_off_duration = ((uint16_t)bytes[AC_DATA(8)] << 4) | (bytes[AC_DATA(7)] >> 4);
+  state->timer_on_duration  = ((uint16_t)(bytes[AC_DATA(10)] & 0xF) << 8) | bytes[AC_DATA(9)];
+  state->fan_speed          = bytes[AC_DATA(11)] >> 4;
+  state->mode               = bytes[AC_DATA(11)] & 0xF;
+
+  // Off is sent as heating with a different mode flags byte
+  uint8_t mode_flags = bytes[AC_DATA(12)];
+  if (mode_flags == 0xE1) {
+    state->mode = AC_MODE_OFF;
   }
 
-  // Update Type
-  switch (command_buffer[11]) {
+  switch (state->update_type) {
     case AC_UPDATE_AIRCON_MODE:
-      printf("    Update: Mode\n");
-      break;
     case AC_UPDATE_TIMER_ON:
-      printf("    Update: Timer On\n");
-      break;
     case AC_UPDATE_TIMER_OFF:
-      printf("    Update: Timer Off\n");
-      break;
     case AC_UPDATE_FAN_SPEED:
-      printf("    Update: Fan Speed\n");
-      break;
     case AC_UPDATE_TEMP_DOWN:
-      printf("    Update: Temperature Down\n");
-      break;
     case AC_UPDATE_TEMP_UP:
-      printf("    Update: Temperature Up\n");
-      break;
     case AC_UPDATE_FIN_DIR:
-      printf("    Update: Fin Direction\n");
       break;
     default:
-      printf("    Update: UNKNOWN!!!! 0x%X\n", command_buffer[4]);
+      violations |= AC_FRAME_UPDATE_TYPE;
       break;
   }
 
-  // Temperature
-  printf("    Temperature 0x%X\n", command_buffer[13] >> 2);
-
-  if (command_buffer[15] != 0x00) {
-    printf("command_buffer[6] != 0x00!\n");  // Const
-  }
-
-  uint16_t timer_off_duration = ((uint16_t)command_buffer[19]) << 8 | command_buffer[17] >> 4;
-  printf("    Timer Off Duration 0x%X\n", timer_off_duration);
-  if (command_buffer[17] & 0xF != 0) {
-    printf("command_buffer[7] contains additional data!\n");
-  }
-
-  uint16_t timer_on_duration = (((uint16_t)command_buffer[23]) << 8) & 0xF | command_buffer[21];
-  printf("    Timer On Duration 0x%X\n", timer_on_duration);
-  if (command_buffer[23] & 0xC0 != 0) {
-    printf("command_buffer[10] contains additional data!\n");
-  }
-
-  printf("    Timer On Flag 0x%X\n", command_buffer[23] & 0x20);
-  printf("    Timer Off Flag 0x%X\n", command_buffer[23] & 0x10);
-
-  // Mode
-  switch (command_buffer[25] & 0xF) {
+  uint8_t expected_flags;
+  switch (state->mode) {
     case AC_MODE_OFF:
-      printf("    Mode: OFF\n");
-      break;
-    case AC_MODE_VENTILATION:
-      printf("    Mode: VENTILATION\n");
+      expected_flags = 0xE1;
       break;
     case AC_MODE_COOLING:
-      printf("    Mode: COOLING\n");
+    case AC_MODE_HEATING:
+      expected_flags = 0xF1;
       break;
+    case AC_MODE_VENTILATION:
     case AC_MODE_DEHUMIDIFY:
-      printf("    Mode: DEHUMIDIFY\n");
-      break;
-    case AC_MODE_HEATING:
-      printf("    Mode: HEATING\n");
+      expected_flags = 0xF0;
       break;
     default:
-      printf("    Mode: UNKNOWN!!!! 0x%X\n", command_buffer[25] & 0xF);
+      violations |= AC_FRAME_MODE;
+      expected_flags = mode_flags;
       break;
   }
-
-  // Fan Speed
-  switch (command_buffer[25] >> 4) {
-    case AC_FAN_0:
-      printf("    Fan Speed: 0\n");
-      break;
-    case AC_FAN_1:
-      printf("    Fan Speed: 1\n");
-      break;
-    case AC_FAN_2:
-      printf("    Fan Speed: 2\n");
-      break;
-    case AC_FAN_3:
-      printf("    Fan Speed: 3\n");
-      break;
-    case AC_FAN_5:
-      printf("    Fan Speed: 5\n");
-      break;
-    case AC_FAN_AUTO:
-      printf("    Fan Speed: AUTO\n");
-      break;
-    default:
-      printf("    Fan Speed: UNKNOWN!!!! 0x%x\n", command_buffer[25] >> 4);
-      break;
+  if (mode_flags != expected_flags) {
+    violations |= AC_FRAME_MODE;
   }
 
-  // Mode thing?
-  switch (command_buffer[27]) {
-    case 0xE1:
-      printf("    Mode Thing: OFF\n");
-      break;
-    case 0xF1:
-      printf("    Mode Thing: Heating/Cooling\n");
-      break;
-    case 0xF0:
-      printf("    Mode Thing: Everything Else\n");
-      break;
-    default:
-      printf("    Mode Thing: UNKNOWN!!!! 0x%X\n", command_buffer[27]);
-      break;
+  if (state->fan_speed < AC_FAN_0 || state->fan_speed > AC_FAN_5) {
+    violations |= AC_FRAME_FAN_SPEED;
   }
 
-  if (command_buffer[29] != 0x00) {
-    printf("command_buffer[13] != 0x00! (0x%X)\n", command_buffer[29]);  // Const
-  }
-  if (command_buffer[31] != 0x00) {
-    printf("command_buffer[14] != 0x00! (0x%X)\n", command_buffer[31]);  // Const
-  }
-  if (command_buffer[33] != 0x80) {
-    printf("command_buffer[15] != 0x80! (0x%X)\n", command_buffer[33]);  // Const
-  }
-  if (command_buffer[35] != 0x03) {
-    printf("command_buffer[16] != 0x03! (0x%X)\n", command_buffer[35]);  // Const
-  }
-  if (command_buffer[37] != 0x01) {
-    printf("command_buffer[17] != 0x01! (0x%X)\n", command_buffer[37]);  // Const
-  }
-  if (command_buffer[39] != 0x88) {
-    printf("command_buffer[18] != 0x88! (0x%X)\n", command_buffer[39]);  // Const
-  }
-  if (command_buffer[41] != 0x00) {
-    printf("command_buffer[19] != 0x00! (0x%X)\n", command_buffer[41]);  // Const
-  }
-  if (command_buffer[43] != 0x00) {
-    printf("command_buffer[20] != 0x00! (0x%X)\n", command_buffer[43]);  // Const
-  }
-  if (command_buffer[45] != 0xFF) {
-    printf("command_buffer[21] != 0xFF! (0x%X)\n", command_buffer[45]);  // Const
+  bool timer_off_flag = bytes[AC_DATA(10)] & 0x10;
+  bool timer_on_flag  = bytes[AC_DATA(10)] & 0x20;
+  if (timer_off_flag != (state->timer_off_duration > 0) ||
+      timer_on_flag != (state->timer_on_duration > 0)) {
+    violations |= AC_FRAME_TIMER;
   }
-  if (command_buffer[47] != 0xFF) {
-    printf("command_buffer[22] != 0xFF! (0x%X)\n", command_buffer[47]);  // Const
-  }
-  if (command_buffer[49] != 0xFF) {
-    printf("command_buffer[23] != 0xFF! (0x%X)\n", command_buffer[49]);  // Const
-  }
-  if (command_buffer[51] != 0xFF) {
-    printf("command_buffer[24] != 0xFF! (0x%X)\n", command_buffer[51]);  // Const
-  }
-}
\ No newline at end of file
+
+  return violations;
+}
+
+void parse_command_buffer(uint8_t *command_buffer) {
+  struct AirconState state;
+  uint32_t violations = aircon_frame_decode((const struct AirconFrame *)command_buffer, &state);
+
+  printf("Update 0x%02X, Mode 0x%X, Fan Speed 0x%X, Temperature %u, On Duration %u, Off Duration "
+         "%u, Violations 0x%02X\n",
+         state.update_type, state.mode, state.fan_speed, state.temperature,
+         state.timer_on_duration, state.timer_off_duration, violations);
+}
@@ -34,12 +34,48 @@ enum AirconFanSpeed {
   AC_FAN_5    = 0x6,
 };
 
+struct AirconFrame {
+  uint8_t bytes[COMMAND_BYTE_COUNT];
+};
+
+// Decoded contents of a frame
+struct AirconState {
+  uint8_t  update_type;            // enum AirconUpdateType
+  uint8_t  mode               : 4;  // enum AirconMode
+  uint8_t  fan_speed          : 4;  // enum AirconFanSpeed
+  uint8_t  temperature;
+  uint16_t timer_on_duration  : 12;
+  uint16_t timer_off_duration : 12;
+};
+
+// Violation bits returned by aircon_frame_validate() and aircon_frame_decode()
+enum AirconFrameViolation {
+  AC_FRAME_PREAMBLE    = 1 << 0,  // Leading three bytes
+  AC_FRAME_CONSTANT    = 1 << 1,  // Constant bytes or reserved bits
+  AC_FRAME_PARITY      = 1 << 2,  // A parity byte isn't the inverse of its data byte
+  AC_FRAME_UPDATE_TYPE = 1 << 3,  // Unknown update type
+  AC_FRAME_MODE        = 1 << 4,  // Unknown mode, or mode flags byte doesn't match the mode
+  AC_FRAME_FAN_SPEED   = 1 << 5,  // Unknown fan speed
+  AC_FRAME_TIMER       = 1 << 6,  // Timer enable flags don't match the durations
+};
+
+// Reentrant encoder, writes the full frame including preamble and parity bytes
+void aircon_frame_encode(struct AirconFrame *frame, enum AirconUpdateType update_type,
+                         enum AirconMode mode, enum AirconFanSpeed fan_speed, uint8_t temperature,
+                         uint16_t timer_on_duration, uint16_t timer_off_duration);
+
+// Encodes into a shared static buffer. Not reentrant.
 uint8_t *populate_command_buffer(enum AirconUpdateType update_type, enum AirconMode mode,
                                  enum AirconFanSpeed fan_speed, uint8_t temperature,
                                  uint16_t timer_on_duration, uint16_t timer_off_duration);
 
-void decompose_input(bool logic_level, uint32_t duration_us);
+// Checks preamble, constants and parity against a compile time table. Returns violation bits.
+uint32_t aircon_frame_validate(const struct AirconFrame *frame);
+
+// Validates the frame and unpacks its state. Returns violation bits, 0 for a well formed frame.
+uint32_t aircon_frame_decode(const struct AirconFrame *frame, struct AirconState *state);
 
+// Prints the decoded frame
 void parse_command_buffer(uint8_t *command_buffer);
 
 #endif  // CMD_GEN
\ No newline at end of file
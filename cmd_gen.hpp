@@ -0,0 +1,96 @@
+#ifndef CMD_GEN_HPP
+#define CMD_GEN_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ir_protocol.hpp"
+
+extern "C" {
+#include "cmd_gen.h"
+#include "ir_timeline.h"
+}
+
+// constexpr versions of aircon_frame_encode() and ir_timeline_encode(), for frames that are known
+// at build time. They produce byte for byte the same output as the runtime encoders.
+
+namespace aircon {
+
+using Frame    = std::array<uint8_t, COMMAND_BYTE_COUNT>;
+using Timeline = std::array<uint32_t, IR_TIMELINE_SYMBOL_COUNT>;
+
+constexpr Frame encode_frame(AirconUpdateType update_type, AirconMode mode,
+                             AirconFanSpeed fan_speed, uint8_t temperature,
+                             uint16_t timer_on_duration, uint16_t timer_off_duration) {
+  std::array<uint8_t, COMMAND_DATA_COUNT> data{};
+
+  data[0]  = 0x40;
+  data[1]  = 0xFF;
+  data[2]  = 0xCC;
+  data[3]  = 0x92;
+  data[4]  = static_cast<uint8_t>(update_type);
+  data[5]  = static_cast<uint8_t>(temperature << 2);
+  data[7]  = static_cast<uint8_t>((timer_off_duration & 0xF) << 4);
+  data[8]  = static_cast<uint8_t>((timer_off_duration >> 4) & 0xFF);
+  data[9]  = static_cast<uint8_t>(timer_on_duration & 0xFF);
+  data[10] = static_cast<uint8_t>(((timer_on_duration >> 8) & 0xF) |
+                                  ((timer_off_duration > 0) << 4) | ((timer_on_duration > 0) << 5));
+  // Off is sent as heating with its own mode flags
+  data[11] =
+      static_cast<uint8_t>((fan_speed << 4) | (mode == AC_MODE_OFF ? AC_MODE_HEATING : mode));
+  data[12] = mode == AC_MODE_OFF                                ? 0xE1 :
+             mode == AC_MODE_HEATING || mode == AC_MODE_COOLING ? 0xF1 :
+                                                                  0xF0;
+  data[15] = 0x80;
+  data[16] = 0x03;
+  data[17] = 0x01;
+  data[18] = 0x88;
+  data[21] = 0xFF;
+  data[22] = 0xFF;
+  data[23] = 0xFF;
+  data[24] = 0xFF;
+
+  Frame frame{0x01, 0x10, 0x00};
+  for (size_t i = 0; i < COMMAND_DATA_COUNT; i++) {
+    frame[2 * i + 3] = data[i];
+    frame[2 * i + 4] = static_cast<uint8_t>(~data[i]);
+  }
+  return frame;
+}
+
+constexpr Timeline encode_timeline(const Frame &frame) {
+  Timeline timeline{};
+  ir::Encoder<ir::Shirokuma>::encode(frame.data(), timeline.data());
+  return timeline;
+}
+
+// std::array's == isn't constexpr until C++20
+constexpr bool frames_equal(const Frame &a, const Frame &b) {
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Frames captured from aircon_frame_encode(), to hold the two encoders together
+static_assert(frames_equal(
+    encode_frame(AC_UPDATE_AIRCON_MODE, AC_MODE_OFF, AC_FAN_AUTO, 25, 0, 0),
+    Frame{0x01, 0x10, 0x00, 0x40, 0xBF, 0xFF, 0x00, 0xCC, 0x33, 0x92, 0x6D,
+          0x13, 0xEC, 0x64, 0x9B, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00,
+          0xFF, 0x00, 0xFF, 0x56, 0xA9, 0xE1, 0x1E, 0x00, 0xFF, 0x00, 0xFF,
+          0x80, 0x7F, 0x03, 0xFC, 0x01, 0xFE, 0x88, 0x77, 0x00, 0xFF, 0x00,
+          0xFF, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00}));
+static_assert(frames_equal(
+    encode_frame(AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 24, 0, 0),
+    Frame{0x01, 0x10, 0x00, 0x40, 0xBF, 0xFF, 0x00, 0xCC, 0x33, 0x92, 0x6D,
+          0x13, 0xEC, 0x60, 0x9F, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00,
+          0xFF, 0x00, 0xFF, 0x53, 0xAC, 0xF1, 0x0E, 0x00, 0xFF, 0x00, 0xFF,
+          0x80, 0x7F, 0x03, 0xFC, 0x01, 0xFE, 0x88, 0x77, 0x00, 0xFF, 0x00,
+          0xFF, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00}));
+
+}  // namespace aircon
+
+#endif  // CMD_GEN_HPP
@@ -0,0 +1,54 @@
+#include "core_partition.h"
+
+#if CORE_PARTITION
+
+#include "lwip/opt.h"
+
+// Tasks that aren't ours to create. The cyw43 driver's async context is pinned to the core that
+// brought up the network already, and its interrupt with it, but lwIP's threads and the timer
+// daemon would otherwise run anywhere.
+static const char *const core_partition_system_tasks[] = {
+    configTIMER_SERVICE_TASK_NAME,
+    "async_context_task",
+    TCPIP_THREAD_NAME,
+    "ping_thread",
+};
+
+static uint core_partition_core(enum CoreRole role) {
+  return role == CORE_ROLE_IR ? CORE_PARTITION_IR_CORE : CORE_PARTITION_SYSTEM_CORE;
+}
+
+void core_partition_pin(TaskHandle_t task, enum CoreRole role) {
+  vTaskCoreAffinitySet(task, 1u << core_partition_core(role));
+}
+
+void core_partition_pin_system_tasks() {
+  for (uint i = 0; i < count_of(core_partition_system_tasks); i++) {
+    TaskHandle_t task = xTaskGetHandle(core_partition_system_tasks[i]);
+    if (task != NULL) {
+      core_partition_pin(task, CORE_ROLE_SYSTEM);
+    }
+  }
+}
+
+static void core_partition_irq_task(void *params) {
+  irq_set_enabled((uint)(uintptr_t)params, true);
+  vTaskDelete(NULL);
+}
+
+void core_partition_enable_irq(uint irq, enum CoreRole role) {
+  uint core = core_partition_core(role);
+  if (get_core_num() == core) {
+    irq_set_enabled(irq, true);
+    return;
+  }
+
+  // Above every other task, so it runs as soon as the core is free
+  TaskHandle_t task;
+  BaseType_t   created = xTaskCreateAffinitySet(
+      core_partition_irq_task, "IrqEnableTask", configMINIMAL_STACK_SIZE, (void *)(uintptr_t)irq,
+      configMAX_PRIORITIES - 1, 1u << core, &task);
+  hard_assert(created == pdPASS);
+}
+
+#endif  // CORE_PARTITION
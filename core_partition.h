@@ -0,0 +1,51 @@
+#ifndef CORE_PARTITION_H
+#define CORE_PARTITION_H
+
+#include "FreeRTOS.h"
+#include "hardware/irq.h"
+#include "pico/stdlib.h"
+#include "task.h"
+
+// Which core runs what. The SMP scheduler runs an unpinned task on either core, and each
+// interrupt is taken by the core that enabled it in its own NVIC. So by default the cyw43 and
+// lwIP work can preempt the IR tasks, and its interrupts can hold off theirs. Built with
+// -DCORE_PARTITION=ON, the IR transmit and receive tasks and their interrupts get core 1 to
+// themselves, and the network, sensor and logging work all runs on core 0 with the tick. Without
+// it these calls only enable interrupts on the calling core, as the modules did before.
+//
+// Modules enable their interrupts through core_partition_enable_irq() rather than
+// irq_set_enabled(), so they land on the right core wherever the module is set up.
+
+#ifndef CORE_PARTITION
+#define CORE_PARTITION 0
+#endif
+
+#define CORE_PARTITION_SYSTEM_CORE 0  // configTICK_CORE, and where main() set up USB
+#define CORE_PARTITION_IR_CORE     1
+
+enum CoreRole {
+  CORE_ROLE_SYSTEM,  // Network, sensors, logging, anything without microsecond deadlines
+  CORE_ROLE_IR,      // IR transmit and receive
+};
+
+#if CORE_PARTITION
+// Restricts a task to its role's core. Works before the scheduler starts.
+void core_partition_pin(TaskHandle_t task, enum CoreRole role);
+
+// Pins the tasks the kernel, the SDK and lwIP create for themselves to the system core. They're
+// found by name, so call it once the network is up.
+void core_partition_pin_system_tasks();
+
+// Enables an interrupt on its role's core. Called from the other core, which includes vLaunch()
+// setting up IR modules before the scheduler starts, it leaves the job to a short task pinned to
+// the right core. The interrupt stays pending until that task has run.
+void core_partition_enable_irq(uint irq, enum CoreRole role);
+#else
+static inline void core_partition_pin(TaskHandle_t task, enum CoreRole role) {}
+static inline void core_partition_pin_system_tasks() {}
+static inline void core_partition_enable_irq(uint irq, enum CoreRole role) {
+  irq_set_enabled(irq, true);
+}
+#endif
+
+#endif  // CORE_PARTITION_H
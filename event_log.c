@@ -0,0 +1,96 @@
+#include "event_log.h"
+
+#include "FreeRTOS.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "task.h"
+
+#define EVENT_LOG_DRAIN_PERIOD_MS 20
+#define EVENT_LOG_RING_MASK       (EVENT_LOG_RING_RECORDS - 1)
+
+static const char *const event_log_formats[LOG_EVENT_COUNT] = {
+#define LOG_EVENT(id, format) [id] = format,
+#include "log_events.def"
+#undef LOG_EVENT
+};
+
+// One ring per core so producers never contend across cores. On a core, masking interrupts for
+// the few stores of a record is enough (the Cortex-M0+ has no exclusive access instructions to
+// build a CAS from). Not static so it can be dumped with gdb and decoded by tools/log_decode.py.
+struct EventLogRing event_log_rings[NUM_CORES];
+
+static uint32_t event_log_reported_drops[NUM_CORES];
+
+void __not_in_flash_func(event_log_record)(uint16_t id, uint8_t arg_count, uint32_t arg0,
+                                           uint32_t arg1, uint32_t arg2) {
+  uint                 core   = get_core_num();
+  struct EventLogRing *ring   = &event_log_rings[core];
+  uint32_t             status = save_and_disable_interrupts();
+
+  uint32_t head = ring->head;
+  if (head - ring->tail >= EVENT_LOG_RING_RECORDS) {
+    ring->dropped++;
+  } else {
+    struct EventLogRecord *record = &ring->records[head & EVENT_LOG_RING_MASK];
+    record->timestamp_us          = time_us_32();
+    record->id                    = id;
+    record->core                  = core;
+    record->arg_count             = arg_count;
+    record->args[0]               = arg0;
+    record->args[1]               = arg1;
+    record->args[2]               = arg2;
+    __dmb();  // Record must be visible before the drain task sees the new head
+    ring->head = head + 1;
+  }
+
+  restore_interrupts(status);
+}
+
+static void event_log_print(const struct EventLogRecord *record) {
+  printf("[%10u] core %u: ", record->timestamp_us, record->core);
+  if (record->id < LOG_EVENT_COUNT) {
+    printf(event_log_formats[record->id], record->args[0], record->args[1], record->args[2]);
+  } else {
+    printf("unknown event %u", record->id);
+  }
+  printf("\n");
+}
+
+uint32_t event_log_drain() {
+  uint32_t printed = 0;
+
+  for (uint core = 0; core < NUM_CORES; core++) {
+    struct EventLogRing *ring = &event_log_rings[core];
+
+    uint32_t head = ring->head;
+    __dmb();
+    for (uint32_t tail = ring->tail; tail != head; tail++) {
+      event_log_print(&ring->records[tail & EVENT_LOG_RING_MASK]);
+      __dmb();  // Finish reading the record before handing the slot back
+      ring->tail = tail + 1;
+      printed++;
+    }
+
+    uint32_t dropped = ring->dropped;
+    if (dropped != event_log_reported_drops[core]) {
+      struct EventLogRecord record = {
+          .timestamp_us = time_us_32(),
+          .id           = LOG_DROPPED,
+          .core         = core,
+          .arg_count    = 1,
+          .args         = {dropped - event_log_reported_drops[core]},
+      };
+      event_log_print(&record);
+      event_log_reported_drops[core] = dropped;
+    }
+  }
+
+  return printed;
+}
+
+void event_log_task(void *params) {
+  while (1) {
+    event_log_drain();
+    vTaskDelay(pdMS_TO_TICKS(EVENT_LOG_DRAIN_PERIOD_MS));
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include "stdint.h"
+
+// Deferred binary logging. Recording an event stores an ID, a timestamp and a few integer
+// arguments in a per-core ring. event_log_task formats and prints them later at low priority, so
+// the real time paths never wait on stdio.
+
+#define EVENT_LOG_MAX_ARGS     3
+#define EVENT_LOG_RING_RECORDS 256  // Per core, must be a power of two
+
+enum EventLogId {
+#define LOG_EVENT(id, format) id,
+#include "log_events.def"
+#undef LOG_EVENT
+  LOG_EVENT_COUNT,
+};
+
+struct EventLogRecord {
+  uint32_t timestamp_us;
+  uint16_t id;
+  uint8_t  core;
+  uint8_t  arg_count;
+  uint32_t args[EVENT_LOG_MAX_ARGS];
+};
+
+struct EventLogRing {
+  volatile uint32_t     head;     // Written by the producing core only
+  volatile uint32_t     tail;     // Written by the drain task only
+  volatile uint32_t     dropped;  // Records lost because the ring was full
+  struct EventLogRecord records[EVENT_LOG_RING_RECORDS];
+};
+
+// Safe from tasks and ISRs on either core
+void event_log_record(uint16_t id, uint8_t arg_count, uint32_t arg0, uint32_t arg1,
+                      uint32_t arg2);
+
+#define EVENT_LOG0(id)       event_log_record((id), 0, 0, 0, 0)
+#define EVENT_LOG1(id, a)    event_log_record((id), 1, (uint32_t)(a), 0, 0)
+#define EVENT_LOG2(id, a, b) event_log_record((id), 2, (uint32_t)(a), (uint32_t)(b), 0)
+#define EVENT_LOG3(id, a, b, c) \
+  event_log_record((id), 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c))
+
+// Formats and prints everything recorded so far. Returns the number of records printed.
+uint32_t event_log_drain();
+
+void event_log_task(void *params);
+
+#endif  // EVENT_LOG_H
@@ -0,0 +1,131 @@
+// Frame and timeline encoding against the byte loop they replaced, kept in aircon_legacy.c and
+// producing the same symbol words so the two can be compared like for like. Both must produce
+// identical timelines, or the run fails.
+//
+//   aircon_encode_bench [frames]
+//
+// Also builds into the firmware with -DAIRCON_ENCODE_BENCH=ON, where aircon_encode_bench_task
+// runs it once on the RP2040 and prints the result to the console.
+
+#include "aircon_encode_bench.h"
+
+#include "FreeRTOS.h"
+#include "aircon_legacy.h"
+#include "bench.h"
+#include "cmd_gen.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "task.h"
+
+#define AIRCON_ENCODE_BENCH_FRAMES 1000000
+// About a second for both on the RP2040, with the timer's microseconds well below a frame's total
+#define AIRCON_ENCODE_BENCH_TARGET_FRAMES 10000
+
+struct AirconEncodeBenchArgs {
+  enum AirconUpdateType update_type;
+  enum AirconMode       mode;
+  enum AirconFanSpeed   fan_speed;
+  uint8_t               temperature;
+  uint16_t              timer_on_duration;
+  uint16_t              timer_off_duration;
+};
+
+///////////
+// Bench //
+///////////
+
+static const struct AirconEncodeBenchArgs aircon_encode_bench_args[] = {
+    {AC_UPDATE_AIRCON_MODE, AC_MODE_OFF, AC_FAN_AUTO, 25, 0, 0},
+    {AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_2, 22, 0, 0},
+    {AC_UPDATE_TIMER_ON, AC_MODE_HEATING, AC_FAN_AUTO, 24, 90, 0},
+    {AC_UPDATE_TIMER_OFF, AC_MODE_DEHUMIDIFY, AC_FAN_0, 27, 0, 600},
+    {AC_UPDATE_FAN_SPEED, AC_MODE_VENTILATION, AC_FAN_5, 18, 0, 0},
+    {AC_UPDATE_TEMP_UP, AC_MODE_COOLING, AC_FAN_3, 31, 45, 30},
+    {AC_UPDATE_TEMP_DOWN, AC_MODE_HEATING, AC_FAN_1, 16, 0, 0},
+    {AC_UPDATE_FIN_DIR, AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0},
+};
+
+static const struct AirconEncodeBenchArgs *aircon_encode_bench_case(uint32_t n) {
+  return &aircon_encode_bench_args[n % count_of(aircon_encode_bench_args)];
+}
+
+static uint64_t aircon_encode_bench_legacy(uint32_t frames) {
+  static uint8_t  buffer[COMMAND_BYTE_COUNT];
+  static uint32_t symbols[IR_TIMELINE_SYMBOL_COUNT];
+  uint64_t        start = bench_now_ns();
+  for (uint32_t n = 0; n < frames; n++) {
+    const struct AirconEncodeBenchArgs *args = aircon_encode_bench_case(n);
+    aircon_legacy_frame(buffer, args->update_type, args->mode, args->fan_speed, args->temperature,
+                        args->timer_on_duration, args->timer_off_duration);
+    bench_sink += aircon_legacy_symbols(buffer, symbols) + symbols[n % 64];
+  }
+  return bench_now_ns() - start;
+}
+
+static uint64_t aircon_encode_bench_current(uint32_t frames) {
+  static struct AirconFrame frame;
+  static struct IrTimeline  timeline;
+  uint64_t                  start = bench_now_ns();
+  for (uint32_t n = 0; n < frames; n++) {
+    const struct AirconEncodeBenchArgs *args = aircon_encode_bench_case(n);
+    aircon_frame_encode(&frame, args->update_type, args->mode, args->fan_speed, args->temperature,
+                        args->timer_on_duration, args->timer_off_duration);
+    ir_timeline_encode(&frame, &timeline);
+    bench_sink += timeline.count + timeline.symbols[n % 64];
+  }
+  return bench_now_ns() - start;
+}
+
+static bool aircon_encode_bench_check() {
+  bool ok = true;
+  for (uint i = 0; i < count_of(aircon_encode_bench_args); i++) {
+    // Static, a timeline is too big for a firmware task's stack
+    const struct AirconEncodeBenchArgs *args = aircon_encode_bench_case(i);
+    static uint8_t                      buffer[COMMAND_BYTE_COUNT];
+    static uint32_t                     symbols[IR_TIMELINE_SYMBOL_COUNT];
+    static struct AirconFrame           frame;
+    static struct IrTimeline            timeline;
+
+    aircon_legacy_frame(buffer, args->update_type, args->mode, args->fan_speed, args->temperature,
+                        args->timer_on_duration, args->timer_off_duration);
+    uint32_t count = aircon_legacy_symbols(buffer, symbols);
+    aircon_frame_encode(&frame, args->update_type, args->mode, args->fan_speed, args->temperature,
+                        args->timer_on_duration, args->timer_off_duration);
+    ir_timeline_encode(&frame, &timeline);
+
+    if (memcmp(buffer, frame.bytes, COMMAND_BYTE_COUNT) != 0 || count != timeline.count ||
+        memcmp(symbols, timeline.symbols, count * sizeof(uint32_t)) != 0) {
+      printf("Frame %u encodes differently\n", i);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static int aircon_encode_bench_run(uint32_t frames) {
+  if (!aircon_encode_bench_check()) {
+    return 1;
+  }
+
+  uint64_t legacy_ns  = aircon_encode_bench_legacy(frames);
+  uint64_t current_ns = aircon_encode_bench_current(frames);
+  printf("Aircon frame + timeline encoding, %u frames\n", frames);
+  printf("  byte loop:       %7.1f ns/frame\n", (double)legacy_ns / frames);
+  printf("  encode+timeline: %7.1f ns/frame (%.2fx)\n", (double)current_ns / frames,
+         (double)legacy_ns / current_ns);
+  return 0;
+}
+
+#if !PICO_ON_DEVICE
+int main(int argc, char **argv) {
+  uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : AIRCON_ENCODE_BENCH_FRAMES;
+  return aircon_encode_bench_run(frames);
+}
+#else
+void aircon_encode_bench_task(void *params) {
+  aircon_encode_bench_run(AIRCON_ENCODE_BENCH_TARGET_FRAMES);
+  vTaskDelete(NULL);
+}
+#endif
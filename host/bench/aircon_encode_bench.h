@@ -0,0 +1,8 @@
+#ifndef AIRCON_ENCODE_BENCH_H
+#define AIRCON_ENCODE_BENCH_H
+
+// The encode benchmark on the RP2040, see aircon_encode_bench.c. Runs once, prints and deletes
+// itself. Built with -DAIRCON_ENCODE_BENCH=ON.
+void aircon_encode_bench_task(void *params);
+
+#endif  // AIRCON_ENCODE_BENCH_H
@@ -0,0 +1,81 @@
+// The aircon frame encoder before the frame codec and timeline replaced it, kept for
+// aircon_encode_bench and as the reference cmd_gen_test checks the codec against. It builds the
+// frame a byte at a time, as populate_command_buffer() did minus its printf, and walks it bit by
+// bit as the old send loop did, choosing each symbol's timing as it goes. Don't fix it: it is
+// what the current encoder has to match.
+
+#include "aircon_legacy.h"
+
+#include "ir_timeline.h"
+
+void aircon_legacy_frame(uint8_t *command_buffer, enum AirconUpdateType update_type,
+                         enum AirconMode mode, enum AirconFanSpeed fan_speed, uint8_t temperature,
+                         uint16_t timer_on_duration, uint16_t timer_off_duration) {
+  static const uint8_t command_preamble[3] = {0x01, 0x10, 0x00};
+
+  uint8_t raw_data_buffer[COMMAND_DATA_COUNT] = {0};
+
+  raw_data_buffer[0]  = 0x40;                             // Constant
+  raw_data_buffer[1]  = 0xFF;                             // Constant
+  raw_data_buffer[2]  = 0xCC;                             // Constant
+  raw_data_buffer[3]  = 0x92;                             // Constant
+  raw_data_buffer[4]  = (uint8_t)update_type;             // Update Type
+  raw_data_buffer[5]  = temperature << 2;                 // Temperature
+  raw_data_buffer[6]  = 0x00;                             // Constant
+  raw_data_buffer[7]  = (timer_off_duration & 0xF) << 4;  // Byte7[7:4] Timer Off Minutes low nibble
+  raw_data_buffer[8]  = (timer_off_duration >> 4) & 0xFF;  // Byte8[7:0] Timer Off Minutes high byte
+  raw_data_buffer[9]  = (timer_on_duration & 0xFF);        // Byte9[7:0] Timer On Minutes low byte
+  raw_data_buffer[10] = (timer_on_duration >> 8) & 0xF;  // Byte10[3:0] Timer On Minutes high nibble
+  raw_data_buffer[10] |= (timer_off_duration > 0) << 4;  // Timer Off Flag: Byte10[4]
+  raw_data_buffer[10] |= (timer_on_duration > 0) << 5;   // Timer On Flag: Byte10[5]
+  if (mode == AC_MODE_OFF) {
+    raw_data_buffer[11] = (fan_speed << 4) | AC_MODE_HEATING;  // Fan Speed and Aircon Mode
+  } else {
+    raw_data_buffer[11] = (fan_speed << 4) | mode;  // Fan Speed and Aircon Mode
+  }
+  raw_data_buffer[12] = mode == AC_MODE_OFF                                ? 0xE1 :
+                        mode == AC_MODE_HEATING || mode == AC_MODE_COOLING ? 0xF1 :
+                                                                             0xF0;
+  raw_data_buffer[13] = 0x00;  // Constant
+  raw_data_buffer[14] = 0x00;  // Constant
+  raw_data_buffer[15] = 0x80;  // Constant
+  raw_data_buffer[16] = 0x03;  // Constant
+  raw_data_buffer[17] = 0x01;  // Constant
+  raw_data_buffer[18] = 0x88;  // Constant
+  raw_data_buffer[19] = 0x00;  // Constant
+  raw_data_buffer[20] = 0x00;  // Constant
+  raw_data_buffer[21] = 0xFF;  // Constant
+  raw_data_buffer[22] = 0xFF;  // Constant
+  raw_data_buffer[23] = 0xFF;  // Constant
+  raw_data_buffer[24] = 0xFF;  // Constant
+
+  // Every second byte after the first three are the bitwise inverse of the first byte in a pair
+  command_buffer[0] = command_preamble[0];
+  command_buffer[1] = command_preamble[1];
+  command_buffer[2] = command_preamble[2];
+  for (uint8_t i = 0; i < COMMAND_DATA_COUNT; i++) {
+    command_buffer[2 * i + 3] = raw_data_buffer[i];
+    command_buffer[2 * i + 4] = ~raw_data_buffer[i];
+  }
+}
+
+uint32_t aircon_legacy_symbols(const uint8_t *command_buffer, uint32_t *symbols) {
+  uint32_t count = 0;
+  for (int i = 0; i < COMMAND_BYTE_COUNT; i++) {
+    uint8_t byte = command_buffer[i];
+    for (int j = 0; j < 8; j++) {
+      if (i == 0 && j == 0) {
+        symbols[count++] = IR_TIMELINE_SYMBOL(30000, 49500);
+        symbols[count++] = IR_TIMELINE_SYMBOL(3380, 1700);
+      }
+      if (byte & 0x01) {
+        symbols[count++] = IR_TIMELINE_SYMBOL(410, 1256);
+      } else {
+        symbols[count++] = IR_TIMELINE_SYMBOL(410, 422);
+      }
+      byte = byte >> 1;
+    }
+  }
+  symbols[count++] = IR_TIMELINE_SYMBOL(410, 65000);
+  return count;
+}
@@ -0,0 +1,19 @@
+#ifndef AIRCON_LEGACY_H
+#define AIRCON_LEGACY_H
+
+#include "cmd_gen.h"
+#include "stdint.h"
+
+// The aircon frame encoder as it was before aircon_frame_encode() and the timeline replaced it,
+// see aircon_legacy.c
+
+// populate_command_buffer() as it was, writing the frame to `command_buffer`
+void aircon_legacy_frame(uint8_t *command_buffer, enum AirconUpdateType update_type,
+                         enum AirconMode mode, enum AirconFanSpeed fan_speed, uint8_t temperature,
+                         uint16_t timer_on_duration, uint16_t timer_off_duration);
+
+// The send loop's walk over a frame, writing the timeline symbol for each one it would have timed.
+// Returns the number written, IR_TIMELINE_SYMBOL_COUNT.
+uint32_t aircon_legacy_symbols(const uint8_t *command_buffer, uint32_t *symbols);
+
+#endif  // AIRCON_LEGACY_H
@@ -0,0 +1,29 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include "stdint.h"
+
+// Wall clock timing for the benchmarks. On the host the shims' clock is virtual, so benchmarks time
+// themselves with this instead. Numbers are only comparable within one build; configure with
+// -DCMAKE_BUILD_TYPE=Release for representative ones. Benchmarks that also build into the
+// firmware (see the root CMakeLists.txt) time themselves with the 1 MHz timer there, where the SDK
+// defines PICO_ON_DEVICE, so they need enough iterations for microseconds to resolve them.
+
+#if !PICO_ON_DEVICE
+#include "time.h"
+
+static inline uint64_t bench_now_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#else
+#include "pico/time.h"
+
+static inline uint64_t bench_now_ns() { return time_us_64() * 1000; }
+#endif
+
+// Results go here so the compiler can't drop the work that made them
+static volatile uint32_t bench_sink;
+
+#endif  // HOST_BENCH_H
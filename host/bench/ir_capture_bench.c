@@ -0,0 +1,192 @@
+// Receive capture storage against the arrays it replaced. The old receive loop kept every run of a
+// frame as a uint32_t duration plus a bool level and decoded them once the line went quiet. The
+// ring keeps each run as the ir_edge_t halfword ir_recv.pio pushes and IrEdgeReader streams them
+// out. Both are run over the same frames twice: storing and reading the runs back alone, then with
+// the decoder on the end. Both must decode every frame, or the run fails.
+//
+//   ir_capture_bench [frames]
+
+#include "bench.h"
+#include "cmd_gen.h"
+#include "ir_decoder.h"
+#include "ir_edge.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "string.h"
+
+#define IR_CAPTURE_BENCH_FRAMES 100000
+#define IR_CAPTURE_BENCH_POOL   64
+#define IR_CAPTURE_BENCH_RUNS   (2 * IR_TIMELINE_SYMBOL_COUNT)
+
+// As ir_recv.c configures the capture
+#define IR_CAPTURE_BENCH_US_PER_TICK 2
+#define IR_CAPTURE_BENCH_GAP_TICKS   (55000 / IR_CAPTURE_BENCH_US_PER_TICK)
+#define IR_CAPTURE_BENCH_RING        1024
+
+// The old capture arrays, sized as they were
+#define IR_CAPTURE_BENCH_LEGACY_RUNS 1000
+
+struct IrCaptureBenchRun {
+  bool     level;
+  uint32_t ticks;
+};
+
+struct IrCaptureBenchFrame {
+  struct AirconFrame       frame;
+  struct IrCaptureBenchRun runs[IR_CAPTURE_BENCH_RUNS];
+};
+
+static struct IrCaptureBenchFrame ir_capture_bench_pool[IR_CAPTURE_BENCH_POOL];
+
+static uint32_t ir_capture_bench_durations[IR_CAPTURE_BENCH_LEGACY_RUNS];
+static bool     ir_capture_bench_values[IR_CAPTURE_BENCH_LEGACY_RUNS];
+
+static ir_edge_t ir_capture_bench_ring[IR_CAPTURE_BENCH_RING];
+static uint32_t  ir_capture_bench_written;
+
+static uint32_t ir_capture_bench_frames;
+static uint32_t ir_capture_bench_wrong;
+
+static void ir_capture_bench_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                     void *user_data) {
+  const struct AirconFrame *sent = user_data;
+  ir_capture_bench_frames++;
+  ir_capture_bench_wrong += memcmp(frame, sent->bytes, COMMAND_BYTE_COUNT) != 0;
+}
+
+static void ir_capture_bench_make_pool() {
+  uint32_t random = 1;
+  for (uint i = 0; i < IR_CAPTURE_BENCH_POOL; i++) {
+    struct IrCaptureBenchFrame *entry = &ir_capture_bench_pool[i];
+    random                            = random * 1103515245 + 12345;
+    aircon_frame_encode(&entry->frame, AC_UPDATE_AIRCON_MODE, AC_MODE_HEATING,
+                        AC_FAN_0 + (random >> 16) % 6, 16 + (random >> 8) % 17, 0, random % 720);
+
+    // Receiver levels: low during the mark. The last space is the gap that ends the frame.
+    struct IrTimeline timeline;
+    ir_timeline_encode(&entry->frame, &timeline);
+    for (uint32_t s = 0; s < timeline.count; s++) {
+      uint32_t symbol      = timeline.symbols[s];
+      uint32_t mark_ticks  = ir_timeline_mark_us(symbol) / IR_CAPTURE_BENCH_US_PER_TICK;
+      uint32_t space_ticks = ir_timeline_space_us(symbol) / IR_CAPTURE_BENCH_US_PER_TICK;
+      if (space_ticks > IR_CAPTURE_BENCH_GAP_TICKS) {
+        space_ticks = IR_CAPTURE_BENCH_GAP_TICKS;
+      }
+      entry->runs[2 * s]     = (struct IrCaptureBenchRun){false, mark_ticks};
+      entry->runs[2 * s + 1] = (struct IrCaptureBenchRun){true, space_ticks};
+    }
+  }
+}
+
+////////////
+// Arrays //
+////////////
+
+static uint32_t ir_capture_bench_legacy_store(const struct IrCaptureBenchFrame *entry) {
+  uint32_t index = 0;
+  for (uint32_t r = 0; r < IR_CAPTURE_BENCH_RUNS; r++) {
+    ir_capture_bench_durations[index] = entry->runs[r].ticks * IR_CAPTURE_BENCH_US_PER_TICK;
+    ir_capture_bench_values[index]    = entry->runs[r].level;
+    index++;
+  }
+  return index;
+}
+
+static uint64_t ir_capture_bench_legacy(uint32_t frames, struct IrDecoder *decoder) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < frames; n++) {
+    const struct IrCaptureBenchFrame *entry = &ir_capture_bench_pool[n % IR_CAPTURE_BENCH_POOL];
+    uint32_t                          count = ir_capture_bench_legacy_store(entry);
+    if (decoder) {
+      decoder->user_data = (void *)&entry->frame;
+      for (uint32_t i = 0; i < count; i++) {
+        ir_decoder_feed(decoder, ir_capture_bench_values[i], ir_capture_bench_durations[i]);
+      }
+    } else {
+      for (uint32_t i = 0; i < count; i++) {
+        bench_sink += ir_capture_bench_values[i] ^ ir_capture_bench_durations[i];
+      }
+    }
+  }
+  return bench_now_ns() - start;
+}
+
+//////////
+// Ring //
+//////////
+
+// What ir_recv.pio pushes for a run
+static ir_edge_t ir_capture_bench_edge(const struct IrCaptureBenchRun *run) {
+  if (run->level && run->ticks >= IR_CAPTURE_BENCH_GAP_TICKS) {
+    return IR_EDGE_FRAME_GAP;
+  }
+  return (ir_edge_t)((IR_CAPTURE_BENCH_GAP_TICKS - run->ticks) << 1 | run->level);
+}
+
+static void ir_capture_bench_ring_store(const struct IrCaptureBenchFrame *entry) {
+  for (uint32_t r = 0; r < IR_CAPTURE_BENCH_RUNS; r++) {
+    ir_capture_bench_ring[ir_capture_bench_written++ % IR_CAPTURE_BENCH_RING] =
+        ir_capture_bench_edge(&entry->runs[r]);
+  }
+}
+
+static uint64_t ir_capture_bench_ring_run(uint32_t frames, struct IrDecoder *decoder) {
+  struct IrEdgeReader reader;
+  ir_edge_reader_init(&reader, ir_capture_bench_ring, IR_CAPTURE_BENCH_RING,
+                      IR_CAPTURE_BENCH_GAP_TICKS);
+  reader.read = ir_capture_bench_written;
+
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < frames; n++) {
+    const struct IrCaptureBenchFrame *entry = &ir_capture_bench_pool[n % IR_CAPTURE_BENCH_POOL];
+    ir_capture_bench_ring_store(entry);
+
+    ir_edge_t edge;
+    uint32_t  ticks;
+    if (decoder) {
+      decoder->user_data = (void *)&entry->frame;
+      while (ir_edge_next(&reader, ir_capture_bench_written, &edge, &ticks)) {
+        ir_decoder_feed(decoder, ir_edge_level(edge), ticks * IR_CAPTURE_BENCH_US_PER_TICK);
+      }
+    } else {
+      while (ir_edge_next(&reader, ir_capture_bench_written, &edge, &ticks)) {
+        bench_sink += ir_edge_level(edge) ^ ticks;
+      }
+    }
+  }
+  if (reader.overruns != 0) {
+    printf("The ring overran %u times\n", reader.overruns);
+    ir_capture_bench_wrong++;
+  }
+  return bench_now_ns() - start;
+}
+
+int main(int argc, char **argv) {
+  uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : IR_CAPTURE_BENCH_FRAMES;
+  ir_capture_bench_make_pool();
+
+  uint64_t legacy_ns = ir_capture_bench_legacy(frames, NULL);
+  uint64_t ring_ns   = ir_capture_bench_ring_run(frames, NULL);
+
+  struct IrDecoder decoder;
+  ir_decoder_init(&decoder, ir_capture_bench_decoded, NULL);
+  uint64_t legacy_decode_ns = ir_capture_bench_legacy(frames, &decoder);
+  uint32_t legacy_decoded   = ir_capture_bench_frames;
+  ir_capture_bench_frames   = 0;
+  uint64_t ring_decode_ns   = ir_capture_bench_ring_run(frames, &decoder);
+  uint32_t ring_decoded     = ir_capture_bench_frames;
+
+  uint64_t runs = (uint64_t)frames * IR_CAPTURE_BENCH_RUNS;
+  printf("IR capture storage, %u frames of %u runs\n", frames, IR_CAPTURE_BENCH_RUNS);
+  printf("  arrays: %5zu bytes, %5.2f ns/run stored and read, %5.2f ns/run decoded\n",
+         sizeof(ir_capture_bench_durations) + sizeof(ir_capture_bench_values),
+         (double)legacy_ns / runs, (double)legacy_decode_ns / runs);
+  printf("  ring:   %5zu bytes, %5.2f ns/run stored and read, %5.2f ns/run decoded\n",
+         sizeof(ir_capture_bench_ring), (double)ring_ns / runs, (double)ring_decode_ns / runs);
+  if (legacy_decoded != frames || ring_decoded != frames || ir_capture_bench_wrong != 0) {
+    printf("  %u and %u frames decoded, %u wrong\n", legacy_decoded, ring_decoded,
+           ir_capture_bench_wrong);
+    return 1;
+  }
+  return 0;
+}
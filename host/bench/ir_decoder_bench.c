@@ -0,0 +1,82 @@
+// Throughput of the IR frame decoder. Feeds the receiver runs of a pool of random frames through
+// ir_decoder_feed() back to back and reports frames and runs decoded per second. Every frame must
+// decode to what was sent, or the run fails.
+//
+//   ir_decoder_bench [frames]
+
+#include "bench.h"
+#include "cmd_gen.h"
+#include "ir_decoder.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "string.h"
+
+#define IR_DECODER_BENCH_FRAMES 200000
+#define IR_DECODER_BENCH_POOL   64
+#define IR_DECODER_BENCH_RUNS   (2 * IR_TIMELINE_SYMBOL_COUNT)
+
+struct IrDecoderBenchRun {
+  bool     level;
+  uint32_t duration_us;
+};
+
+struct IrDecoderBenchFrame {
+  struct AirconFrame       frame;
+  struct IrDecoderBenchRun runs[IR_DECODER_BENCH_RUNS];
+};
+
+static struct IrDecoderBenchFrame ir_decoder_bench_pool[IR_DECODER_BENCH_POOL];
+static uint32_t                   ir_decoder_bench_wrong;
+
+static void ir_decoder_bench_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                     void *user_data) {
+  const struct AirconFrame *sent = user_data;
+  ir_decoder_bench_wrong += memcmp(frame, sent->bytes, COMMAND_BYTE_COUNT) != 0;
+}
+
+static void ir_decoder_bench_make_pool() {
+  uint32_t random = 1;
+  for (uint i = 0; i < IR_DECODER_BENCH_POOL; i++) {
+    struct IrDecoderBenchFrame *entry = &ir_decoder_bench_pool[i];
+    random                            = random * 1103515245 + 12345;
+    aircon_frame_encode(&entry->frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING,
+                        AC_FAN_0 + (random >> 16) % 6, 16 + (random >> 8) % 17, random % 720, 0);
+
+    // Receiver levels: low during the mark
+    struct IrTimeline timeline;
+    ir_timeline_encode(&entry->frame, &timeline);
+    for (uint32_t s = 0; s < timeline.count; s++) {
+      uint32_t symbol        = timeline.symbols[s];
+      entry->runs[2 * s]     = (struct IrDecoderBenchRun){false, ir_timeline_mark_us(symbol)};
+      entry->runs[2 * s + 1] = (struct IrDecoderBenchRun){true, ir_timeline_space_us(symbol)};
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : IR_DECODER_BENCH_FRAMES;
+  ir_decoder_bench_make_pool();
+
+  struct IrDecoder decoder;
+  uint32_t         decoded = 0;
+  uint64_t         start   = bench_now_ns();
+  for (uint32_t n = 0; n < frames; n++) {
+    struct IrDecoderBenchFrame *entry = &ir_decoder_bench_pool[n % IR_DECODER_BENCH_POOL];
+    ir_decoder_init(&decoder, ir_decoder_bench_decoded, &entry->frame);
+    for (uint32_t r = 0; r < IR_DECODER_BENCH_RUNS; r++) {
+      decoded += ir_decoder_feed(&decoder, entry->runs[r].level, entry->runs[r].duration_us);
+    }
+  }
+  uint64_t elapsed_ns = bench_now_ns() - start;
+  bench_sink          = decoded;
+
+  double seconds = elapsed_ns / 1e9;
+  printf("IR decoder: %u frames of %u runs in %.3f s\n", frames, IR_DECODER_BENCH_RUNS, seconds);
+  printf("  %.0f frames/s, %.1f ns/run\n", frames / seconds,
+         (double)elapsed_ns / ((uint64_t)frames * IR_DECODER_BENCH_RUNS));
+  if (decoded != frames || ir_decoder_bench_wrong != 0) {
+    printf("  %u frames decoded, %u wrong\n", decoded, ir_decoder_bench_wrong);
+    return 1;
+  }
+  return 0;
+}
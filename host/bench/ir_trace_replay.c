@@ -0,0 +1,164 @@
+// Replays a trace file through the IR channel model into the decoder, the way ir_channel feeds
+// the loopback checker, and reports:
+// - throughput, in runs and frames per second
+// - decode success rate, the share of captures that gave exactly one frame which validates and
+//   decodes as an aircon frame
+// - latency, the time from feeding a capture's first run to its frame completing, as
+//   p50/p90/p99/max over every capture replayed
+// Without jitter every capture must decode, or the run fails. ctest replays the corpus in
+// host/corpus that tools/ir_trace.py synthesises.
+//
+//   ir_trace_replay <trace.irt> [passes] [jitter sigma us] [seed]
+
+#include "bench.h"
+#include "cmd_gen.h"
+#include "ir_channel.h"
+#include "ir_decoder.h"
+#include "ir_trace.h"
+#include "pico/stdlib.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define IR_TRACE_REPLAY_PASSES 100
+
+struct IrTraceReplay {
+  struct IrChannel channel;
+  struct IrDecoder decoder;
+  uint32_t         tick_hz;
+  uint32_t         frames;  // Frames completed by the current capture
+  bool             valid;   // Every one of them validated and decoded
+  uint64_t         started_ns;
+  uint64_t         latency_ns;  // Of the first of them
+};
+
+static void ir_trace_replay_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                    void *user_data) {
+  struct IrTraceReplay *replay = user_data;
+  if (replay->frames++ == 0) {
+    replay->latency_ns = bench_now_ns() - replay->started_ns;
+  }
+
+  struct AirconFrame received;
+  struct AirconState state;
+  memcpy(received.bytes, frame, COMMAND_BYTE_COUNT);
+  replay->valid &= aircon_frame_validate(&received) == 0 &&
+                   aircon_frame_decode(&received, &state) == 0;
+}
+
+static void ir_trace_replay_receive(bool level, uint32_t duration_us, void *user_data) {
+  struct IrTraceReplay *replay = user_data;
+  ir_decoder_feed(&replay->decoder, level, duration_us);
+}
+
+// Returns whether the capture decoded
+static bool ir_trace_replay_capture(struct IrTraceReplay *replay,
+                                    const struct IrTraceCapture *capture) {
+  replay->frames     = 0;
+  replay->valid      = true;
+  replay->started_ns = bench_now_ns();
+  for (uint32_t i = 0; i < capture->run_count; i++) {
+    uint32_t run = ir_trace_capture_run(capture, i);
+    uint32_t us  = (uint32_t)((uint64_t)ir_trace_run_ticks(run) * 1000000 / replay->tick_hz);
+    ir_channel_feed(&replay->channel, ir_trace_run_level(run), us);
+  }
+  return replay->frames == 1 && replay->valid;
+}
+
+static uint8_t *ir_trace_replay_load(const char *path, size_t *size) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  *size         = (size_t)ftell(file);
+  uint8_t *data = malloc(*size);
+  fseek(file, 0, SEEK_SET);
+  if (data && fread(data, 1, *size, file) != *size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(file);
+  return data;
+}
+
+static int ir_trace_replay_compare(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace.irt> [passes] [jitter sigma us] [seed]\n", argv[0]);
+    return 2;
+  }
+  uint32_t passes = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : IR_TRACE_REPLAY_PASSES;
+  uint32_t seed   = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 0) : 1;
+
+  struct IrChannelModel model = {
+      .jitter_sigma_us = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0,
+  };
+
+  size_t   size;
+  uint8_t *data = ir_trace_replay_load(argv[1], &size);
+  if (!data) {
+    fprintf(stderr, "Can't read %s\n", argv[1]);
+    return 2;
+  }
+
+  struct IrTraceReader reader;
+  if (ir_trace_reader_init(&reader, data, size) != PICO_ERROR_NONE) {
+    fprintf(stderr, "%s is not a trace file\n", argv[1]);
+    return 2;
+  }
+  uint32_t               count    = reader.captures_left;
+  struct IrTraceCapture *captures = calloc(count ? count : 1, sizeof(*captures));
+  for (uint32_t i = 0; i < count; i++) {
+    if (ir_trace_next_capture(&reader, &captures[i]) != PICO_ERROR_NONE) {
+      fprintf(stderr, "%s is truncated\n", argv[1]);
+      return 2;
+    }
+  }
+
+  static struct IrTraceReplay replay;
+  replay.tick_hz = reader.tick_hz;
+  ir_channel_init(&replay.channel, 0, &model, seed);
+  ir_channel_set_sink(&replay.channel, ir_trace_replay_receive, &replay);
+  ir_decoder_init(&replay.decoder, ir_trace_replay_decoded, &replay);
+
+  uint64_t *latencies = malloc(((size_t)passes * count + 1) * sizeof(uint64_t));
+  uint32_t  decoded   = 0;
+  uint64_t  runs      = 0;
+  uint64_t  start     = bench_now_ns();
+  for (uint32_t pass = 0; pass < passes; pass++) {
+    for (uint32_t i = 0; i < count; i++) {
+      if (ir_trace_replay_capture(&replay, &captures[i])) {
+        latencies[decoded++] = replay.latency_ns;
+      }
+      runs += captures[i].run_count;
+    }
+  }
+  uint64_t elapsed_ns = bench_now_ns() - start;
+  uint32_t replayed   = passes * count;
+
+  double seconds = elapsed_ns / 1e9;
+  printf("IR trace replay: %s, %u captures x %u passes, jitter sigma %u us\n", argv[1], count,
+         passes, model.jitter_sigma_us);
+  printf("  %.0f runs/s, %.0f frames/s\n", runs / seconds, decoded / seconds);
+  printf("  %u of %u decoded (%.2f%%)\n", decoded, replayed,
+         replayed ? 100.0 * decoded / replayed : 0.0);
+  if (decoded > 0) {
+    qsort(latencies, decoded, sizeof(uint64_t), ir_trace_replay_compare);
+    printf("  latency p50 %llu ns, p90 %llu ns, p99 %llu ns, max %llu ns\n",
+           (unsigned long long)latencies[decoded / 2],
+           (unsigned long long)latencies[(uint64_t)decoded * 90 / 100],
+           (unsigned long long)latencies[(uint64_t)decoded * 99 / 100],
+           (unsigned long long)latencies[decoded - 1]);
+  }
+
+  free(latencies);
+  free(captures);
+  free(data);
+  bool clean = model.jitter_sigma_us == 0;
+  return replayed > 0 && (!clean || decoded == replayed) ? 0 : 1;
+}
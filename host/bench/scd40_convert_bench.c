@@ -0,0 +1,96 @@
+// Cost per sample of the SCD40 conversions in scd40_convert.h, one sample at a time and in a batch,
+// against the 32 bit divides they replaced and the datasheet formulas in floating point. The old
+// conversion is kept here as it was, whole degrees and percent only. Its divides are by 1 << 16,
+// which compile to shifts, so the difference on the host is the cost of the extra precision; what
+// the Cortex-M0+ saves is the software divide behind the offset conversion.
+//
+//   scd40_convert_bench [samples]
+
+#include "bench.h"
+#include "pico/stdlib.h"
+#include "scd40_convert.h"
+
+#define SCD40_CONVERT_BENCH_SAMPLES 50000000
+#define SCD40_CONVERT_BENCH_BATCH   1024
+
+static struct Scd40RawMeasurement scd40_convert_bench_raw[SCD40_CONVERT_BENCH_BATCH];
+static struct Scd40Measurement    scd40_convert_bench_out[SCD40_CONVERT_BENCH_BATCH];
+
+static const struct Scd40RawMeasurement *scd40_convert_bench_sample(uint32_t n) {
+  return &scd40_convert_bench_raw[n % SCD40_CONVERT_BENCH_BATCH];
+}
+
+// As scd40_read_measurement() converted a reading
+static uint32_t scd40_convert_bench_legacy_sample(const struct Scd40RawMeasurement *raw) {
+  uint16_t temperature = -45 + 175 * ((uint32_t)raw->temperature_raw) / (1 << 16);
+  uint16_t humidity    = 100 * ((uint32_t)raw->humidity_raw) / (1 << 16);
+  return temperature + humidity;
+}
+
+static uint32_t scd40_convert_bench_double_sample(const struct Scd40RawMeasurement *raw) {
+  double temperature = -45 + 175.0 * raw->temperature_raw / 65536;
+  double humidity    = 100.0 * raw->humidity_raw / 65536;
+  return (uint32_t)(100 * (temperature + 45)) + (uint32_t)(100 * humidity);
+}
+
+static uint64_t scd40_convert_bench_legacy(uint32_t samples) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < samples; n++) {
+    bench_sink += scd40_convert_bench_legacy_sample(scd40_convert_bench_sample(n));
+  }
+  return bench_now_ns() - start;
+}
+
+static uint64_t scd40_convert_bench_double(uint32_t samples) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < samples; n++) {
+    bench_sink += scd40_convert_bench_double_sample(scd40_convert_bench_sample(n));
+  }
+  return bench_now_ns() - start;
+}
+
+static uint64_t scd40_convert_bench_single(uint32_t samples) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < samples; n++) {
+    struct Scd40Measurement measurement;
+    scd40_convert(scd40_convert_bench_sample(n), &measurement);
+    bench_sink += measurement.temperature_centi_cel + measurement.humidity_centi_percent;
+  }
+  return bench_now_ns() - start;
+}
+
+static uint64_t scd40_convert_bench_batch(uint32_t samples) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < samples; n += SCD40_CONVERT_BENCH_BATCH) {
+    scd40_convert_batch(scd40_convert_bench_raw, scd40_convert_bench_out,
+                        SCD40_CONVERT_BENCH_BATCH);
+    bench_sink += scd40_convert_bench_out[n % SCD40_CONVERT_BENCH_BATCH].temperature_centi_cel;
+  }
+  return bench_now_ns() - start;
+}
+
+int main(int argc, char **argv) {
+  uint32_t samples =
+      argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : SCD40_CONVERT_BENCH_SAMPLES;
+  samples = (samples + SCD40_CONVERT_BENCH_BATCH - 1) / SCD40_CONVERT_BENCH_BATCH *
+            SCD40_CONVERT_BENCH_BATCH;
+
+  uint32_t random = 1;
+  for (uint i = 0; i < SCD40_CONVERT_BENCH_BATCH; i++) {
+    random                     = random * 1103515245 + 12345;
+    scd40_convert_bench_raw[i] = (struct Scd40RawMeasurement){400 + i, random >> 16, random};
+  }
+
+  uint64_t legacy_ns = scd40_convert_bench_legacy(samples);
+  uint64_t double_ns = scd40_convert_bench_double(samples);
+  uint64_t single_ns = scd40_convert_bench_single(samples);
+  uint64_t batch_ns  = scd40_convert_bench_batch(samples);
+
+  printf("SCD40 conversion, %u samples\n", samples);
+  printf("  32 bit divide:  %5.2f ns/sample, whole units\n", (double)legacy_ns / samples);
+  printf("  double:         %5.2f ns/sample\n", (double)double_ns / samples);
+  printf("  scd40_convert:  %5.2f ns/sample\n", (double)single_ns / samples);
+  printf("  batch of %4u:  %5.2f ns/sample\n", SCD40_CONVERT_BENCH_BATCH,
+         (double)batch_ns / samples);
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Cost of the SCD4x CRC-8 per byte and per response word, for whichever table this binary was
+// built with, against the bitwise loop the tables replaced. Built once with each table size.
+//
+//   scd40_crc_bench_<0|1> [bytes]
+
+#include "bench.h"
+#include "pico/stdlib.h"
+#include "scd40_crc.h"
+
+#define SCD40_CRC_BENCH_BYTES  (64 * 1024 * 1024)
+#define SCD40_CRC_BENCH_BUFFER 4096
+
+static uint8_t scd40_crc_bench_bitwise(const uint8_t *data, uint16_t count) {
+  uint8_t crc = CRC8_INIT;
+  for (uint16_t i = 0; i < count; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x80 ? (uint8_t)(crc << 1) ^ CRC8_POLYNOMIAL : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+int main(int argc, char **argv) {
+  uint32_t bytes = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : SCD40_CRC_BENCH_BYTES;
+  uint32_t rounds = bytes / SCD40_CRC_BENCH_BUFFER ? bytes / SCD40_CRC_BENCH_BUFFER : 1;
+  bytes           = rounds * SCD40_CRC_BENCH_BUFFER;
+
+  static uint8_t data[SCD40_CRC_BENCH_BUFFER];
+  for (uint i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 37 + 11);
+  }
+
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < rounds; n++) {
+    bench_sink += scd40_crc(data, SCD40_CRC_BENCH_BUFFER);
+  }
+  uint64_t table_ns = bench_now_ns() - start;
+
+  start = bench_now_ns();
+  for (uint32_t n = 0; n < rounds; n++) {
+    bench_sink += scd40_crc_bench_bitwise(data, SCD40_CRC_BENCH_BUFFER);
+  }
+  uint64_t bitwise_ns = bench_now_ns() - start;
+
+  // The driver's case: [MSB, LSB, CRC] blocks of a response, unpacked a word at a time. The
+  // CRCs don't match, which costs the same.
+  uint32_t words = bytes / 3;
+  uint8_t  out[2 * 85];
+  start = bench_now_ns();
+  for (uint32_t n = 0; n < words / 85; n++) {
+    bench_sink += scd40_crc_unpack_words(&data[(n % 16) * 255], 85, out) + out[n % 170];
+  }
+  uint64_t unpack_ns = bench_now_ns() - start;
+
+  printf("SCD4x CRC-8, %s table, %u bytes\n", SCD40_CRC_NIBBLE_TABLE ? "16 entry" : "256 entry",
+         bytes);
+  printf("  table:   %6.2f ns/byte\n", (double)table_ns / bytes);
+  printf("  bitwise: %6.2f ns/byte\n", (double)bitwise_ns / bytes);
+  printf("  unpack:  %6.2f ns/word\n", (double)unpack_ns / (words / 85 * 85));
+  return 0;
+}
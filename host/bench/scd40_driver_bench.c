@@ -0,0 +1,82 @@
+// Host CPU time per command of the Scd4x driver behind scd40.h against the C driver it replaced,
+// kept as scd40_legacy.c. Both run the same idle mode commands against the simulated sensor: a
+// write, two reads and the data ready poll. The time includes the I2C and scheduler shims, which
+// are the same for both, so the difference is the drivers'. Both must read back the same values,
+// or the run fails. Code size is compared by the scd40_driver_size target.
+//
+//   scd40_driver_bench [iterations]
+
+#include "bench.h"
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include "scd40.h"
+#include "scd40_legacy.h"
+#include "scd40_sim.h"
+#include "string.h"
+
+#define SCD40_DRIVER_BENCH_ITERATIONS 200000
+#define SCD40_DRIVER_BENCH_COMMANDS   4
+
+struct Scd40DriverBenchResult {
+  uint32_t errors;
+  uint16_t offset_centi_cel;
+  uint16_t serial_number[3];
+  bool     data_ready;
+};
+
+static uint64_t scd40_driver_bench_current(uint32_t iterations,
+                                           struct Scd40DriverBenchResult *result) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < iterations; n++) {
+    result->errors += scd40_set_temperature_offset(400 + n % 64) != PICO_ERROR_NONE;
+    result->errors += scd40_get_temperature_offset(&result->offset_centi_cel) != PICO_ERROR_NONE;
+    result->errors += scd40_get_serial_number(result->serial_number) != PICO_ERROR_NONE;
+    result->errors += scd40_get_data_ready_status(&result->data_ready) != PICO_ERROR_NONE;
+  }
+  return bench_now_ns() - start;
+}
+
+static uint64_t scd40_driver_bench_legacy(uint32_t iterations,
+                                          struct Scd40DriverBenchResult *result) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t n = 0; n < iterations; n++) {
+    result->errors += scd40_legacy_set_temperature_offset(400 + n % 64) != PICO_ERROR_NONE;
+    result->errors +=
+        scd40_legacy_get_temperature_offset(&result->offset_centi_cel) != PICO_ERROR_NONE;
+    result->errors += scd40_legacy_get_serial_number(result->serial_number) != PICO_ERROR_NONE;
+    result->errors += scd40_legacy_get_data_ready_status(&result->data_ready) != PICO_ERROR_NONE;
+  }
+  return bench_now_ns() - start;
+}
+
+int main(int argc, char **argv) {
+  uint32_t iterations =
+      argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : SCD40_DRIVER_BENCH_ITERATIONS;
+
+  static struct Scd40Sim sim;
+  scd40_sim_init(&sim);
+  scd40_init(false);
+  scd40_sim_attach(&sim, i2c_default);
+
+  struct Scd40DriverBenchResult legacy     = {0};
+  struct Scd40DriverBenchResult current    = {0};
+  uint64_t                      legacy_ns  = scd40_driver_bench_legacy(iterations, &legacy);
+  uint64_t                      current_ns = scd40_driver_bench_current(iterations, &current);
+
+  uint64_t commands = (uint64_t)iterations * SCD40_DRIVER_BENCH_COMMANDS;
+  printf("SCD40 driver, %u iterations of %u commands on the simulator\n", iterations,
+         SCD40_DRIVER_BENCH_COMMANDS);
+  printf("  C driver:       %6.1f ns/command\n", (double)legacy_ns / commands);
+  printf("  Scd4x template: %6.1f ns/command (%.2fx)\n", (double)current_ns / commands,
+         (double)legacy_ns / current_ns);
+
+  if (legacy.errors != 0 || current.errors != 0 ||
+      legacy.offset_centi_cel != current.offset_centi_cel ||
+      memcmp(legacy.serial_number, current.serial_number, sizeof(legacy.serial_number)) != 0 ||
+      legacy.data_ready != current.data_ready) {
+    printf("  Errors %u and %u, offsets %u and %u\n", legacy.errors, current.errors,
+           legacy.offset_centi_cel, current.offset_centi_cel);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,357 @@
+// The SCD40 driver as it was before scd4x.hpp replaced it, kept for scd40_driver_bench and the
+// scd40_driver_size comparison. Only the names have changed, to scd40_legacy_*, so it links next
+// to the current driver. Don't fix it: its bugs are part of what's being compared.
+
+#include "scd40_legacy.h"
+
+#include "event_log.h"
+#include "hardware/i2c.h"
+#include "i2c_async.h"
+#include "pico/binary_info.h"
+#include "scd40_crc.h"
+#include "string.h"
+
+// https://d2air1d4eqhwg2.cloudfront.net/media/files/262fda6e-3a57-4326-b93d-a9d627defdc4.pdf
+
+#define SCD40_ADDR         0x62
+#define SCD40_I2C          i2c_default
+#define SCD40_I2C_BAUDRATE (400 * 1000)  // Fast mode, the fastest the SCD4x supports
+
+#define MAX_READ_BYTES 9
+
+enum SCD4xCommand {
+  // Basic Commands
+  SCD4x_CMD_START_PERIODIC_MEASUREMENT = 0x21B1,
+  SCD4x_CMD_READ_MEASUREMENT           = 0xEC05,
+  SCD4x_CMD_STOP_PERIODIC_MEASUREMENT  = 0x3F86,
+
+  // On-chip Output Signal Compensation
+  SCD4x_CMD_SET_TEMPERATURE_OFFSET = 0x241D,
+  SCD4x_CMD_GET_TEMPERATURE_OFFSET = 0x2318,
+  SCD4x_CMD_SET_SENSOR_ALTITUDE    = 0x2427,
+  SCD4x_CMD_GET_SENSOR_ALTITUDE    = 0x2322,
+  SCD4x_CMD_SET_AMBIENT_PRESSURE   = 0xE000,
+
+  // Field Calibration
+  SCD4x_CMD_PERFORM_FORCED_RECALIBRATION           = 0x362F,
+  SCD4x_CMD_SET_AUTOMATIC_SELF_CALIBRATION_ENABLED = 0x2416,
+  SCD4x_CMD_GET_AUTOMATIC_SELF_CALIBRATION_ENABLED = 0x2313,
+
+  // Low Power
+  SCD4x_CMD_START_LOW_POWER_PERIODIC_MEASUREMENT = 0x21AC,
+  SCD4x_CMD_GET_DATA_READY_STATUS                = 0xE4B8,
+
+  // Advanced Features
+  SCD4x_CMD_PERSIST_SETTINGS      = 0x3615,
+  SCD4x_CMD_GET_SERIAL_NUMBER     = 0x3682,
+  SCD4x_CMD_PERFORM_SELF_TEST     = 0x3639,
+  SCD4x_CMD_PERFORM_FACTORY_RESET = 0x3632,
+  SCD4x_CMD_REINIT                = 0x3646,
+
+  // Low Power Single Shot (SCD41 only)
+  SCD4x_CMD_MEASURE_SINGLE_SHOT          = 0x219D,
+  SCD4x_CMD_MEASURE_SINGLE_SHOT_RHT_ONLY = 0x2196,
+};
+
+static bool scd40_legacy_running_periodic_mode = false;
+
+// Builds a transaction for `command`. The execution time before the response can be read (or
+// before the sensor accepts another command) runs on a timer, not in the calling task.
+static void scd40_legacy_transaction_init(struct I2cAsyncTransaction *transaction, uint16_t command,
+                                          uint32_t delay_ms) {
+  memset(transaction, 0, sizeof(*transaction));
+  transaction->address   = SCD40_ADDR;
+  transaction->write[0]  = command >> 8;
+  transaction->write[1]  = command & 0xFF;
+  transaction->write_len = 2;
+  transaction->delay_us  = delay_ms * 1000;
+}
+
+// Appends a data word to the command, in the same transfer as the header
+static void scd40_legacy_transaction_add_word(struct I2cAsyncTransaction *transaction,
+                                              uint16_t data) {
+  uint8_t *word = &transaction->write[transaction->write_len];
+
+  // The CRC covers the word as sent on the wire, MSB first
+  word[0] = data >> 8;
+  word[1] = data & 0xFF;
+  word[2] = scd40_crc(word, 2);
+  transaction->write_len += 3;
+  EVENT_LOG2(LOG_SCD40_WRITE, data, word[2]);
+}
+
+// Runs a transaction, blocking the calling task (not the CPU) until the sensor has answered
+static int32_t scd40_legacy_execute(uint16_t command, bool allowed_during_periodic,
+                                    struct I2cAsyncTransaction *transaction) {
+  int32_t err = PICO_ERROR_NONE;
+  if (scd40_legacy_running_periodic_mode && !allowed_during_periodic) {
+    EVENT_LOG1(LOG_SCD40_ILLEGAL_STATE, command);
+    err = PICO_ERROR_INVALID_STATE;
+  }
+
+  if (err == PICO_ERROR_NONE) {
+    EVENT_LOG1(LOG_SCD40_COMMAND, command);
+    err = i2c_async_transfer(SCD40_I2C, transaction);
+  }
+
+  if (err) {
+    EVENT_LOG2(LOG_SCD40_ERROR, command, err);
+  }
+
+  return err;
+}
+
+void scd40_legacy_init(bool enable_internal_pullup) {
+  i2c_async_init(SCD40_I2C, SCD40_I2C_BAUDRATE);
+  gpio_set_function(PICO_DEFAULT_I2C_SDA_PIN, GPIO_FUNC_I2C);
+  gpio_set_function(PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C);
+  if (enable_internal_pullup) {
+    gpio_pull_up(PICO_DEFAULT_I2C_SDA_PIN);
+    gpio_pull_up(PICO_DEFAULT_I2C_SCL_PIN);
+  }
+  // Populate metadata in the binary for picotool
+  bi_decl(bi_2pins_with_func(PICO_DEFAULT_I2C_SDA_PIN, PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C));
+
+  sleep_ms(1000);  // Wait for powerup
+}
+
+//////////////////////////
+// Header Only Commands //
+//////////////////////////
+
+// These commands are refered to as "send command" in the datasheet
+int32_t scd40_legacy_header_only_command(uint16_t command, bool allowed_during_periodic,
+                                         uint32_t delay_ms) {
+  struct I2cAsyncTransaction transaction;
+  scd40_legacy_transaction_init(&transaction, command, delay_ms);
+
+  return scd40_legacy_execute(command, allowed_during_periodic, &transaction);
+}
+
+int32_t scd40_legacy_start_periodic_measurement() {
+  int32_t err = scd40_legacy_header_only_command(SCD4x_CMD_START_PERIODIC_MEASUREMENT, false, 0);
+  if (err == PICO_ERROR_NONE) {
+    scd40_legacy_running_periodic_mode = true;
+  }
+  return err;
+}
+
+int32_t scd40_legacy_start_low_power_periodic_measurement() {
+  int32_t err =
+      scd40_legacy_header_only_command(SCD4x_CMD_START_LOW_POWER_PERIODIC_MEASUREMENT, false, 0);
+  if (err == PICO_ERROR_NONE) {
+    scd40_legacy_running_periodic_mode = true;
+  }
+  return err;
+}
+
+int32_t scd40_legacy_stop_periodic_measurement() {
+  int32_t err = scd40_legacy_header_only_command(SCD4x_CMD_STOP_PERIODIC_MEASUREMENT, true, 500);
+  if (err == PICO_ERROR_NONE) {
+    scd40_legacy_running_periodic_mode = false;
+  }
+  return err;
+}
+
+int32_t scd40_legacy_perform_factory_reset() {
+  return scd40_legacy_header_only_command(SCD4x_CMD_PERFORM_FACTORY_RESET, false, 1200);
+}
+
+int32_t scd40_legacy_reinit() {
+  return scd40_legacy_header_only_command(SCD4x_CMD_REINIT, false, 20);
+}
+
+int32_t scd40_legacy_measure_single_shot() {
+  return PICO_ERROR_VERSION_MISMATCH;  // Not permitted for the SCD40
+  return scd40_legacy_header_only_command(SCD4x_CMD_MEASURE_SINGLE_SHOT, false, 5000);
+}
+
+int32_t scd40_legacy_measure_single_shot_rht_only() {
+  return PICO_ERROR_VERSION_MISMATCH;  // Not permitted for the SCD40
+  return scd40_legacy_header_only_command(SCD4x_CMD_MEASURE_SINGLE_SHOT_RHT_ONLY, false, 50);
+}
+
+////////////////////////
+// Read Only Commands //
+////////////////////////
+
+// These commands are refered to as "read" in the datasheet
+int32_t scd40_legacy_read_command(uint16_t command, bool allowed_during_periodic, uint32_t delay_ms,
+                                  uint8_t *buffer, uint8_t bytes_to_read) {
+  uint8_t raw_data[MAX_READ_BYTES] = {0};
+
+  struct I2cAsyncTransaction transaction;
+  scd40_legacy_transaction_init(&transaction, command, delay_ms);
+  transaction.read     = raw_data;
+  transaction.read_len = bytes_to_read + (bytes_to_read >> 1);  // Plus a CRC byte per word
+
+  int32_t err = scd40_legacy_execute(command, allowed_during_periodic, &transaction);
+
+  // Check every block's CRC and strip them in one pass
+  if (err == PICO_ERROR_NONE) {
+    err = scd40_crc_unpack_words(raw_data, bytes_to_read >> 1, buffer);
+    if (err) {
+      EVENT_LOG1(LOG_SCD40_CRC_ERROR, bytes_to_read >> 1);
+    }
+  }
+
+  return err;
+}
+
+// The sensor NACKs this if no new sample is waiting, see scd40_legacy_get_data_ready_status()
+int32_t scd40_legacy_read_measurement_raw(uint16_t *co2_ppm, uint16_t *temp_raw,
+                                          uint16_t *humidity_raw) {
+  uint8_t output[6] = {0};
+
+  int32_t err = scd40_legacy_read_command(SCD4x_CMD_READ_MEASUREMENT, true, 1, output, 6);
+
+  *co2_ppm      = (uint16_t)(output[0] << 8) | output[1];  // CO2 doesn't require post-processing
+  *temp_raw     = (uint16_t)(output[2] << 8) | output[3];
+  *humidity_raw = (uint16_t)(output[4] << 8) | output[5];
+
+  return err;
+}
+
+int32_t scd40_legacy_read_measurement(uint16_t *co2_ppm, int16_t *temp_centi_cel,
+                                      uint16_t *humidity_centi_percent) {
+  uint16_t temp_raw;
+  uint16_t humidity_raw;
+
+  int32_t err = scd40_legacy_read_measurement_raw(co2_ppm, &temp_raw, &humidity_raw);
+
+  *humidity_centi_percent = scd40_humidity_centi_percent(humidity_raw);  // Apply post-processing
+  *temp_centi_cel         = scd40_temperature_centi_cel(temp_raw);       // Apply post-processing
+
+  return err;
+}
+
+int32_t scd40_legacy_get_temperature_offset(uint16_t *offset_centi_cel) {
+  uint8_t output[2] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+
+  err = scd40_legacy_read_command(SCD4x_CMD_GET_TEMPERATURE_OFFSET, false, 1, output, 2);
+
+  uint16_t offset_raw = (uint16_t)(output[0] << 8) | output[1];
+  *offset_centi_cel   = scd40_temperature_offset_centi_cel(offset_raw);  // Apply post-processing
+
+  return err;
+}
+
+int32_t scd40_legacy_get_sensor_altitude(uint16_t *altitude_meters) {
+  uint8_t output[2] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+
+  err = scd40_legacy_read_command(SCD4x_CMD_GET_SENSOR_ALTITUDE, false, 1, output, 2);
+
+  *altitude_meters = (uint16_t)(output[0] << 8) | output[1];
+
+  return err;
+}
+
+int32_t scd40_legacy_get_automatic_self_calibration_enabled(bool *self_calibration_enabled) {
+  uint8_t output[2] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+
+  err = scd40_legacy_read_command(SCD4x_CMD_GET_AUTOMATIC_SELF_CALIBRATION_ENABLED, false, 1,
+                                  output, 2);
+
+  *self_calibration_enabled = ((uint16_t)(output[0] << 8) | output[1]) == 1;
+
+  return err;
+}
+
+int32_t scd40_legacy_get_data_ready_status(bool *data_waiting) {
+  uint8_t output[2] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+
+  err = scd40_legacy_read_command(SCD4x_CMD_GET_DATA_READY_STATUS, true, 1, output, 2);
+
+  uint16_t result = (uint16_t)(output[0] << 8) | output[1];
+  *data_waiting   = (result & 0xFFF) != 0;  // If bits 11:0 are non-zero, data is waiting
+  EVENT_LOG1(LOG_SCD40_DATA_READY, result);
+
+  return err;
+}
+
+int32_t scd40_legacy_get_serial_number(uint16_t *serial_number) {
+  uint8_t output[6] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+  err               = scd40_legacy_read_command(SCD4x_CMD_GET_SERIAL_NUMBER, false, 1, output, 6);
+
+
+  serial_number[2] = (uint16_t)(output[4] << 8) | output[5];
+  serial_number[1] = (uint16_t)(output[2] << 8) | output[3];
+  serial_number[0] = (uint16_t)(output[0] << 8) | output[1];
+
+  EVENT_LOG3(LOG_SCD40_SERIAL, serial_number[0], serial_number[1], serial_number[2]);
+
+  return err;
+}
+
+int32_t scd40_legacy_perform_self_test() {
+  uint8_t output[2] = {0};
+  int32_t err       = PICO_ERROR_NONE;
+
+  err = scd40_legacy_read_command(SCD4x_CMD_PERFORM_SELF_TEST, false, 10000, output, 2);
+
+  // Any non-zero word means a malfunction was detected
+  uint16_t self_test_result = (uint16_t)(output[0] << 8) | output[1];
+
+  if (err == PICO_ERROR_NONE && self_test_result != 0) {
+    EVENT_LOG1(LOG_SCD40_SELF_TEST_FAILED, self_test_result);
+    err = PICO_ERROR_GENERIC;
+  }
+
+  return err;
+}
+
+/////////////////////////
+// Write Only Commands //
+/////////////////////////
+
+// These commands are refered to as "write" in the datasheet
+int32_t scd40_legacy_write_command(uint16_t command, bool allowed_during_periodic,
+                                   uint32_t delay_ms, uint16_t data) {
+  struct I2cAsyncTransaction transaction;
+  scd40_legacy_transaction_init(&transaction, command, delay_ms);
+  scd40_legacy_transaction_add_word(&transaction, data);
+
+  return scd40_legacy_execute(command, allowed_during_periodic, &transaction);
+}
+
+int32_t scd40_legacy_set_temperature_offset(uint16_t offset_centi_cel) {
+  int32_t err = PICO_ERROR_NONE;
+
+  uint16_t offset_raw = scd40_temperature_offset_raw(offset_centi_cel);
+  err = scd40_legacy_write_command(SCD4x_CMD_SET_TEMPERATURE_OFFSET, false, 1, offset_raw);
+
+  return err;
+}
+
+int32_t scd40_legacy_set_sensor_altitude(uint16_t altitude) {
+  int32_t err = PICO_ERROR_NONE;
+
+  err = scd40_legacy_write_command(SCD4x_CMD_SET_SENSOR_ALTITUDE, false, 1, altitude);
+
+  return err;
+}
+
+int32_t scd40_legacy_set_ambient_pressure(uint16_t pressure_pa) {
+  int32_t err = PICO_ERROR_NONE;
+
+  uint16_t post_processed_pressure = pressure_pa / 100;
+  err = scd40_legacy_write_command(SCD4x_CMD_SET_AMBIENT_PRESSURE, false, 1,
+                                   post_processed_pressure);
+
+  return err;
+}
+
+int32_t scd40_legacy_set_automatic_self_calibration_enabled(bool enabled) {
+  int32_t err = PICO_ERROR_NONE;
+
+  uint16_t self_calibration_status = enabled ? 1 : 0;
+  err = scd40_legacy_write_command(SCD4x_CMD_SET_AUTOMATIC_SELF_CALIBRATION_ENABLED, false, 1,
+                                   self_calibration_status);
+
+  return err;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef SCD40_LEGACY_H
+#define SCD40_LEGACY_H
+
+#include "pico/stdlib.h"
+#include "scd40_convert.h"
+#include "stdint.h"
+
+// The scd40.h API before scd4x.hpp, see scd40_legacy.c
+
+void scd40_legacy_init(bool enable_internal_pullup);
+
+// Header Only Commands
+int32_t scd40_legacy_start_periodic_measurement();
+int32_t scd40_legacy_start_low_power_periodic_measurement();
+int32_t scd40_legacy_stop_periodic_measurement();
+int32_t scd40_legacy_perform_factory_reset();
+int32_t scd40_legacy_reinit();
+int32_t scd40_legacy_measure_single_shot();
+int32_t scd40_legacy_measure_single_shot_rht_only();
+
+// Read Only Commands
+// Temperatures are in hundredths of a degree and humidity in hundredths of a percent, see
+// scd40_convert.h
+int32_t scd40_legacy_read_measurement(uint16_t *co2_ppm, int16_t *temp_centi_cel,
+                                      uint16_t *humidity_centi_percent);
+int32_t scd40_legacy_read_measurement_raw(uint16_t *co2_ppm, uint16_t *temp_raw,
+                                          uint16_t *humidity_raw);
+int32_t scd40_legacy_get_temperature_offset(uint16_t *offset_centi_cel);
+int32_t scd40_legacy_get_sensor_altitude(uint16_t *altitude_meters);
+int32_t scd40_legacy_get_automatic_self_calibration_enabled(bool *self_calibration_enabled);
+int32_t scd40_legacy_get_data_ready_status(bool *data_waiting);
+int32_t scd40_legacy_get_serial_number(uint16_t *serial_number);
+int32_t scd40_legacy_perform_self_test();
+
+// Write Only Commands
+int32_t scd40_legacy_set_temperature_offset(uint16_t offset_centi_cel);
+int32_t scd40_legacy_set_sensor_altitude(uint16_t altitude);
+int32_t scd40_legacy_set_ambient_pressure(uint16_t pressure_pa);
+int32_t scd40_legacy_set_automatic_self_calibration_enabled(bool enabled);
+
+#endif  // SCD40_LEGACY_H
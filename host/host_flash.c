@@ -0,0 +1,25 @@
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "string.h"
+
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  hard_assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+  hard_assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+  memset(&host_flash[flash_offs], 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+  hard_assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+  hard_assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+  // Programming can only clear bits
+  for (size_t i = 0; i < count; i++) {
+    host_flash[flash_offs + i] &= data[i];
+  }
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+  func(param);
+  return PICO_ERROR_NONE;
+}
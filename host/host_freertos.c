@@ -0,0 +1,149 @@
+#include "FreeRTOS.h"
+#include "pico/stdlib.h"
+#include "queue.h"
+#include "string.h"
+#include "task.h"
+
+struct HostTask {
+  uint32_t notifications[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+};
+
+static struct HostTask host_harness_task;
+static TaskHandle_t    host_current_task = &host_harness_task;
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *params,
+                       UBaseType_t priority, TaskHandle_t *created_task) {
+  // There is no scheduler to run it. The harness calls task bodies directly.
+  struct HostTask *handle = calloc(1, sizeof(*handle));
+  if (handle == NULL) {
+    return pdFAIL;
+  }
+  if (created_task != NULL) {
+    *created_task = handle;
+  }
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return host_current_task; }
+
+void host_task_set_current(TaskHandle_t task) {
+  host_current_task = task != NULL ? task : &host_harness_task;
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(time_us_64() * configTICK_RATE_HZ / 1000000);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  host_time_advance_us((uint64_t)ticks * 1000000 / configTICK_RATE_HZ);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment) {
+  TickType_t wake_time = *previous_wake_time + increment;
+  TickType_t now       = xTaskGetTickCount();
+  *previous_wake_time  = wake_time;
+  if ((int32_t)(wake_time - now) <= 0) {
+    return pdFALSE;  // Deadline already passed, no delay
+  }
+  vTaskDelay(wake_time - now);
+  return pdTRUE;
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index) {
+  configASSERT(index < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+  task->notifications[index]++;
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken) {
+  task->notifications[tskDEFAULT_INDEX_TO_NOTIFY]++;
+  if (higher_priority_task_woken != NULL) {
+    *higher_priority_task_woken = pdTRUE;
+  }
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_count_on_exit,
+                                 TickType_t ticks_to_wait) {
+  configASSERT(index < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+  uint32_t *notifications = &host_current_task->notifications[index];
+
+  // Only alarms (standing in for interrupts) can notify while the task waits, so run them until
+  // one does or the wait times out
+  uint64_t deadline = ticks_to_wait == portMAX_DELAY ?
+                          UINT64_MAX :
+                          time_us_64() + (uint64_t)ticks_to_wait * 1000000 / configTICK_RATE_HZ;
+  while (*notifications == 0 && host_time_run_next_alarm(deadline)) {
+  }
+  if (*notifications == 0 && ticks_to_wait != portMAX_DELAY) {
+    host_time_advance_us(deadline - time_us_64());
+  }
+  uint32_t count = *notifications;
+  if (count > 0) {
+    *notifications = clear_count_on_exit ? 0 : count - 1;
+  }
+  return count;
+}
+
+////////////
+// Queues //
+////////////
+
+struct HostQueue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+  uint8_t     items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct HostQueue *queue = calloc(1, sizeof(*queue) + length * item_size);
+  if (queue != NULL) {
+    queue->length    = length;
+    queue->item_size = item_size;
+  }
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { free(queue); }
+
+// There's no other task to drain the queue, so a full queue fails without waiting
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait) {
+  if (queue->count == queue->length) {
+    return pdFAIL;
+  }
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+  queue->count++;
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item,
+                             BaseType_t *higher_priority_task_woken) {
+  BaseType_t sent = xQueueSend(queue, item, 0);
+  if (sent == pdPASS && higher_priority_task_woken != NULL) {
+    *higher_priority_task_woken = pdTRUE;
+  }
+  return sent;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait) {
+  uint64_t deadline = ticks_to_wait == portMAX_DELAY ?
+                          UINT64_MAX :
+                          time_us_64() + (uint64_t)ticks_to_wait * 1000000 / configTICK_RATE_HZ;
+  while (queue->count == 0 && host_time_run_next_alarm(deadline)) {
+  }
+  if (queue->count == 0) {
+    if (ticks_to_wait != portMAX_DELAY) {
+      host_time_advance_us(deadline - time_us_64());
+    }
+    return pdFAIL;
+  }
+
+  memcpy(buffer, &queue->items[queue->head * queue->item_size], queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { return queue->count; }
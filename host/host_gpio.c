@@ -0,0 +1,86 @@
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "ir_line.h"
+
+// GPIO and PWM shims. An output pin drives the virtual IR line: carrier is on while the pin is
+// high under SIO, or muxed to an enabled PWM slice.
+
+struct HostGpio {
+  enum gpio_function function;
+  bool               out;
+  bool               value;
+  bool               pull_up;
+};
+
+static struct HostGpio host_gpios[NUM_BANK0_GPIOS];
+static bool            host_pwm_slice_enabled[8];
+
+static void host_gpio_update_line(uint gpio) {
+  const struct HostGpio *pin = &host_gpios[gpio];
+  bool                   carrier;
+  if (pin->function == GPIO_FUNC_PWM) {
+    carrier = host_pwm_slice_enabled[pwm_gpio_to_slice_num(gpio)];
+  } else {
+    carrier = pin->function == GPIO_FUNC_SIO && pin->out && pin->value;
+  }
+  ir_line_set_carrier(gpio, time_us_64(), carrier);
+}
+
+void gpio_init(uint gpio) {
+  host_gpios[gpio] = (struct HostGpio){.function = GPIO_FUNC_SIO};
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+  host_gpios[gpio].out = out;
+  host_gpio_update_line(gpio);
+}
+
+void gpio_put(uint gpio, bool value) {
+  host_gpios[gpio].value = value;
+  host_gpio_update_line(gpio);
+}
+
+bool gpio_get(uint gpio) {
+  int source = ir_line_source(gpio);
+  if (source >= 0) {
+    return !ir_line_carrier_at(source, time_us_64());
+  }
+  const struct HostGpio *pin = &host_gpios[gpio];
+  return pin->out ? pin->value : pin->pull_up;
+}
+
+uint32_t gpio_get_all() {
+  uint32_t all = 0;
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+    all |= (uint32_t)gpio_get(gpio) << gpio;
+  }
+  return all;
+}
+
+void gpio_pull_up(uint gpio) { host_gpios[gpio].pull_up = true; }
+
+void gpio_pull_down(uint gpio) { host_gpios[gpio].pull_up = false; }
+
+void gpio_disable_pulls(uint gpio) { host_gpios[gpio].pull_up = false; }
+
+void gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew) {}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+  host_gpios[gpio].function = fn;
+  host_gpio_update_line(gpio);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {}
+
+void pwm_set_counter(uint slice_num, uint16_t c) {}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+  host_pwm_slice_enabled[slice_num] = enabled;
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+    if (host_gpios[gpio].function == GPIO_FUNC_PWM && pwm_gpio_to_slice_num(gpio) == slice_num) {
+      host_gpio_update_line(gpio);
+    }
+  }
+}
@@ -0,0 +1,122 @@
+#include "hardware/i2c.h"
+#include "i2c_async.h"
+#include "string.h"
+
+#define HOST_I2C_MAX_DEVICES 4
+
+struct i2c_inst {
+  uint                 baudrate;
+  struct HostI2cDevice devices[HOST_I2C_MAX_DEVICES];
+  uint                 device_count;
+};
+
+i2c_inst_t i2c0_inst;
+i2c_inst_t i2c1_inst;
+
+uint i2c_hw_index(i2c_inst_t *i2c) { return i2c == i2c1 ? 1 : 0; }
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+void host_i2c_attach(i2c_inst_t *i2c, const struct HostI2cDevice *device) {
+  hard_assert(i2c->device_count < HOST_I2C_MAX_DEVICES);
+  i2c->devices[i2c->device_count++] = *device;
+}
+
+void host_i2c_detach_all() {
+  memset(&i2c0_inst, 0, sizeof(i2c0_inst));
+  memset(&i2c1_inst, 0, sizeof(i2c1_inst));
+}
+
+uint32_t host_i2c_transfer_us(i2c_inst_t *i2c, size_t len) {
+  uint baudrate = i2c->baudrate ? i2c->baudrate : 100 * 1000;
+  // Address byte plus data, 9 clocks per byte with the ACK
+  return (uint32_t)(((uint64_t)(len + 1) * 9 * 1000000 + baudrate - 1) / baudrate);
+}
+
+static const struct HostI2cDevice *host_i2c_find(i2c_inst_t *i2c, uint8_t addr) {
+  for (uint i = 0; i < i2c->device_count; i++) {
+    if (i2c->devices[i].address == addr) {
+      return &i2c->devices[i];
+    }
+  }
+  return NULL;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  const struct HostI2cDevice *device = host_i2c_find(i2c, addr);
+  if (device == NULL) {
+    host_time_advance_us(host_i2c_transfer_us(i2c, 0));
+    return PICO_ERROR_GENERIC;
+  }
+  host_time_advance_us(host_i2c_transfer_us(i2c, len));
+  return device->write(device->device, src, len);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+  const struct HostI2cDevice *device = host_i2c_find(i2c, addr);
+  if (device == NULL) {
+    host_time_advance_us(host_i2c_transfer_us(i2c, 0));
+    return PICO_ERROR_GENERIC;
+  }
+  host_time_advance_us(host_i2c_transfer_us(i2c, len));
+  return device->read(device->device, dst, len);
+}
+
+////////////////
+// Async port //
+////////////////
+
+// A transfer reaches the device and completes once its bus time has passed on the virtual
+// clock, the way the STOP_DET interrupt ends it on the board
+
+struct HostI2cAsyncTransfer {
+  i2c_inst_t    *i2c;
+  uint8_t        address;
+  const uint8_t *src;
+  uint8_t       *dst;  // NULL for writes
+  uint8_t        len;
+};
+
+static struct HostI2cAsyncTransfer host_i2c_async_transfers[2];
+
+static int64_t host_i2c_async_complete(alarm_id_t id, void *user_data) {
+  struct HostI2cAsyncTransfer *transfer = user_data;
+  const struct HostI2cDevice  *device   = host_i2c_find(transfer->i2c, transfer->address);
+
+  int result = PICO_ERROR_GENERIC;
+  if (device != NULL) {
+    result = transfer->dst != NULL ? device->read(device->device, transfer->dst, transfer->len) :
+                                     device->write(device->device, transfer->src, transfer->len);
+  }
+  i2c_async_port_done(transfer->i2c, result < 0 ? PICO_ERROR_GENERIC : PICO_ERROR_NONE);
+
+  return 0;
+}
+
+static void host_i2c_async_start(i2c_inst_t *i2c, uint8_t address, const uint8_t *src,
+                                 uint8_t *dst, uint8_t len) {
+  struct HostI2cAsyncTransfer *transfer = &host_i2c_async_transfers[i2c_hw_index(i2c)];
+
+  transfer->i2c     = i2c;
+  transfer->address = address;
+  transfer->src     = src;
+  transfer->dst     = dst;
+  transfer->len     = len;
+
+  bool present = host_i2c_find(i2c, address) != NULL;
+  add_alarm_in_us(host_i2c_transfer_us(i2c, present ? len : 0), host_i2c_async_complete,
+                  transfer, false);
+}
+
+void i2c_async_port_init(i2c_inst_t *i2c, uint baudrate) { i2c_init(i2c, baudrate); }
+
+void i2c_async_port_write(i2c_inst_t *i2c, uint8_t address, const uint8_t *src, uint8_t len) {
+  host_i2c_async_start(i2c, address, src, NULL, len);
+}
+
+void i2c_async_port_read(i2c_inst_t *i2c, uint8_t address, uint8_t *dst, uint8_t len) {
+  host_i2c_async_start(i2c, address, NULL, dst, len);
+}
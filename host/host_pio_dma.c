@@ -0,0 +1,244 @@
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "ir_line.h"
+#include "ir_send.pio.h"
+#include "string.h"
+
+pio_hw_t host_pio_blocks[NUM_PIOS];
+
+static bool                host_pio_claimed[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static struct HostPioModel host_pio_models[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static bool                host_pio_irq0_sources[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+
+struct HostDmaChannel {
+  bool             claimed;
+  bool             irq_enabled[2];
+  bool             irq_status[2];
+  volatile void   *write_addr;
+  dma_channel_hw_t hw;
+};
+
+static struct HostDmaChannel host_dma_channels[NUM_DMA_CHANNELS];
+
+struct HostIrqHandlers {
+  irq_handler_t handlers[4];
+  uint          count;
+  bool          enabled;
+};
+
+static struct HostIrqHandlers host_irqs[NUM_IRQS];
+
+/////////
+// PIO //
+/////////
+
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const pio_program_t *program, PIO *pio,
+                                                      uint *sm, uint *offset, uint gpio_base,
+                                                      uint gpio_count, bool set_gpio_base) {
+  for (uint p = 0; p < NUM_PIOS; p++) {
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+      if (!host_pio_claimed[p][s]) {
+        host_pio_claimed[p][s] = true;
+        *pio                   = &host_pio_blocks[p];
+        *sm                    = s;
+        *offset                = 0;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+  return pio_get_index(pio) * 8 + sm + (is_tx ? 0 : 4);
+}
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num) {
+  return pio->irq & (1u << pio_interrupt_num);
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num) {
+  pio->irq &= ~(1u << pio_interrupt_num);
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled) {
+  host_pio_irq0_sources[pio_get_index(pio)][source - pis_interrupt0] = enabled;
+}
+
+void host_pio_attach(PIO pio, uint sm, const struct HostPioModel *model) {
+  host_pio_models[pio_get_index(pio)][sm] = *model;
+}
+
+void host_pio_reset() {
+  memset(host_pio_blocks, 0, sizeof(host_pio_blocks));
+  memset(host_pio_claimed, 0, sizeof(host_pio_claimed));
+  memset(host_pio_models, 0, sizeof(host_pio_models));
+  memset(host_pio_irq0_sources, 0, sizeof(host_pio_irq0_sources));
+  memset(host_dma_channels, 0, sizeof(host_dma_channels));
+  memset(host_irqs, 0, sizeof(host_irqs));
+}
+
+// Returns the model for a PIO TX FIFO address, or NULL if `addr` isn't one
+static const struct HostPioModel *host_pio_model_for_fifo(volatile void *addr) {
+  for (uint p = 0; p < NUM_PIOS; p++) {
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+      if (addr == &host_pio_blocks[p].txf[s] && host_pio_models[p][s].push != NULL) {
+        return &host_pio_models[p][s];
+      }
+    }
+  }
+  return NULL;
+}
+
+///////////////////////
+// ir_send.pio model //
+///////////////////////
+
+const pio_program_t ir_send_program = {.instructions = NULL, .length = 7, .origin = -1};
+
+static void host_ir_send_push(void *context, uint32_t word) {
+  ir_line_append_symbol((uint)(uintptr_t)context, ir_timeline_mark_us(word),
+                        ir_timeline_space_us(word));
+}
+
+void ir_send_program_init(PIO pio, uint sm, uint offset, uint pin, float carrier_hz) {
+  struct HostPioModel model = {.push = host_ir_send_push, .context = (void *)(uintptr_t)pin};
+  host_pio_attach(pio, sm, &model);
+}
+
+/////////
+// DMA //
+/////////
+
+int dma_claim_unused_channel(bool required) {
+  for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+    if (!host_dma_channels[channel].claimed) {
+      host_dma_channels[channel].claimed = true;
+      return channel;
+    }
+  }
+  hard_assert(!required);
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel) { host_dma_channels[channel].claimed = false; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) { return (dma_channel_config){0}; }
+
+void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                           enum dma_channel_transfer_size size) {}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint32_t transfer_count, bool trigger) {
+  host_dma_channels[channel].write_addr    = write_addr;
+  host_dma_channels[channel].hw.write_addr = (uint32_t)(uintptr_t)write_addr;
+  if (trigger) {
+    dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+  }
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr,
+                                          uint32_t transfer_count) {
+  struct HostDmaChannel     *dma   = &host_dma_channels[channel];
+  const struct HostPioModel *model = host_pio_model_for_fifo(dma->write_addr);
+  if (model == NULL || read_addr == NULL) {
+    return;  // Only memory to PIO transfers are modelled
+  }
+
+  const volatile uint32_t *words = read_addr;
+  for (uint32_t i = 0; i < transfer_count; i++) {
+    model->push(model->context, words[i]);
+  }
+
+  for (uint irq = 0; irq < 2; irq++) {
+    if (dma->irq_enabled[irq]) {
+      dma->irq_status[irq] = true;
+      host_irq_raise(irq == 0 ? DMA_IRQ_0 : DMA_IRQ_1);
+    }
+  }
+}
+
+bool dma_channel_is_busy(uint channel) { return false; }
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) { return &host_dma_channels[channel].hw; }
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  host_dma_channels[channel].irq_enabled[0] = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+  host_dma_channels[channel].irq_enabled[1] = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) { return host_dma_channels[channel].irq_status[0]; }
+
+bool dma_channel_get_irq1_status(uint channel) { return host_dma_channels[channel].irq_status[1]; }
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  host_dma_channels[channel].irq_status[0] = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+  host_dma_channels[channel].irq_status[1] = false;
+}
+
+/////////
+// IRQ //
+/////////
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+  struct HostIrqHandlers *irq = &host_irqs[num];
+  hard_assert(irq->count < count_of(irq->handlers));
+  irq->handlers[irq->count++] = handler;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  host_irqs[num].handlers[0] = handler;
+  host_irqs[num].count       = 1;
+}
+
+void irq_set_enabled(uint num, bool enabled) { host_irqs[num].enabled = enabled; }
+
+void host_irq_raise(uint num) {
+  const struct HostIrqHandlers *irq = &host_irqs[num];
+  if (!irq->enabled) {
+    return;
+  }
+  for (uint i = 0; i < irq->count; i++) {
+    irq->handlers[i]();
+  }
+}
+
+////////////////
+// Spin locks //
+////////////////
+
+struct spin_lock {
+  bool claimed;
+};
+
+static struct spin_lock host_spin_locks[32];
+
+int spin_lock_claim_unused(bool required) {
+  for (uint i = 0; i < count_of(host_spin_locks); i++) {
+    if (!host_spin_locks[i].claimed) {
+      host_spin_locks[i].claimed = true;
+      return (int)i;
+    }
+  }
+  hard_assert(!required);
+  return PICO_ERROR_GENERIC;
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num) { return &host_spin_locks[lock_num]; }
@@ -0,0 +1,111 @@
+#include "pico/stdlib.h"
+
+#define HOST_MAX_ALARMS 16
+
+struct HostAlarm {
+  alarm_id_t       id;  // 0 when the slot is free
+  uint64_t         time_us;
+  alarm_callback_t callback;
+  void            *user_data;
+};
+
+static uint64_t         host_now_us;
+static uint             host_core;
+static struct HostAlarm host_alarms[HOST_MAX_ALARMS];
+static alarm_id_t       host_next_alarm_id = 1;
+
+uint64_t time_us_64() { return host_now_us; }
+
+uint32_t time_us_32() { return (uint32_t)host_now_us; }
+
+static struct HostAlarm *host_time_next_alarm() {
+  struct HostAlarm *next = NULL;
+  for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+    struct HostAlarm *alarm = &host_alarms[i];
+    if (alarm->id != 0 && (next == NULL || alarm->time_us < next->time_us)) {
+      next = alarm;
+    }
+  }
+  return next;
+}
+
+static void host_time_fire(struct HostAlarm *alarm) {
+  struct HostAlarm fired = *alarm;
+  alarm->id              = 0;
+
+  int64_t reschedule = fired.callback(fired.id, fired.user_data);
+  if (reschedule != 0) {
+    // Positive values are relative to now, negative to the previous deadline
+    *alarm         = fired;
+    alarm->time_us = reschedule > 0 ? host_now_us + reschedule : fired.time_us - reschedule;
+  }
+}
+
+bool host_time_run_next_alarm(uint64_t deadline_us) {
+  struct HostAlarm *alarm = host_time_next_alarm();
+  if (alarm == NULL || alarm->time_us > deadline_us) {
+    return false;
+  }
+  if (alarm->time_us > host_now_us) {
+    host_now_us = alarm->time_us;
+  }
+  host_time_fire(alarm);
+  return true;
+}
+
+void host_time_advance_us(uint64_t us) {
+  uint64_t target = host_now_us + us;
+  while (host_time_run_next_alarm(target)) {
+  }
+  host_now_us = target;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past) {
+  if (us == 0 && fire_if_past) {
+    callback(0, user_data);
+    return 0;
+  }
+  for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+    if (host_alarms[i].id == 0) {
+      host_alarms[i] = (struct HostAlarm){
+          .id        = host_next_alarm_id++,
+          .time_us   = host_now_us + us,
+          .callback  = callback,
+          .user_data = user_data,
+      };
+      return host_alarms[i].id;
+    }
+  }
+  return PICO_ERROR_GENERIC;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past) {
+  return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+  for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+    if (alarm_id != 0 && host_alarms[i].id == alarm_id) {
+      host_alarms[i].id = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void sleep_us(uint64_t us) { host_time_advance_us(us); }
+
+void sleep_ms(uint32_t ms) { host_time_advance_us((uint64_t)ms * 1000); }
+
+void busy_wait_us_32(uint32_t us) { host_time_advance_us(us); }
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  host_time_advance_us(timeout_us);
+  return PICO_ERROR_TIMEOUT;
+}
+
+uint get_core_num() { return host_core; }
+
+void host_time_set_core(uint core) { host_core = core; }
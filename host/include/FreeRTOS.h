@@ -0,0 +1,36 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Single threaded stand-in for the FreeRTOS kernel. There is no scheduler: task functions are
+// called directly by the harness, delays advance the virtual clock and notifications are counters.
+// Waiting on a notification runs pending alarms, which stand in for interrupts.
+
+#include "stddef.h"
+#include "stdint.h"
+
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      TickType_t;
+
+#define pdFALSE       ((BaseType_t)0)
+#define pdTRUE        ((BaseType_t)1)
+#define pdPASS        pdTRUE
+#define pdFAIL        pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+#define configTICK_RATE_HZ                    ((TickType_t)1000)
+#define configMINIMAL_STACK_SIZE              256
+#define configMAX_PRIORITIES                  32
+#define configNUMBER_OF_CORES                 2
+#define configUSE_CORE_AFFINITY               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
+#define tskIDLE_PRIORITY                      ((UBaseType_t)0)
+
+#define pdMS_TO_TICKS(ms)        ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portTICK_PERIOD_MS       ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+#define configASSERT(x)          ((x) ? (void)0 : abort())
+
+#include "stdlib.h"
+
+#endif  // HOST_FREERTOS_H
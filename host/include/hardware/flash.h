@@ -0,0 +1,20 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+// Flash is an array in RAM, read through XIP_BASE like the real one. It starts out zeroed, not
+// erased, so nothing stored on it looks valid until a harness writes it.
+
+#define FLASH_PAGE_SIZE       (1u << 8)
+#define FLASH_SECTOR_SIZE     (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+extern uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE ((uintptr_t)host_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif  // HOST_HARDWARE_FLASH_H
@@ -0,0 +1,35 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "stdbool.h"
+#include "stdint.h"
+
+typedef unsigned int uint;
+
+#define NUM_BANK0_GPIOS 30
+
+enum gpio_dir { GPIO_IN = 0, GPIO_OUT = 1 };
+enum gpio_function {
+  GPIO_FUNC_SPI  = 1,
+  GPIO_FUNC_UART = 2,
+  GPIO_FUNC_I2C  = 3,
+  GPIO_FUNC_PWM  = 4,
+  GPIO_FUNC_SIO  = 5,
+  GPIO_FUNC_PIO0 = 6,
+  GPIO_FUNC_PIO1 = 7,
+  GPIO_FUNC_NULL = 0x1f,
+};
+enum gpio_slew_rate { GPIO_SLEW_RATE_SLOW = 0, GPIO_SLEW_RATE_FAST = 1 };
+
+void     gpio_init(uint gpio);
+void     gpio_set_dir(uint gpio, bool out);
+void     gpio_put(uint gpio, bool value);
+bool     gpio_get(uint gpio);
+uint32_t gpio_get_all();
+void     gpio_pull_up(uint gpio);
+void     gpio_pull_down(uint gpio);
+void     gpio_disable_pulls(uint gpio);
+void     gpio_set_slew_rate(uint gpio, enum gpio_slew_rate slew);
+void     gpio_set_function(uint gpio, enum gpio_function fn);
+
+#endif  // HOST_HARDWARE_GPIO_H
@@ -0,0 +1,40 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// Bus transactions are routed to the simulated devices attached with host_i2c_attach()
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0        (&i2c0_inst)
+#define i2c1        (&i2c1_inst)
+#define i2c_default i2c0
+
+#define PICO_DEFAULT_I2C         0
+
+#define PICO_DEFAULT_I2C_SDA_PIN 4
+#define PICO_DEFAULT_I2C_SCL_PIN 5
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int  i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int  i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+uint i2c_hw_index(i2c_inst_t *i2c);
+
+struct HostI2cDevice {
+  uint8_t address;
+  // Return the number of bytes transferred, or PICO_ERROR_GENERIC to NACK
+  int (*write)(void *device, const uint8_t *src, size_t len);
+  int (*read)(void *device, uint8_t *dst, size_t len);
+  void *device;
+};
+
+void host_i2c_attach(i2c_inst_t *i2c, const struct HostI2cDevice *device);
+void host_i2c_detach_all();
+
+// Bus time per transaction at the configured baud rate, added to the virtual clock
+uint32_t host_i2c_transfer_us(i2c_inst_t *i2c, size_t len);
+
+#endif  // HOST_HARDWARE_I2C_H
@@ -0,0 +1,29 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)();
+
+enum irq_num {
+  PIO0_IRQ_0 = 7,
+  PIO0_IRQ_1 = 8,
+  PIO1_IRQ_0 = 9,
+  PIO1_IRQ_1 = 10,
+  DMA_IRQ_0  = 11,
+  DMA_IRQ_1  = 12,
+  I2C0_IRQ   = 23,
+  I2C1_IRQ   = 24,
+  NUM_IRQS   = 32,
+};
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+// Runs every handler registered on an IRQ line, as the NVIC would
+void host_irq_raise(uint num);
+
+#endif  // HOST_HARDWARE_IRQ_H
@@ -0,0 +1,58 @@
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+// PIO blocks are not emulated instruction by instruction. A state machine whose program has a
+// host model (see ir_send.pio.h) is attached to it, and the DMA shim hands FIFO words to that
+// model directly.
+
+#define NUM_PIOS       2
+#define NUM_PIO_STATE_MACHINES 4
+
+typedef struct {
+  volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+  volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+  volatile uint32_t irq;
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_blocks[NUM_PIOS];
+
+#define pio0 (&host_pio_blocks[0])
+#define pio1 (&host_pio_blocks[1])
+
+typedef struct {
+  const uint16_t *instructions;
+  uint8_t         length;
+  int8_t          origin;
+} pio_program_t;
+
+enum pio_interrupt_source {
+  pis_interrupt0 = 8,
+  pis_interrupt1,
+  pis_interrupt2,
+  pis_interrupt3,
+};
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+
+bool pio_claim_free_sm_and_add_program_for_gpio_range(const pio_program_t *program, PIO *pio,
+                                                      uint *sm, uint *offset, uint gpio_base,
+                                                      uint gpio_count, bool set_gpio_base);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+
+// Model of a state machine's program. `push` receives every word written to its TX FIFO.
+struct HostPioModel {
+  void (*push)(void *context, uint32_t word);
+  void *context;
+};
+
+void host_pio_attach(PIO pio, uint sm, const struct HostPioModel *model);
+void host_pio_reset();
+
+#endif  // HOST_HARDWARE_PIO_H
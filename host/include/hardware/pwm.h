@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_PWM_H
+#define HOST_HARDWARE_PWM_H
+
+#include "pico/stdlib.h"
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_counter(uint slice_num, uint16_t c);
+void pwm_set_enabled(uint slice_num, bool enabled);
+
+#endif  // HOST_HARDWARE_PWM_H
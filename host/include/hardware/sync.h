@@ -0,0 +1,19 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+static inline uint32_t save_and_disable_interrupts() { return 0; }
+static inline void     restore_interrupts(uint32_t status) {}
+static inline void     __dmb() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+// Single threaded, so locks only need to exist
+typedef struct spin_lock spin_lock_t;
+
+int          spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) { return 0; }
+static inline void     spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {}
+
+#endif  // HOST_HARDWARE_SYNC_H
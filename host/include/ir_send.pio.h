@@ -0,0 +1,14 @@
+#ifndef HOST_IR_SEND_PIO_H
+#define HOST_IR_SEND_PIO_H
+
+// Host model of ir_send.pio: each symbol pulled from the FIFO becomes a mark and a space on the
+// virtual IR line, with the durations the state machine would produce.
+
+#include "hardware/pio.h"
+#include "ir_timeline.h"
+
+extern const pio_program_t ir_send_program;
+
+void ir_send_program_init(PIO pio, uint sm, uint offset, uint pin, float carrier_hz);
+
+#endif  // HOST_IR_SEND_PIO_H
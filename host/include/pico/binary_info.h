@@ -0,0 +1,7 @@
+#ifndef HOST_PICO_BINARY_INFO_H
+#define HOST_PICO_BINARY_INFO_H
+
+#define bi_decl(x)
+#define bi_2pins_with_func(a, b, c) 0
+
+#endif  // HOST_PICO_BINARY_INFO_H
@@ -0,0 +1,69 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for the parts of the Pico SDK the protocol and driver code uses. Time is virtual:
+// it only moves when the code sleeps or the harness advances it, so runs are deterministic.
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+#include "stdio.h"
+#include <stdlib.h>
+
+typedef unsigned int uint;
+
+#define __isr
+#define __unused                __attribute__((unused))
+#define __not_in_flash_func(f)  f
+#define __in_flash(group)
+#define __time_critical_func(f) f
+#define hard_assert(x)          ((x) ? (void)0 : abort())
+#define count_of(a)             (sizeof(a) / sizeof((a)[0]))
+
+#define NUM_CORES 2
+
+enum pico_error_codes {
+  PICO_OK                              = 0,
+  PICO_ERROR_NONE                      = 0,
+  PICO_ERROR_TIMEOUT                   = -1,
+  PICO_ERROR_GENERIC                   = -2,
+  PICO_ERROR_NO_DATA                   = -3,
+  PICO_ERROR_NOT_PERMITTED             = -4,
+  PICO_ERROR_INVALID_ARG               = -5,
+  PICO_ERROR_IO                        = -6,
+  PICO_ERROR_BADAUTH                   = -7,
+  PICO_ERROR_CONNECT_FAILED            = -8,
+  PICO_ERROR_INSUFFICIENT_RESOURCES    = -9,
+  PICO_ERROR_INVALID_ADDRESS           = -10,
+  PICO_ERROR_BAD_ALIGNMENT             = -11,
+  PICO_ERROR_INVALID_STATE             = -12,
+  PICO_ERROR_BUFFER_TOO_SMALL          = -13,
+  PICO_ERROR_PRECONDITION_NOT_MET      = -14,
+  PICO_ERROR_MODIFIED_DATA             = -15,
+  PICO_ERROR_INVALID_DATA              = -16,
+  PICO_ERROR_NOT_FOUND                 = -17,
+  PICO_ERROR_UNSUPPORTED_MODIFICATION  = -18,
+  PICO_ERROR_LOCK_REQUIRED             = -19,
+  PICO_ERROR_VERSION_MISMATCH          = -20,
+  PICO_ERROR_RESOURCE_IN_USE           = -21,
+};
+
+uint32_t time_us_32();
+uint64_t time_us_64();
+void     sleep_ms(uint32_t ms);
+void     sleep_us(uint64_t us);
+void     busy_wait_us_32(uint32_t us);
+
+uint get_core_num();
+
+// The console never has input, so this waits out the timeout
+int getchar_timeout_us(uint32_t timeout_us);
+
+// Harness controls for the virtual clock
+void host_time_advance_us(uint64_t us);
+void host_time_set_core(uint core);
+
+#include "hardware/gpio.h"
+#include "pico/time.h"
+
+#endif  // HOST_PICO_STDLIB_H
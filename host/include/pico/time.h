@@ -0,0 +1,24 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include "stdbool.h"
+#include "stdint.h"
+
+// Alarms on the virtual clock. Callbacks run from host_time_advance_us() as the clock passes
+// their deadline, the way the timer IRQ would run them on the board.
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+// Returns a positive ID, or 0 if the alarm fired immediately because its time had passed
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past);
+bool       cancel_alarm(alarm_id_t alarm_id);
+
+// Advances the clock to the next pending alarm, no further than `deadline_us`, and runs it.
+// Returns false if no alarm was due by then.
+bool host_time_run_next_alarm(uint64_t deadline_us);
+
+#endif  // HOST_PICO_TIME_H
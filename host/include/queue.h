@@ -0,0 +1,18 @@
+#ifndef HOST_QUEUE_H
+#define HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+// Copying queues. Like notifications, only alarms can fill a queue while the task waits on it.
+
+typedef struct HostQueue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void          vQueueDelete(QueueHandle_t queue);
+BaseType_t    xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t    xQueueSendFromISR(QueueHandle_t queue, const void *item,
+                                BaseType_t *higher_priority_task_woken);
+BaseType_t    xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif  // HOST_QUEUE_H
@@ -0,0 +1,30 @@
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t   xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth,
+                         void *params, UBaseType_t priority, TaskHandle_t *created_task);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t   xTaskGetTickCount();
+void         vTaskDelay(TickType_t ticks);
+BaseType_t   xTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment);
+#define vTaskDelayUntil(prev, inc) ((void)xTaskDelayUntil((prev), (inc)))
+
+#define tskDEFAULT_INDEX_TO_NOTIFY 0
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index);
+void       vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken);
+uint32_t   ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_count_on_exit,
+                                   TickType_t ticks_to_wait);
+#define xTaskNotifyGive(task) xTaskNotifyGiveIndexed((task), tskDEFAULT_INDEX_TO_NOTIFY)
+#define ulTaskNotifyTake(clear, ticks) \
+  ulTaskNotifyTakeIndexed(tskDEFAULT_INDEX_TO_NOTIFY, (clear), (ticks))
+
+// Makes `task` the one xTaskGetCurrentTaskHandle() returns. NULL selects the harness's own task.
+void host_task_set_current(TaskHandle_t task);
+
+#endif  // HOST_TASK_H
@@ -0,0 +1,169 @@
+#include "ir_channel.h"
+
+#include "ir_loopback.h"
+#include "math.h"
+
+#define IR_CHANNEL_MAX_RUNS (1 << 16)
+
+static struct IrLineRun ir_channel_runs[IR_CHANNEL_MAX_RUNS];
+
+static void ir_channel_loopback(bool level, uint32_t duration_us, void *user_data) {
+  ir_loopback_feed(level, duration_us);
+  if (level && duration_us >= IR_CHANNEL_FRAME_GAP_US) {
+    ir_loopback_frame_end();
+  }
+}
+
+void ir_channel_init(struct IrChannel *channel, uint tx_pin, const struct IrChannelModel *model,
+                     uint32_t seed) {
+  *channel = (struct IrChannel){
+      .model  = *model,
+      .sink   = ir_channel_loopback,
+      .random = seed ? seed : 1,
+      .tx_pin = tx_pin,
+  };
+}
+
+void ir_channel_set_sink(struct IrChannel *channel, ir_channel_sink_t sink, void *user_data) {
+  channel->sink      = sink;
+  channel->user_data = user_data;
+}
+
+///////////
+// Model //
+///////////
+
+static uint32_t ir_channel_random(struct IrChannel *channel) {
+  uint32_t x      = channel->random;
+  x              ^= x << 13;
+  x              ^= x >> 17;
+  x              ^= x << 5;
+  channel->random = x;
+  return x;
+}
+
+static bool ir_channel_chance(struct IrChannel *channel, uint32_t ppm) {
+  return ppm != 0 && ir_channel_random(channel) % 1000000 < ppm;
+}
+
+// Box-Muller, which gives a pair at a time
+static float ir_channel_gaussian(struct IrChannel *channel) {
+  if (channel->has_spare) {
+    channel->has_spare = false;
+    return channel->spare;
+  }
+  float u1     = (float)((ir_channel_random(channel) >> 8) + 1) / (float)(1 << 24);
+  float u2     = (float)(ir_channel_random(channel) >> 8) / (float)(1 << 24);
+  float radius = sqrtf(-2.0f * logf(u1));
+  float angle  = 2.0f * (float)M_PI * u2;
+  channel->spare     = radius * sinf(angle);
+  channel->has_spare = true;
+  return radius * cosf(angle);
+}
+
+static int32_t ir_channel_jitter(struct IrChannel *channel) {
+  int32_t jitter = 0;
+  if (channel->model.jitter_us != 0) {
+    jitter += (int32_t)(ir_channel_random(channel) % (2 * channel->model.jitter_us + 1)) -
+              (int32_t)channel->model.jitter_us;
+  }
+  if (channel->model.jitter_sigma_us != 0) {
+    jitter += (int32_t)lroundf(ir_channel_gaussian(channel) * channel->model.jitter_sigma_us);
+  }
+  return jitter;
+}
+
+// Runs of the same level come out as one, as the receiver would see them
+static void ir_channel_emit(struct IrChannel *channel, bool level, uint32_t duration_us) {
+  if (channel->pending_us != 0 && channel->pending_level != level) {
+    channel->sink(channel->pending_level, channel->pending_us, channel->user_data);
+    channel->stats.runs++;
+    channel->pending_us = 0;
+  }
+  channel->pending_level = level;
+  channel->pending_us += duration_us;
+}
+
+static void ir_channel_frame_gap(struct IrChannel *channel) {
+  // A space held back runs into the gap, which the receiver clamps
+  if (channel->pending_us != 0 && !channel->pending_level) {
+    channel->sink(false, channel->pending_us, channel->user_data);
+    channel->stats.runs++;
+  }
+  channel->pending_us = 0;
+  channel->sink(true, IR_CHANNEL_FRAME_GAP_US, channel->user_data);
+  channel->stats.runs++;
+  // The edge after a gap starts from a clean slate
+  channel->offset_us = 0;
+}
+
+void ir_channel_feed(struct IrChannel *channel, bool level, uint32_t duration_us) {
+  if (level && duration_us >= IR_CHANNEL_FRAME_GAP_US) {
+    ir_channel_frame_gap(channel);
+    return;
+  }
+
+  // This run ends on the edge being moved now
+  int32_t  offset   = ir_channel_jitter(channel) + (level ? 0 : channel->model.mark_stretch_us);
+  int32_t  moved    = (int32_t)duration_us + offset - channel->offset_us;
+  uint32_t duration = moved > 1 ? (uint32_t)moved : 1;
+  channel->offset_us = offset;
+
+  if (!level && ir_channel_chance(channel, channel->model.drop_ppm)) {
+    level = true;
+    channel->stats.dropped++;
+  }
+
+  uint32_t glitch = channel->model.glitch_us;
+  if (duration > glitch + 1 && ir_channel_chance(channel, channel->model.glitch_ppm)) {
+    uint32_t before = 1 + ir_channel_random(channel) % (duration - glitch - 1);
+    ir_channel_emit(channel, level, before);
+    ir_channel_emit(channel, !level, glitch);
+    ir_channel_emit(channel, level, duration - before - glitch);
+    channel->stats.glitches++;
+    return;
+  }
+
+  ir_channel_emit(channel, level, duration);
+}
+
+/////////////////
+// Line replay //
+/////////////////
+
+void ir_channel_deliver(struct IrChannel *channel) {
+  size_t count = ir_line_runs(channel->tx_pin, ir_channel_runs, IR_CHANNEL_MAX_RUNS);
+  hard_assert(count < IR_CHANNEL_MAX_RUNS);
+
+  // The last run is the line's current level and may still grow, so it waits for the next edge
+  for (; channel->delivered + 1 < count; channel->delivered++) {
+    if (channel->gap_sent) {
+      channel->gap_sent = false;  // Already ended its frame below
+      continue;
+    }
+    const struct IrLineRun *run = &ir_channel_runs[channel->delivered];
+    ir_channel_feed(channel, run->level, run->duration_us);
+  }
+
+  // Idle since the end of the last space for a whole gap, so the receiver would end the frame
+  uint64_t busy_until = ir_line_busy_until(channel->tx_pin);
+  if (count > 0 && !channel->gap_sent &&
+      time_us_64() >= busy_until + IR_CHANNEL_FRAME_GAP_US) {
+    const struct IrLineRun *run = &ir_channel_runs[count - 1];
+    ir_channel_feed(channel, run->level, run->duration_us + IR_CHANNEL_FRAME_GAP_US);
+    channel->gap_sent = true;
+  }
+}
+
+static int64_t ir_channel_poll(alarm_id_t id, void *user_data) {
+  struct IrChannel *channel = user_data;
+  ir_channel_deliver(channel);
+  return channel->poll_us;
+}
+
+void ir_channel_start(struct IrChannel *channel, uint32_t poll_us) {
+  channel->poll_us = poll_us;
+  channel->alarm   = add_alarm_in_us(poll_us, ir_channel_poll, channel, true);
+}
+
+void ir_channel_stop(struct IrChannel *channel) { cancel_alarm(channel->alarm); }
@@ -0,0 +1,89 @@
+#ifndef IR_CHANNEL_H
+#define IR_CHANNEL_H
+
+#include "ir_line.h"
+#include "pico/stdlib.h"
+
+// Stands in for the IR receiver and ir_recv_task in the host build. Replays what an emitter put
+// on the virtual IR line through a channel model and into the loopback checker, ending each frame
+// once the line has been idle for the receiver's frame gap. ir_channel_sim.c drives the same
+// model straight from timelines to measure the decoder's frame error rate.
+//
+// The model applies, in order:
+// - Edge jitter. Every edge moves by a uniformly distributed amount of up to `jitter_us` either
+//   way plus a normally distributed one with `jitter_sigma_us`, so the lengths of neighbouring
+//   runs err in opposite directions as they do on a real receiver.
+// - AGC stretch. The end of every mark is delayed by `mark_stretch_us`, the way a receiver's AGC
+//   holds its output low after the carrier stops. Negative for a receiver that releases early.
+// - Missing edges. Runs are levels, so an edge can only go missing together with the one that
+//   closes its pulse: with `drop_ppm` parts per million a mark isn't seen at all and merges with
+//   the spaces either side.
+// - Glitches. With `glitch_ppm` parts per million a run has a `glitch_us` pulse of the other
+//   level at a random point inside it, such as a flicker from a lamp or a carrier dropout.
+
+#define IR_CHANNEL_FRAME_GAP_US 55000  // IR_RECV_FRAME_GAP_US
+
+struct IrChannelModel {
+  uint32_t jitter_us;
+  uint32_t jitter_sigma_us;
+  int32_t  mark_stretch_us;
+  uint32_t drop_ppm;
+  uint32_t glitch_ppm;
+  uint32_t glitch_us;
+};
+
+struct IrChannelStats {
+  uint32_t runs;  // Runs put out, including the pieces of glitched ones
+  uint32_t dropped;
+  uint32_t glitches;
+};
+
+// Gets every run that leaves the channel, as receiver output level (low during a mark). A run of
+// IR_CHANNEL_FRAME_GAP_US ends a frame.
+typedef void (*ir_channel_sink_t)(bool level, uint32_t duration_us, void *user_data);
+
+struct IrChannel {
+  struct IrChannelModel model;
+  struct IrChannelStats stats;
+  ir_channel_sink_t     sink;
+  void                 *user_data;
+
+  uint32_t random;         // xorshift32 state, never zero
+  float    spare;          // Second normal deviate of the last pair
+  bool     has_spare;
+  int32_t  offset_us;      // How far the last edge was moved
+  bool     pending_level;  // Held back in case the next run merges into it
+  uint32_t pending_us;     // 0 if nothing is held back
+
+  // Line replay
+  uint       tx_pin;
+  size_t     delivered;  // Runs on the line already fed to the channel
+  bool       gap_sent;   // The line's last run has already ended a frame
+  uint32_t   poll_us;
+  alarm_id_t alarm;
+};
+
+// Starts with the loopback checker as the sink
+void ir_channel_init(struct IrChannel *channel, uint tx_pin, const struct IrChannelModel *model,
+                     uint32_t seed);
+
+void ir_channel_set_sink(struct IrChannel *channel, ir_channel_sink_t sink, void *user_data);
+
+// Passes one run as the transmitter produced it through the model. Idle runs of at least
+// IR_CHANNEL_FRAME_GAP_US are clamped to it and end the frame.
+void ir_channel_feed(struct IrChannel *channel, bool level, uint32_t duration_us);
+
+/////////////////
+// Line replay //
+/////////////////
+
+// Feeds the channel every run on the line that has finished since the last call
+void ir_channel_deliver(struct IrChannel *channel);
+
+// Calls ir_channel_deliver() every `poll_us` from an alarm, so it runs while the sender waits.
+// Waits without a timeout never return while it runs, so stop it before stepping anything that
+// blocks on a queue.
+void ir_channel_start(struct IrChannel *channel, uint32_t poll_us);
+void ir_channel_stop(struct IrChannel *channel);
+
+#endif  // IR_CHANNEL_H
@@ -0,0 +1,184 @@
+// Measures how often the decoder loses a frame to each impairment of the channel model in
+// ir_channel.h, so its acceptance windows in ir_protocol.hpp can be chosen from data. Sweeps one
+// impairment at a time over a baseline receiver and prints one CSV row per point:
+//
+//   impairment,value,frames,lost,wrong,frame_error_rate,preamble_errors,mark_errors,space_errors,
+//   parity_errors
+//
+// `lost` frames never decoded, `wrong` ones decoded with different bits. The decoder's error
+// counters show which window rejected them. Frames go straight from the timeline into the model,
+// without the virtual clock, at about 40000 a second.
+//
+//   ir_channel_sim [frames per point] [seed] > fer.csv
+
+#include "cmd_gen.h"
+#include "ir_channel.h"
+#include "ir_decoder.h"
+#include "ir_timeline.h"
+#include "stddef.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define IR_SIM_DEFAULT_FRAMES 20000
+#define IR_SIM_FRAME_POOL     64  // Random frames, encoded once and sent in random order
+
+// Every sweep starts from one of these. A little jitter, as from any real receiver. With over 400
+// bits to a frame, the frame error rate is very sensitive to it.
+static const struct IrChannelModel ir_sim_baseline = {
+    .jitter_sigma_us = 2,
+    .glitch_us       = 20,
+};
+static const struct IrChannelModel ir_sim_glitchy = {
+    .jitter_sigma_us = 2,
+    .glitch_ppm      = 1000,
+};
+
+static const int32_t ir_sim_jitter_sigmas[] = {0, 1, 2, 3, 4, 5, 6, 8, 10, 15, 20};
+static const int32_t ir_sim_stretches[] = {-60, -50, -40, -30, -20, -10, 0,
+                                           10,  20,  30,  40,  50,  60};
+static const int32_t ir_sim_rates_ppm[] = {0, 10, 30, 100, 300, 1000, 3000};
+static const int32_t ir_sim_glitch_widths[] = {5, 10, 20, 50, 100, 200};
+
+struct IrSimSweep {
+  const char                  *name;
+  size_t                       field;  // Offset of the value in struct IrChannelModel
+  const struct IrChannelModel *base;
+  const int32_t               *values;
+  size_t                       count;
+};
+
+#define IR_SIM_SWEEP(field_name, base_model, value_list)                          \
+  {#field_name, offsetof(struct IrChannelModel, field_name), &(base_model), value_list, \
+   count_of(value_list)}
+
+static const struct IrSimSweep ir_sim_sweeps[] = {
+    IR_SIM_SWEEP(jitter_sigma_us, ir_sim_baseline, ir_sim_jitter_sigmas),
+    IR_SIM_SWEEP(mark_stretch_us, ir_sim_baseline, ir_sim_stretches),
+    IR_SIM_SWEEP(drop_ppm, ir_sim_baseline, ir_sim_rates_ppm),
+    IR_SIM_SWEEP(glitch_ppm, ir_sim_baseline, ir_sim_rates_ppm),
+    IR_SIM_SWEEP(glitch_us, ir_sim_glitchy, ir_sim_glitch_widths),
+};
+
+struct IrSimPoint {
+  struct IrDecoder   decoder;
+  struct AirconFrame sent;
+  uint32_t           decoded;  // Frames completed since the last one was sent
+  bool               correct;
+};
+
+static void ir_sim_frame_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                 void *user_data) {
+  struct IrSimPoint *point = user_data;
+  point->decoded++;
+  point->correct = memcmp(frame, point->sent.bytes, COMMAND_BYTE_COUNT) == 0;
+}
+
+static void ir_sim_receive(bool level, uint32_t duration_us, void *user_data) {
+  struct IrSimPoint *point = user_data;
+  ir_decoder_feed(&point->decoder, level, duration_us);
+}
+
+static uint32_t ir_sim_random(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static void ir_sim_make_pool(struct AirconFrame *frames, struct IrTimeline *timelines,
+                             uint32_t *random) {
+  static const enum AirconUpdateType updates[] = {
+      AC_UPDATE_AIRCON_MODE, AC_UPDATE_TIMER_ON, AC_UPDATE_TIMER_OFF, AC_UPDATE_FAN_SPEED,
+      AC_UPDATE_TEMP_DOWN,   AC_UPDATE_TEMP_UP,  AC_UPDATE_FIN_DIR,
+  };
+  static const enum AirconMode modes[] = {
+      AC_MODE_OFF, AC_MODE_VENTILATION, AC_MODE_COOLING, AC_MODE_DEHUMIDIFY, AC_MODE_HEATING,
+  };
+  static const enum AirconFanSpeed fans[] = {
+      AC_FAN_0, AC_FAN_1, AC_FAN_2, AC_FAN_3, AC_FAN_AUTO, AC_FAN_5,
+  };
+
+  for (uint i = 0; i < IR_SIM_FRAME_POOL; i++) {
+    aircon_frame_encode(&frames[i], updates[ir_sim_random(random) % count_of(updates)],
+                        modes[ir_sim_random(random) % count_of(modes)],
+                        fans[ir_sim_random(random) % count_of(fans)],
+                        16 + ir_sim_random(random) % 17, ir_sim_random(random) % 720,
+                        ir_sim_random(random) % 720);
+    ir_timeline_encode(&frames[i], &timelines[i]);
+  }
+}
+
+static void ir_sim_run_point(const struct IrChannelModel *model, uint32_t frames, uint32_t seed,
+                             const struct AirconFrame *pool, const struct IrTimeline *timelines,
+                             const char *name, int32_t value) {
+  static struct IrSimPoint point;
+  struct IrChannel         channel;
+  uint32_t                 random = (seed ^ 0x9E3779B9) | 1;  // Apart from the channel's stream
+  uint32_t                 lost   = 0;
+  uint32_t                 wrong  = 0;
+
+  ir_decoder_init(&point.decoder, ir_sim_frame_decoded, &point);
+  ir_channel_init(&channel, 0, model, seed);
+  ir_channel_set_sink(&channel, ir_sim_receive, &point);
+
+  for (uint32_t n = 0; n < frames; n++) {
+    uint32_t                 pick     = ir_sim_random(&random) % IR_SIM_FRAME_POOL;
+    const struct IrTimeline *timeline = &timelines[pick];
+    point.sent                        = pool[pick];
+    point.decoded                     = 0;
+    point.correct                     = false;
+
+    // The trailer space of the closing symbol is the gap between frames
+    for (uint32_t i = 0; i < timeline->count; i++) {
+      ir_channel_feed(&channel, false, ir_timeline_mark_us(timeline->symbols[i]));
+      ir_channel_feed(&channel, true, ir_timeline_space_us(timeline->symbols[i]));
+    }
+
+    if (point.decoded == 0) {
+      lost++;
+    } else if (!point.correct) {
+      wrong++;
+    }
+  }
+
+  const struct IrDecoderStats *stats = &point.decoder.stats;
+  printf("%s,%d,%u,%u,%u,%.6g,%u,%u,%u,%u\n", name, value, frames, lost, wrong,
+         (double)(lost + wrong) / frames, stats->preamble_errors, stats->mark_errors,
+         stats->space_errors, stats->parity_errors);
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : IR_SIM_DEFAULT_FRAMES;
+  uint32_t seed   = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 1;
+  if (frames == 0) {
+    fprintf(stderr, "usage: %s [frames per point] [seed]\n", argv[0]);
+    return 1;
+  }
+
+  static struct AirconFrame pool[IR_SIM_FRAME_POOL];
+  static struct IrTimeline  timelines[IR_SIM_FRAME_POOL];
+  uint32_t                  random = seed ? seed : 1;
+  ir_sim_make_pool(pool, timelines, &random);
+
+  printf("# %u frames per point, seed %u\n", frames, seed);
+  printf("impairment,value,frames,lost,wrong,frame_error_rate,preamble_errors,mark_errors,"
+         "space_errors,parity_errors\n");
+
+  for (size_t s = 0; s < count_of(ir_sim_sweeps); s++) {
+    const struct IrSimSweep *sweep = &ir_sim_sweeps[s];
+    for (size_t v = 0; v < sweep->count; v++) {
+      struct IrChannelModel model = *sweep->base;
+      int32_t               value = sweep->values[v];
+      memcpy((uint8_t *)&model + sweep->field, &value, sizeof(value));
+      // Every point gets its own reproducible stream
+      ir_sim_run_point(&model, frames, ir_sim_random(&random), pool, timelines, sweep->name,
+                       value);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include "ir_line.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct IrLineEdge {
+  uint64_t time_us;
+  bool     on;
+};
+
+struct IrLinePin {
+  struct IrLineEdge *edges;
+  size_t             count;
+  size_t             capacity;
+  uint64_t           busy_until;
+};
+
+static struct IrLinePin ir_line_pins[NUM_BANK0_GPIOS];
+static uint             ir_line_sources[NUM_BANK0_GPIOS];  // Source pin + 1, 0 if unconnected
+
+void ir_line_reset() {
+  for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+    free(ir_line_pins[pin].edges);
+  }
+  memset(ir_line_sources, 0, sizeof(ir_line_sources));
+  memset(ir_line_pins, 0, sizeof(ir_line_pins));
+}
+
+void ir_line_set_carrier(uint pin, uint64_t time_us, bool on) {
+  struct IrLinePin *line = &ir_line_pins[pin];
+  bool              was_on = line->count > 0 && line->edges[line->count - 1].on;
+  if (was_on == on) {
+    return;  // Not an edge
+  }
+  if (line->count == line->capacity) {
+    line->capacity = line->capacity ? 2 * line->capacity : 1024;
+    line->edges    = realloc(line->edges, line->capacity * sizeof(*line->edges));
+    hard_assert(line->edges != NULL);
+  }
+  line->edges[line->count++] = (struct IrLineEdge){.time_us = time_us, .on = on};
+  if (time_us > line->busy_until) {
+    line->busy_until = time_us;
+  }
+}
+
+void ir_line_append_symbol(uint pin, uint32_t mark_us, uint32_t space_us) {
+  struct IrLinePin *line  = &ir_line_pins[pin];
+  uint64_t          start = line->busy_until > time_us_64() ? line->busy_until : time_us_64();
+
+  ir_line_set_carrier(pin, start, true);
+  ir_line_set_carrier(pin, start + mark_us, false);
+  line->busy_until = start + mark_us + space_us;
+}
+
+uint64_t ir_line_busy_until(uint pin) { return ir_line_pins[pin].busy_until; }
+
+bool ir_line_carrier_at(uint pin, uint64_t time_us) {
+  const struct IrLinePin *line = &ir_line_pins[pin];
+  bool                    on   = false;
+  for (size_t i = 0; i < line->count && line->edges[i].time_us <= time_us; i++) {
+    on = line->edges[i].on;
+  }
+  return on;
+}
+
+static size_t ir_line_add_run(struct IrLineRun *runs, size_t written, bool level,
+                              uint64_t duration_us) {
+  // Zero length spaces leave two marks back to back, which the receiver sees as one
+  if (written > 0 && runs[written - 1].level == level) {
+    runs[written - 1].duration_us += duration_us;
+    return written;
+  }
+  runs[written] = (struct IrLineRun){.level = level, .duration_us = duration_us};
+  return written + 1;
+}
+
+size_t ir_line_runs(uint pin, struct IrLineRun *runs, size_t max_runs) {
+  const struct IrLinePin *line    = &ir_line_pins[pin];
+  size_t                  written = 0;
+  uint64_t                last    = 0;
+  bool                    on      = false;
+
+  for (size_t i = 0; i < line->count && written < max_runs; i++) {
+    if (line->edges[i].time_us > last) {
+      written = ir_line_add_run(runs, written, !on, line->edges[i].time_us - last);
+    }
+    last = line->edges[i].time_us;
+    on   = line->edges[i].on;
+  }
+  if (written < max_runs && line->busy_until > last) {
+    written = ir_line_add_run(runs, written, !on, line->busy_until - last);
+  }
+
+  return written;
+}
+
+void ir_line_connect(uint rx_pin, uint tx_pin) { ir_line_sources[rx_pin] = tx_pin + 1; }
+
+int ir_line_source(uint rx_pin) { return (int)ir_line_sources[rx_pin] - 1; }
@@ -0,0 +1,35 @@
+#ifndef IR_LINE_H
+#define IR_LINE_H
+
+#include "pico/stdlib.h"
+
+// Virtual IR line. Records when each emitter pin has carrier on, and replays it as the level runs
+// an IR receiver would output (low while carrier is present, high otherwise).
+
+struct IrLineRun {
+  bool     level;
+  uint32_t duration_us;
+};
+
+void ir_line_reset();
+
+// Records a carrier edge on `pin`. Edges on a pin must be added in time order.
+void ir_line_set_carrier(uint pin, uint64_t time_us, bool on);
+
+// Appends a mark and space after whatever is already scheduled on `pin`, no earlier than now
+void ir_line_append_symbol(uint pin, uint32_t mark_us, uint32_t space_us);
+
+// Time at which everything scheduled on `pin` has finished
+uint64_t ir_line_busy_until(uint pin);
+
+bool ir_line_carrier_at(uint pin, uint64_t time_us);
+
+// Receiver view of `pin` from time 0 to the end of the last space. Returns the number of runs
+// written, at most `max_runs`.
+size_t ir_line_runs(uint pin, struct IrLineRun *runs, size_t max_runs);
+
+// Makes gpio_get(rx_pin) return the receiver output for the carrier on tx_pin
+void ir_line_connect(uint rx_pin, uint tx_pin);
+int  ir_line_source(uint rx_pin);
+
+#endif  // IR_LINE_H
@@ -0,0 +1,233 @@
+#include "scd40_sim.h"
+
+#include "scd40_crc.h"
+#include "string.h"
+
+#define SCD40_SIM_LOW_POWER_PERIOD_US 30000000
+
+struct Scd40SimCommand {
+  uint16_t opcode;
+  uint32_t execution_us;
+  uint8_t  write_words;  // Data words sent after the opcode
+  uint8_t  read_words;   // Response words
+  bool     allowed_during_periodic;
+  bool     scd41_only;
+};
+
+static const struct Scd40SimCommand scd40_sim_commands[] = {
+    {0x21B1, 0, 0, 0, false, false},         // start_periodic_measurement
+    {0xEC05, 1000, 0, 3, true, false},       // read_measurement
+    {0x3F86, 500000, 0, 0, true, false},     // stop_periodic_measurement
+    {0x241D, 1000, 1, 0, false, false},      // set_temperature_offset
+    {0x2318, 1000, 0, 1, false, false},      // get_temperature_offset
+    {0x2427, 1000, 1, 0, false, false},      // set_sensor_altitude
+    {0x2322, 1000, 0, 1, false, false},      // get_sensor_altitude
+    {0xE000, 1000, 1, 0, true, false},       // set_ambient_pressure
+    {0x362F, 400000, 1, 1, false, false},    // perform_forced_recalibration
+    {0x2416, 1000, 1, 0, false, false},      // set_automatic_self_calibration_enabled
+    {0x2313, 1000, 0, 1, false, false},      // get_automatic_self_calibration_enabled
+    {0x21AC, 0, 0, 0, false, false},         // start_low_power_periodic_measurement
+    {0xE4B8, 1000, 0, 1, true, false},       // get_data_ready_status
+    {0x3615, 800000, 0, 0, false, false},    // persist_settings
+    {0x3682, 1000, 0, 3, false, false},      // get_serial_number
+    {0x3639, 10000000, 0, 1, false, false},  // perform_self_test
+    {0x3632, 1200000, 0, 0, false, false},   // perform_factory_reset
+    {0x3646, 30000, 0, 0, false, false},     // reinit
+    {0x219D, 5000000, 0, 0, false, true},    // measure_single_shot
+    {0x2196, 50000, 0, 0, false, true},      // measure_single_shot_rht_only
+};
+
+static const struct Scd40SimCommand *scd40_sim_find(uint16_t opcode) {
+  for (size_t i = 0; i < count_of(scd40_sim_commands); i++) {
+    if (scd40_sim_commands[i].opcode == opcode) {
+      return &scd40_sim_commands[i];
+    }
+  }
+  return NULL;
+}
+
+// New samples appear on the measurement period while a periodic mode runs
+static void scd40_sim_update(struct Scd40Sim *sim) {
+  uint64_t period = sim->mode == SCD40_SIM_PERIODIC           ? sim->period_us :
+                    sim->mode == SCD40_SIM_LOW_POWER_PERIODIC ? SCD40_SIM_LOW_POWER_PERIOD_US :
+                                                                0;
+  if (period == 0) {
+    return;
+  }
+  uint64_t now    = time_us_64();
+  uint64_t sample = sim->measurement_start_us +
+                    (now - sim->measurement_start_us) / period * period;
+  if (sample > sim->measurement_start_us && sample > sim->last_sample_us) {
+    sim->last_sample_us = sample;
+    sim->data_ready     = true;
+  }
+}
+
+static void scd40_sim_execute(struct Scd40Sim *sim, const struct Scd40SimCommand *command,
+                              uint16_t data) {
+  switch (command->opcode) {
+    case 0x21B1:
+    case 0x21AC:
+      sim->mode = command->opcode == 0x21B1 ? SCD40_SIM_PERIODIC : SCD40_SIM_LOW_POWER_PERIODIC;
+      sim->measurement_start_us = time_us_64();
+      sim->last_sample_us       = sim->measurement_start_us;
+      sim->data_ready           = false;
+      break;
+    case 0x3F86:
+      sim->mode = SCD40_SIM_IDLE;
+      break;
+    case 0x241D:
+      sim->temperature_offset_raw = data;
+      break;
+    case 0x2427:
+      sim->altitude_m = data;
+      break;
+    case 0xE000:
+      sim->ambient_pressure_hpa = data;
+      break;
+    case 0x2416:
+      sim->self_calibration_enabled = data != 0;
+      break;
+    case 0x219D:
+    case 0x2196:
+      // Single shot samples become readable once the command has finished executing
+      sim->data_ready = true;
+      break;
+    default:
+      break;
+  }
+}
+
+static int scd40_sim_write(void *device, const uint8_t *src, size_t len) {
+  struct Scd40Sim *sim = device;
+  scd40_sim_update(sim);
+
+  if (len < 2) {
+    sim->nacks++;
+    return PICO_ERROR_GENERIC;
+  }
+
+  uint16_t                      opcode  = (uint16_t)(src[0] << 8) | src[1];
+  const struct Scd40SimCommand *command = scd40_sim_find(opcode);
+  bool                          busy    = sim->command_time_us > time_us_64();
+  bool illegal = command == NULL || busy || len != 2 + 3 * (size_t)command->write_words ||
+                 (sim->mode != SCD40_SIM_IDLE && !command->allowed_during_periodic) ||
+                 (command->scd41_only && !sim->single_shot_capable);
+  if (illegal) {
+    sim->nacks++;
+    return PICO_ERROR_GENERIC;
+  }
+
+  uint16_t data = 0;
+  if (command->write_words > 0) {
+    uint8_t words[2];
+    if (scd40_crc_unpack_words(&src[2], 1, words) != PICO_ERROR_NONE) {
+      sim->crc_errors++;
+      sim->nacks++;
+      return PICO_ERROR_GENERIC;
+    }
+    data = (uint16_t)(words[0] << 8) | words[1];
+  }
+
+  sim->commands++;
+  sim->command              = opcode;
+  sim->command_start_us     = time_us_64();
+  sim->command_time_us      = sim->command_start_us + command->execution_us;
+  sim->command_pending_read = command->read_words > 0;
+  scd40_sim_execute(sim, command, data);
+
+  return (int)len;
+}
+
+static int scd40_sim_read(void *device, uint8_t *dst, size_t len) {
+  struct Scd40Sim *sim = device;
+  scd40_sim_update(sim);
+
+  // read_measurement empties the sample buffer, and is NACKed when there's nothing in it
+  const struct Scd40SimCommand *command = scd40_sim_find(sim->command);
+  if (!sim->command_pending_read || time_us_64() < sim->command_time_us || command == NULL ||
+      len > 3 * (size_t)command->read_words || (sim->command == 0xEC05 && !sim->data_ready)) {
+    sim->nacks++;
+    return PICO_ERROR_GENERIC;
+  }
+
+  uint16_t words[3] = {0};
+  switch (sim->command) {
+    case 0xEC05:
+      words[0] = sim->co2_ppm;
+      words[1] = sim->temperature_raw;
+      words[2] = sim->humidity_raw;
+      sim->samples_read++;
+      sim->data_ready = false;
+      break;
+    case 0x2318:
+      words[0] = sim->temperature_offset_raw;
+      break;
+    case 0x2322:
+      words[0] = sim->altitude_m;
+      break;
+    case 0x2313:
+      words[0] = sim->self_calibration_enabled;
+      break;
+    case 0xE4B8:
+      words[0] = sim->data_ready ? 0x8006 : 0x8000;  // Bits 10:0 non-zero when data is ready
+      break;
+    case 0x3682:
+      memcpy(words, sim->serial_number, sizeof(words));
+      break;
+    case 0x3639:
+      words[0] = 0;  // Self test passed
+      break;
+    case 0x362F:
+      words[0] = 0x8000;  // Correction of zero
+      break;
+    default:
+      break;
+  }
+
+  uint8_t response[9];
+  for (uint i = 0; i < 3; i++) {
+    response[3 * i]     = words[i] >> 8;
+    response[3 * i + 1] = words[i] & 0xFF;
+    response[3 * i + 2] = scd40_crc(&response[3 * i], 2);
+  }
+  memcpy(dst, response, len);
+  sim->command_pending_read = false;
+
+  sim->last_latency_us = (uint32_t)(time_us_64() - sim->command_start_us);
+  sim->total_latency_us += sim->last_latency_us;
+  sim->responses++;
+  if (sim->last_latency_us > sim->max_latency_us) {
+    sim->max_latency_us = sim->last_latency_us;
+  }
+
+  return (int)len;
+}
+
+void scd40_sim_init(struct Scd40Sim *sim) {
+  memset(sim, 0, sizeof(*sim));
+  sim->period_us                = SCD40_SIM_PERIOD_US;
+  sim->self_calibration_enabled = true;
+  sim->serial_number[0]         = 0x1234;
+  sim->serial_number[1]         = 0x5678;
+  sim->serial_number[2]         = 0x9ABC;
+  sim->temperature_offset_raw   = 0x0912;  // 6.2 degrees, the datasheet example
+  scd40_sim_set_sample(sim, 600, 21.5f, 45.0f);
+}
+
+void scd40_sim_attach(struct Scd40Sim *sim, i2c_inst_t *i2c) {
+  struct HostI2cDevice device = {
+      .address = SCD40_SIM_ADDR,
+      .write   = scd40_sim_write,
+      .read    = scd40_sim_read,
+      .device  = sim,
+  };
+  host_i2c_attach(i2c, &device);
+}
+
+void scd40_sim_set_sample(struct Scd40Sim *sim, uint16_t co2_ppm, float temperature_c,
+                          float humidity_percent) {
+  sim->co2_ppm         = co2_ppm;
+  sim->temperature_raw = (uint16_t)((temperature_c + 45.0f) * 65535.0f / 175.0f + 0.5f);
+  sim->humidity_raw    = (uint16_t)(humidity_percent * 65535.0f / 100.0f + 0.5f);
+}
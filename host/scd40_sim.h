@@ -0,0 +1,70 @@
+#ifndef SCD40_SIM_H
+#define SCD40_SIM_H
+
+#include "hardware/i2c.h"
+
+// Simulated SCD4x on a host I2C bus. Implements the command set with the datasheet execution
+// times: a read before a command has finished executing is NACKed, as are commands that aren't
+// allowed in the current measurement mode. All responses carry correct CRCs.
+
+#define SCD40_SIM_ADDR 0x62
+
+#define SCD40_SIM_PERIOD_US 5000000  // Periodic measurement, per the datasheet
+
+enum Scd40SimMode {
+  SCD40_SIM_IDLE,
+  SCD40_SIM_PERIODIC,
+  SCD40_SIM_LOW_POWER_PERIODIC,
+};
+
+struct Scd40Sim {
+  enum Scd40SimMode mode;
+  bool              single_shot_capable;  // SCD41
+
+  // Raw sensor words returned by read_measurement
+  uint16_t co2_ppm;
+  uint16_t temperature_raw;
+  uint16_t humidity_raw;
+
+  uint16_t temperature_offset_raw;
+  uint16_t altitude_m;
+  uint16_t ambient_pressure_hpa;
+  bool     self_calibration_enabled;
+  uint16_t serial_number[3];
+
+  // In flight command
+  uint16_t command;
+  uint64_t command_start_us;
+  uint64_t command_time_us;  // When the command finishes executing
+  bool     command_pending_read;
+
+  // Periodic measurement period. The datasheet's unless a test slows or speeds up the sensor's
+  // clock.
+  uint32_t period_us;
+
+  uint64_t measurement_start_us;
+  uint64_t last_sample_us;
+  bool     data_ready;
+
+  // Counters
+  uint32_t commands;
+  uint32_t nacks;
+  uint32_t crc_errors;
+  uint32_t samples_read;
+
+  // Time from each command to the read of its response. Anything above the command's execution
+  // time was spent by the host not asking yet.
+  uint32_t last_latency_us;
+  uint32_t max_latency_us;
+  uint64_t total_latency_us;
+  uint32_t responses;
+};
+
+void scd40_sim_init(struct Scd40Sim *sim);
+void scd40_sim_attach(struct Scd40Sim *sim, i2c_inst_t *i2c);
+
+// Converts engineering units to the sensor's raw words
+void scd40_sim_set_sample(struct Scd40Sim *sim, uint16_t co2_ppm, float temperature_c,
+                          float humidity_percent);
+
+#endif  // SCD40_SIM_H
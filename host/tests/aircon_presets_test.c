@@ -0,0 +1,68 @@
+// The compile-time presets in aircon_presets.cpp against the runtime encoders in cmd_gen.c and
+// ir_timeline.cpp. Each preset must carry the frame and timeline the encoders would have built
+// for its state, and aircon_preset_find() must return it for that state and nothing else.
+
+#include "aircon_presets.h"
+#include "cmd_gen.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "string.h"
+#include "test.h"
+
+static void aircon_presets_test_encoders() {
+  CHECK(!ir_timeline_trimmed());
+
+  for (uint i = 0; i < AC_PRESET_COUNT; i++) {
+    const struct AirconPreset *preset = &aircon_presets[i];
+    const struct AirconState  *state  = &preset->state;
+
+    struct AirconFrame frame;
+    struct IrTimeline  timeline;
+    aircon_frame_encode(&frame, (enum AirconUpdateType)state->update_type,
+                        (enum AirconMode)state->mode, (enum AirconFanSpeed)state->fan_speed,
+                        state->temperature, 0, 0);
+    ir_timeline_encode(&frame, &timeline);
+
+    if (memcmp(&frame, &preset->frame, sizeof(frame)) != 0) {
+      fprintf(stderr, "preset %u: frame differs from aircon_frame_encode()\n", i);
+      test_failures++;
+    }
+    CHECK_EQ(timeline.count, IR_TIMELINE_SYMBOL_COUNT);
+    if (memcmp(timeline.symbols, preset->symbols, sizeof(preset->symbols)) != 0) {
+      fprintf(stderr, "preset %u: timeline differs from ir_timeline_encode()\n", i);
+      test_failures++;
+    }
+
+    struct AirconState decoded;
+    CHECK_EQ(aircon_frame_decode(&preset->frame, &decoded), 0);
+    CHECK_EQ(decoded.mode, state->mode);
+    CHECK_EQ(decoded.fan_speed, state->fan_speed);
+    CHECK_EQ(decoded.temperature, state->temperature);
+  }
+}
+
+static void aircon_presets_test_find() {
+  for (uint i = 0; i < AC_PRESET_COUNT; i++) {
+    const struct AirconState *state = &aircon_presets[i].state;
+    enum AirconMode           mode  = (enum AirconMode)state->mode;
+    enum AirconFanSpeed       fan   = (enum AirconFanSpeed)state->fan_speed;
+
+    CHECK(aircon_preset_find(AC_UPDATE_AIRCON_MODE, mode, fan, state->temperature, 0, 0) ==
+          &aircon_presets[i]);
+
+    // Anything with timers or another update type is encoded at run time
+    CHECK(aircon_preset_find(AC_UPDATE_AIRCON_MODE, mode, fan, state->temperature, 60, 0) == NULL);
+    CHECK(aircon_preset_find(AC_UPDATE_AIRCON_MODE, mode, fan, state->temperature, 0, 60) == NULL);
+    CHECK(aircon_preset_find(AC_UPDATE_TEMP_UP, mode, fan, state->temperature, 0, 0) == NULL);
+  }
+
+  // A state no preset carries
+  CHECK(aircon_preset_find(AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 63, 0, 0) == NULL);
+}
+
+int main() {
+  aircon_presets_test_encoders();
+  aircon_presets_test_find();
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,249 @@
+// Request batching in aircon_service.c: a burst goes out as one batch for as long as its requests
+// keep coming within the window of each other, and a burst that never pauses is still sent once
+// it has been held for the longest allowed.
+//
+// Planning: each batch sends the frames whose update types match what changed, as decoded from
+// the zone's IR line. Changes made while the aircon is off wait for the frame that turns it on,
+// and timers always get frames of their own. Each case has a zone to itself.
+
+#include "aircon_service.h"
+#include "cmd_gen.h"
+#include "ir_decoder.h"
+#include "ir_line.h"
+#include "pico/stdlib.h"
+#include "string.h"
+#include "test.h"
+
+enum AirconServiceTestZone {
+  AIRCON_SERVICE_TEST_BATCHING,
+  AIRCON_SERVICE_TEST_UPDATE_TYPE,
+  AIRCON_SERVICE_TEST_OFF,
+  AIRCON_SERVICE_TEST_TIMERS,
+  AIRCON_SERVICE_TEST_ZONES,
+};
+
+static const uint aircon_service_test_pins[AIRCON_SERVICE_TEST_ZONES] = {16, 17, 18, 19};
+
+static const struct AirconSettings aircon_service_test_initial[AIRCON_SERVICE_TEST_ZONES] = {
+    {AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0},
+    {AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0},
+    {AC_MODE_OFF, AC_FAN_AUTO, 25, 0, 0},
+    {AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0},
+};
+
+struct AirconServiceTestBurst {
+  uint32_t interval_us;
+  uint32_t count;  // Requests to make, 0 for no limit
+  uint32_t made;
+};
+
+static int64_t aircon_service_test_press(alarm_id_t id, void *user_data) {
+  struct AirconServiceTestBurst *burst = user_data;
+  aircon_service_step_temperature(AIRCON_SERVICE_TEST_BATCHING, burst->made % 2 ? -1 : 1);
+  burst->made++;
+  return burst->count == 0 || burst->made < burst->count ? -(int64_t)burst->interval_us : 0;
+}
+
+static void aircon_service_test_batching() {
+  // Presses 150ms apart, each inside the window after the one before, but the last well past the
+  // window after the first. They all go in one batch.
+  struct AirconServiceTestBurst burst = {150000, 4, 0};
+  add_alarm_in_us(1000, aircon_service_test_press, &burst, true);
+  CHECK_EQ(aircon_service_step(AIRCON_SERVICE_TEST_BATCHING), 1);
+
+  struct AirconServiceStats stats;
+  aircon_service_stats(AIRCON_SERVICE_TEST_BATCHING, &stats);
+  CHECK_EQ(burst.made, 4);
+  CHECK_EQ(stats.requests, 4);
+  CHECK_EQ(stats.batches, 1);
+  CHECK_EQ(stats.saved, 3);
+
+  // Presses that never pause are sent after the longest hold, 1s, which takes 10 of them at
+  // 100ms apart plus the one that started the hold
+  struct AirconServiceTestBurst endless = {100000, 0, 0};
+  uint64_t                      start   = time_us_64();
+
+  alarm_id_t alarm = add_alarm_in_us(1000, aircon_service_test_press, &endless, true);
+  aircon_service_step(AIRCON_SERVICE_TEST_BATCHING);
+  cancel_alarm(alarm);
+
+  aircon_service_stats(AIRCON_SERVICE_TEST_BATCHING, &stats);
+  CHECK_EQ(stats.batches, 2);
+  CHECK(stats.requests - 4 >= 10 && stats.requests - 4 <= 11);
+  // The hold, and sending the frame
+  CHECK(time_us_64() - start < 3000000);
+}
+
+#define AIRCON_SERVICE_TEST_MAX_FRAMES 16  // Sent on one zone over the whole test
+#define AIRCON_SERVICE_TEST_MAX_RUNS   (AIRCON_SERVICE_TEST_MAX_FRAMES * 2 * 500)
+
+struct AirconServiceTestFrames {
+  struct AirconState frames[AIRCON_SERVICE_TEST_MAX_FRAMES];
+  uint32_t           count;
+};
+
+static void aircon_service_test_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                        void *user_data) {
+  struct AirconServiceTestFrames *decoded = user_data;
+  if (decoded->count < AIRCON_SERVICE_TEST_MAX_FRAMES) {
+    CHECK_EQ(aircon_frame_decode((const struct AirconFrame *)frame,
+                                 &decoded->frames[decoded->count++]),
+             0);
+  }
+}
+
+// Runs one batch of the zone's queued requests and checks it sent `count` frames, returning what
+// they carried
+static void aircon_service_test_batch(uint zone, uint32_t count, struct AirconState *sent) {
+  static uint32_t seen[AIRCON_SERVICE_TEST_ZONES];
+  CHECK_EQ(aircon_service_step(zone), (int32_t)count);
+
+  // The line holds everything the zone has ever sent, so decode it all and skip what earlier
+  // batches did
+  static struct IrLineRun        runs[AIRCON_SERVICE_TEST_MAX_RUNS];
+  struct AirconServiceTestFrames decoded = {0};
+  struct IrDecoder               decoder;
+  ir_decoder_init(&decoder, aircon_service_test_decoded, &decoded);
+  size_t run_count = ir_line_runs(aircon_service_test_pins[zone], runs, count_of(runs));
+  for (size_t i = 0; i < run_count; i++) {
+    ir_decoder_feed(&decoder, runs[i].level, runs[i].duration_us);
+  }
+
+  CHECK_EQ(decoded.count, seen[zone] + count);
+  for (uint32_t i = 0; i < count && seen[zone] + i < decoded.count; i++) {
+    sent[i] = decoded.frames[seen[zone] + i];
+  }
+  seen[zone] = decoded.count;
+}
+
+static void aircon_service_test_update_type() {
+  const uint         zone = AIRCON_SERVICE_TEST_UPDATE_TYPE;
+  struct AirconState sent[3];
+
+  // Nothing confirms the initial settings, so the first batch sends them in full even though the
+  // request changes nothing
+  aircon_service_set_temperature(zone, 25);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].mode, AC_MODE_COOLING);
+
+  // Then only what changed
+  aircon_service_set_temperature(zone, 27);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_TEMP_UP);
+  CHECK_EQ(sent[0].temperature, 27);
+
+  aircon_service_step_temperature(zone, -3);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_TEMP_DOWN);
+  CHECK_EQ(sent[0].temperature, 24);
+
+  aircon_service_set_fan_speed(zone, AC_FAN_2);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_FAN_SPEED);
+  CHECK_EQ(sent[0].fan_speed, AC_FAN_2);
+
+  // No single update type covers both, so the full settings go instead
+  aircon_service_set_fan_speed(zone, AC_FAN_3);
+  aircon_service_set_temperature(zone, 22);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].fan_speed, AC_FAN_3);
+  CHECK_EQ(sent[0].temperature, 22);
+
+  aircon_service_set_mode(zone, AC_MODE_HEATING);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].mode, AC_MODE_HEATING);
+
+  // Requests that cancel out send nothing
+  aircon_service_step_temperature(zone, 1);
+  aircon_service_step_temperature(zone, -1);
+  aircon_service_test_batch(zone, 0, sent);
+}
+
+static void aircon_service_test_off() {
+  const uint         zone = AIRCON_SERVICE_TEST_OFF;
+  struct AirconState sent[3];
+
+  aircon_service_set_mode(zone, AC_MODE_OFF);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].mode, AC_MODE_OFF);
+
+  // An aircon that's off ignores these, so they're held back
+  aircon_service_set_temperature(zone, 28);
+  aircon_service_test_batch(zone, 0, sent);
+  aircon_service_set_fan_speed(zone, AC_FAN_1);
+  aircon_service_test_batch(zone, 0, sent);
+
+  // Until the frame that turns it on, which carries them
+  aircon_service_set_mode(zone, AC_MODE_COOLING);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].mode, AC_MODE_COOLING);
+  CHECK_EQ(sent[0].fan_speed, AC_FAN_1);
+  CHECK_EQ(sent[0].temperature, 28);
+
+  // A change made along with turning it off rides in the frame that does
+  aircon_service_step_temperature(zone, -2);
+  aircon_service_set_mode(zone, AC_MODE_OFF);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[0].mode, AC_MODE_OFF);
+  CHECK_EQ(sent[0].temperature, 26);
+}
+
+static void aircon_service_test_timers() {
+  const uint         zone = AIRCON_SERVICE_TEST_TIMERS;
+  struct AirconState sent[3];
+
+  // A timer goes in its own frame, after the climate settings
+  aircon_service_set_timer_on(zone, 60);
+  aircon_service_test_batch(zone, 2, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_AIRCON_MODE);
+  CHECK_EQ(sent[1].update_type, AC_UPDATE_TIMER_ON);
+  CHECK_EQ(sent[1].timer_on_duration, 60);
+  CHECK_EQ(sent[1].timer_off_duration, 0);
+
+  aircon_service_set_timer_off(zone, 120);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_TIMER_OFF);
+  CHECK_EQ(sent[0].timer_on_duration, 60);
+  CHECK_EQ(sent[0].timer_off_duration, 120);
+
+  // Every kind of change at once is the most a batch sends
+  aircon_service_set_temperature(zone, 26);
+  aircon_service_set_timer_on(zone, 0);
+  aircon_service_set_timer_off(zone, 4095);
+  aircon_service_test_batch(zone, 3, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_TEMP_UP);
+  CHECK_EQ(sent[1].update_type, AC_UPDATE_TIMER_ON);
+  CHECK_EQ(sent[2].update_type, AC_UPDATE_TIMER_OFF);
+  CHECK_EQ(sent[2].temperature, 26);
+  CHECK_EQ(sent[2].timer_on_duration, 0);
+  CHECK_EQ(sent[2].timer_off_duration, 4095);
+
+  // Timers aren't held back while the aircon is off, a timer to turn it on needs them most
+  aircon_service_set_mode(zone, AC_MODE_OFF);
+  aircon_service_test_batch(zone, 1, sent);
+  aircon_service_set_timer_on(zone, 30);
+  aircon_service_set_temperature(zone, 20);
+  aircon_service_test_batch(zone, 1, sent);
+  CHECK_EQ(sent[0].update_type, AC_UPDATE_TIMER_ON);
+  CHECK_EQ(sent[0].mode, AC_MODE_OFF);
+  CHECK_EQ(sent[0].temperature, 26);
+  CHECK_EQ(sent[0].timer_on_duration, 30);
+}
+
+int main() {
+  ir_line_reset();
+  aircon_service_init(aircon_service_test_pins, aircon_service_test_initial,
+                      AIRCON_SERVICE_TEST_ZONES);
+
+  aircon_service_test_batching();
+  aircon_service_test_update_type();
+  aircon_service_test_off();
+  aircon_service_test_timers();
+  return TEST_RESULT();
+}
@@ -0,0 +1,178 @@
+// Round trip properties of the aircon frame codec in cmd_gen.h, over every update type, mode and
+// fan speed, every temperature the frame can carry and every value of each timer:
+// - aircon_frame_encode() writes the frame the old byte loop did, and ir_timeline_encode() the
+//   symbols its send loop timed, both kept in host/bench/aircon_legacy.c
+// - every encoded frame validates, and decodes back to what was encoded
+// - no single bit error in a frame goes unnoticed
+// - each semantic violation is reported as its own bit
+
+#include "aircon_legacy.h"
+#include "cmd_gen.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "string.h"
+#include "test.h"
+
+#define CMD_GEN_TEST_DATA(i) (3 + 2 * (i))  // Frame offset of a data byte
+
+static const enum AirconUpdateType cmd_gen_test_updates[] = {
+    AC_UPDATE_AIRCON_MODE, AC_UPDATE_TIMER_ON, AC_UPDATE_TIMER_OFF, AC_UPDATE_FAN_SPEED,
+    AC_UPDATE_TEMP_DOWN,   AC_UPDATE_TEMP_UP,  AC_UPDATE_FIN_DIR,
+};
+static const enum AirconMode cmd_gen_test_modes[] = {
+    AC_MODE_OFF, AC_MODE_VENTILATION, AC_MODE_COOLING, AC_MODE_DEHUMIDIFY, AC_MODE_HEATING,
+};
+static const enum AirconFanSpeed cmd_gen_test_fans[] = {
+    AC_FAN_0, AC_FAN_1, AC_FAN_2, AC_FAN_3, AC_FAN_AUTO, AC_FAN_5,
+};
+// Both ends of each timer field and of the nibbles they're split into
+static const uint16_t cmd_gen_test_timers[] = {0, 1, 15, 16, 255, 256, 4095};
+
+#define CMD_GEN_TEST_MAX_TIMER 4095  // 12 bits each
+#define CMD_GEN_TEST_RANDOM    200000
+
+static uint32_t cmd_gen_test_round_trips;
+
+static void cmd_gen_test_round_trip(enum AirconUpdateType update, enum AirconMode mode,
+                                    enum AirconFanSpeed fan, uint8_t temperature,
+                                    uint16_t timer_on, uint16_t timer_off) {
+  struct AirconFrame       frame;
+  static struct IrTimeline timeline;
+  aircon_frame_encode(&frame, update, mode, fan, temperature, timer_on, timer_off);
+  ir_timeline_encode(&frame, &timeline);
+
+  uint8_t         legacy[COMMAND_BYTE_COUNT];
+  static uint32_t legacy_symbols[IR_TIMELINE_SYMBOL_COUNT];
+  aircon_legacy_frame(legacy, update, mode, fan, temperature, timer_on, timer_off);
+  uint32_t legacy_count = aircon_legacy_symbols(legacy, legacy_symbols);
+
+  struct AirconState state;
+  uint32_t           validated = aircon_frame_validate(&frame);
+  uint32_t           decoded   = aircon_frame_decode(&frame, &state);
+  if (memcmp(frame.bytes, legacy, COMMAND_BYTE_COUNT) != 0 || timeline.count != legacy_count ||
+      memcmp(timeline.symbols, legacy_symbols, legacy_count * sizeof(uint32_t)) != 0 ||
+      validated != 0 || decoded != 0 ||
+      state.update_type != update || state.mode != mode || state.fan_speed != fan ||
+      state.temperature != temperature || state.timer_on_duration != timer_on ||
+      state.timer_off_duration != timer_off) {
+    fprintf(stderr,
+            "update 0x%02X mode %u fan %u temperature %u timers %u/%u: violations 0x%02X/0x%02X, "
+            "decoded 0x%02X %u %u %u %u/%u\n",
+            update, mode, fan, temperature, timer_on, timer_off, validated, decoded,
+            state.update_type, state.mode, state.fan_speed, state.temperature,
+            state.timer_on_duration, state.timer_off_duration);
+    test_failures++;
+  }
+  cmd_gen_test_round_trips++;
+}
+
+static void cmd_gen_test_round_trips_all() {
+  for (size_t u = 0; u < count_of(cmd_gen_test_updates); u++) {
+    for (size_t m = 0; m < count_of(cmd_gen_test_modes); m++) {
+      for (size_t f = 0; f < count_of(cmd_gen_test_fans); f++) {
+        // Six bits of temperature
+        for (uint8_t temperature = 0; temperature < 64; temperature++) {
+          cmd_gen_test_round_trip(cmd_gen_test_updates[u], cmd_gen_test_modes[m],
+                                  cmd_gen_test_fans[f], temperature, 0, 0);
+        }
+        for (size_t on = 0; on < count_of(cmd_gen_test_timers); on++) {
+          for (size_t off = 0; off < count_of(cmd_gen_test_timers); off++) {
+            cmd_gen_test_round_trip(cmd_gen_test_updates[u], cmd_gen_test_modes[m],
+                                    cmd_gen_test_fans[f], 25, cmd_gen_test_timers[on],
+                                    cmd_gen_test_timers[off]);
+          }
+        }
+      }
+    }
+  }
+
+  // Every value of each timer, against the edges of the other, in every mode
+  for (size_t m = 0; m < count_of(cmd_gen_test_modes); m++) {
+    for (uint16_t timer = 0; timer <= CMD_GEN_TEST_MAX_TIMER; timer++) {
+      for (size_t other = 0; other < count_of(cmd_gen_test_timers); other++) {
+        cmd_gen_test_round_trip(AC_UPDATE_TIMER_ON, cmd_gen_test_modes[m], AC_FAN_AUTO, 25, timer,
+                                cmd_gen_test_timers[other]);
+        cmd_gen_test_round_trip(AC_UPDATE_TIMER_OFF, cmd_gen_test_modes[m], AC_FAN_AUTO, 25,
+                                cmd_gen_test_timers[other], timer);
+      }
+    }
+  }
+
+  // Anywhere in the whole space
+  uint32_t random = 1;
+  for (uint32_t n = 0; n < CMD_GEN_TEST_RANDOM; n++) {
+    random = random * 1103515245 + 12345;
+    uint32_t high = random >> 8;
+    random = random * 1103515245 + 12345;
+    uint32_t low = random >> 8;
+    cmd_gen_test_round_trip(cmd_gen_test_updates[high % count_of(cmd_gen_test_updates)],
+                            cmd_gen_test_modes[(high >> 4) % count_of(cmd_gen_test_modes)],
+                            cmd_gen_test_fans[(high >> 8) % count_of(cmd_gen_test_fans)],
+                            (high >> 12) % 64, low % (CMD_GEN_TEST_MAX_TIMER + 1),
+                            (low >> 12) % (CMD_GEN_TEST_MAX_TIMER + 1));
+  }
+  CHECK(cmd_gen_test_round_trips > 500000);
+}
+
+// Every byte is either the preamble, or one of a data/parity pair, so any flipped bit breaks the
+// preamble or a pair
+static void cmd_gen_test_bit_errors() {
+  struct AirconFrame frame;
+  aircon_frame_encode(&frame, AC_UPDATE_TIMER_ON, AC_MODE_COOLING, AC_FAN_AUTO, 25, 90, 0);
+  for (uint bit = 0; bit < 8 * COMMAND_BYTE_COUNT; bit++) {
+    struct AirconFrame flipped = frame;
+    flipped.bytes[bit / 8] ^= 1 << (bit % 8);
+    uint32_t expected = bit / 8 < 3 ? AC_FRAME_PREAMBLE : AC_FRAME_PARITY;
+    if (!(aircon_frame_validate(&flipped) & expected)) {
+      fprintf(stderr, "bit %u flipped unnoticed\n", bit);
+      test_failures++;
+    }
+  }
+}
+
+// Rewrites a data byte and keeps its parity byte consistent
+static void cmd_gen_test_set_data(struct AirconFrame *frame, uint index, uint8_t value) {
+  frame->bytes[CMD_GEN_TEST_DATA(index)]     = value;
+  frame->bytes[CMD_GEN_TEST_DATA(index) + 1] = ~value;
+}
+
+static void cmd_gen_test_violations() {
+  struct AirconFrame frame;
+  struct AirconState state;
+
+  aircon_frame_encode(&frame, (enum AirconUpdateType)0x14, AC_MODE_COOLING, AC_FAN_2, 25, 0, 0);
+  CHECK_EQ(aircon_frame_validate(&frame), 0);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_UPDATE_TYPE);
+
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, (enum AirconMode)0x2, AC_FAN_2, 25, 0, 0);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_MODE);
+
+  // Flags byte that belongs to another mode
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_2, 25, 0, 0);
+  cmd_gen_test_set_data(&frame, 12, 0xF0);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_MODE);
+
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, (enum AirconFanSpeed)0x0,
+                      25, 0, 0);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_FAN_SPEED);
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, (enum AirconFanSpeed)0x7,
+                      25, 0, 0);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_FAN_SPEED);
+
+  // Timer flags that don't match the durations
+  aircon_frame_encode(&frame, AC_UPDATE_TIMER_ON, AC_MODE_COOLING, AC_FAN_2, 25, 90, 0);
+  cmd_gen_test_set_data(&frame, 10, frame.bytes[CMD_GEN_TEST_DATA(10)] & ~0x20);
+  CHECK_EQ(aircon_frame_decode(&frame, &state), AC_FRAME_TIMER);
+
+  // Reserved bits are constant
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_2, 25, 0, 0);
+  cmd_gen_test_set_data(&frame, 5, frame.bytes[CMD_GEN_TEST_DATA(5)] | 0x01);
+  CHECK_EQ(aircon_frame_validate(&frame), AC_FRAME_CONSTANT);
+}
+
+int main() {
+  cmd_gen_test_round_trips_all();
+  cmd_gen_test_bit_errors();
+  cmd_gen_test_violations();
+  return TEST_RESULT();
+}
@@ -0,0 +1,91 @@
+// ir_calibration_run() over the virtual IR line, with the channel standing in for a receiver whose
+// AGC stretches every mark by a known amount. The trim takes the stretch back out of the marks and
+// gives it to the spaces, leaves every kind within its resolution of the target, and is what
+// ir_calibration_load() applies from flash afterwards.
+
+#include "hardware/pio.h"
+#include "ir_calibration.h"
+#include "ir_channel.h"
+#include "ir_line.h"
+#include "ir_loopback.h"
+#include "ir_send.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "stdlib.h"
+#include "test.h"
+
+#define IR_CALIBRATION_TEST_PIN     16
+#define IR_CALIBRATION_TEST_POLL_US 1000
+#define IR_CALIBRATION_TEST_SKEW_US 60
+// Marks are whole carrier periods, so they can only be trimmed to within half of one
+#define IR_CALIBRATION_TEST_MARK_US (1000000 / IR_CARRIER_HZ / 2 + 1)
+
+static bool ir_calibration_test_mark(enum IrTimingKind kind) {
+  return kind == IR_TIMING_PREAMBLE_MARK || kind == IR_TIMING_SYNC_MARK ||
+         kind == IR_TIMING_BIT_MARK;
+}
+
+// A histogram bin either way, as ir_calibration.c sizes them
+static int32_t ir_calibration_test_bin_us(enum IrTimingKind kind) {
+  uint32_t bin_us = ir_timeline_target_us(kind) / 1024;
+  return bin_us > IR_CALIBRATION_MIN_BIN_US ? bin_us : IR_CALIBRATION_MIN_BIN_US;
+}
+
+static void ir_calibration_test_run(struct IrCalibrationReport *report) {
+  CHECK_EQ(ir_calibration_run(0, IR_CALIBRATION_FRAMES, report), PICO_ERROR_NONE);
+  CHECK_EQ(report->frames, IR_CALIBRATION_FRAMES);
+
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    const struct IrCalibrationTiming *timing = &report->timings[kind];
+    bool    mark      = ir_calibration_test_mark(kind);
+    int32_t skew      = mark ? IR_CALIBRATION_TEST_SKEW_US : -IR_CALIBRATION_TEST_SKEW_US;
+    int32_t tolerance = ir_calibration_test_bin_us(kind) + (mark ? IR_CALIBRATION_TEST_MARK_US : 0);
+    // Sent untrimmed, the lengths were off by the skew, plus however far the protocol's duration
+    // is from the target
+    int32_t offset = (int32_t)ir_timeline_target_us(kind) - (int32_t)ir_timeline_protocol_us(kind);
+
+    CHECK(timing->samples > 0);
+    CHECK_EQ(timing->trim_before_us, 0);
+    CHECK(abs(timing->error_before_us - (skew - offset)) <= tolerance);
+    CHECK(abs(timing->trim_after_us - (offset - skew)) <= tolerance);
+    CHECK(abs(timing->error_after_us) <= tolerance);
+    CHECK(abs(timing->error_after_us) <= abs(timing->error_before_us));
+  }
+}
+
+static void ir_calibration_test_load(const struct IrCalibrationReport *report) {
+  struct IrTimelineTrim trim = {0};
+  ir_timeline_set_trim(&trim);
+  CHECK(!ir_timeline_trimmed());
+
+  CHECK(ir_calibration_load());
+  CHECK(ir_timeline_trimmed());
+  ir_timeline_get_trim(&trim);
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    CHECK_EQ(trim.us[kind], report->timings[kind].trim_after_us);
+  }
+}
+
+int main() {
+  static const uint pins[] = {IR_CALIBRATION_TEST_PIN};
+  ir_line_reset();
+  host_pio_reset();
+  ir_send_init(pins, count_of(pins));
+  ir_loopback_enable(0);
+
+  // Nothing stored in the blank flash yet
+  CHECK(!ir_calibration_load());
+  CHECK(!ir_timeline_trimmed());
+
+  static struct IrChannel     channel;
+  const struct IrChannelModel model = {.mark_stretch_us = IR_CALIBRATION_TEST_SKEW_US};
+  ir_channel_init(&channel, IR_CALIBRATION_TEST_PIN, &model, 1);
+  ir_channel_start(&channel, IR_CALIBRATION_TEST_POLL_US);
+
+  static struct IrCalibrationReport report;
+  ir_calibration_test_run(&report);
+  ir_calibration_test_load(&report);
+
+  ir_channel_stop(&channel);
+  return TEST_RESULT();
+}
@@ -0,0 +1,120 @@
+// Capture halfwords and the ring reader from ir_edge.h: the frame gap code against every run
+// ir_recv.pio can push, and the reader catching the DMA lapping it.
+
+#include "ir_edge.h"
+#include "pico/stdlib.h"
+#include "test.h"
+
+#define IR_EDGE_TEST_LIMIT 27500  // IR_RECV_FRAME_GAP_TICKS
+#define IR_EDGE_TEST_RING  16
+
+// What ir_recv.pio pushes for a run, from X when it leaves the loop. X wraps to all ones when
+// the run exhausts the limit.
+static ir_edge_t ir_edge_test_push(uint32_t x, bool level) {
+  return (ir_edge_t)((x & IR_EDGE_REMAINING_MASK) << 1 | level);
+}
+
+static void ir_edge_test_codes() {
+  // Runs that ended in time, down to a high one with no ticks left
+  for (uint32_t x = 0; x <= IR_EDGE_TEST_LIMIT; x++) {
+    for (int level = 0; level < 2; level++) {
+      ir_edge_t edge = ir_edge_test_push(x, level);
+      if (ir_edge_is_frame_gap(edge) || ir_edge_level(edge) != level ||
+          ir_edge_ticks(edge, IR_EDGE_TEST_LIMIT) != IR_EDGE_TEST_LIMIT - x) {
+        fprintf(stderr, "run with %u ticks left at level %d pushed as 0x%04X\n", x, level, edge);
+        test_failures++;
+      }
+    }
+  }
+
+  // Runs that used up the limit. Only the high one is the gap.
+  ir_edge_t gap = ir_edge_test_push(0xFFFFFFFF, true);
+  CHECK_EQ(gap, IR_EDGE_FRAME_GAP);
+  CHECK(ir_edge_is_frame_gap(gap));
+  CHECK_EQ(ir_edge_ticks(gap, IR_EDGE_TEST_LIMIT), IR_EDGE_TEST_LIMIT);
+
+  ir_edge_t long_mark = ir_edge_test_push(0xFFFFFFFF, false);
+  CHECK(!ir_edge_is_frame_gap(long_mark));
+  CHECK(!ir_edge_level(long_mark));
+  CHECK_EQ(ir_edge_ticks(long_mark, IR_EDGE_TEST_LIMIT), IR_EDGE_TEST_LIMIT);
+}
+
+struct IrEdgeTestWriter {
+  ir_edge_t ring[IR_EDGE_TEST_RING];
+  uint32_t  written;
+};
+
+static void ir_edge_test_write(struct IrEdgeTestWriter *writer, uint32_t ticks, bool level) {
+  writer->ring[writer->written++ % IR_EDGE_TEST_RING] =
+      ir_edge_test_push(IR_EDGE_TEST_LIMIT - ticks, level);
+}
+
+static void ir_edge_test_write_gap(struct IrEdgeTestWriter *writer) {
+  writer->ring[writer->written++ % IR_EDGE_TEST_RING] = IR_EDGE_FRAME_GAP;
+}
+
+static void ir_edge_test_reader() {
+  static struct IrEdgeTestWriter writer;
+  struct IrEdgeReader            reader;
+  ir_edge_t                      edge;
+  uint32_t                       ticks;
+  ir_edge_reader_init(&reader, writer.ring, IR_EDGE_TEST_RING, IR_EDGE_TEST_LIMIT);
+
+  // Reads runs as they're written, across the end of the ring
+  for (uint32_t i = 0; i < 3 * IR_EDGE_TEST_RING; i++) {
+    ir_edge_test_write(&writer, 100 + i, i & 1);
+    CHECK(ir_edge_next(&reader, writer.written, &edge, &ticks));
+    CHECK_EQ(ticks, 100 + i);
+    CHECK_EQ(ir_edge_level(edge), i & 1);
+    CHECK(!ir_edge_next(&reader, writer.written, &edge, &ticks));
+  }
+
+  // A full ring is still intact
+  for (uint32_t i = 0; i < IR_EDGE_TEST_RING; i++) {
+    ir_edge_test_write(&writer, 200 + i, i & 1);
+  }
+  for (uint32_t i = 0; i < IR_EDGE_TEST_RING; i++) {
+    CHECK(ir_edge_next(&reader, writer.written, &edge, &ticks));
+    CHECK_EQ(ticks, 200 + i);
+  }
+  CHECK_EQ(reader.overruns, 0);
+
+  // One more is a lap. The rest of that frame is dropped up to its gap, which comes through.
+  for (uint32_t i = 0; i < IR_EDGE_TEST_RING + 1; i++) {
+    ir_edge_test_write(&writer, 300 + i, i & 1);
+  }
+  CHECK(!ir_edge_next(&reader, writer.written, &edge, &ticks));
+  CHECK_EQ(reader.overruns, 1);
+  ir_edge_test_write(&writer, 400, false);
+  ir_edge_test_write(&writer, 401, true);
+  CHECK(!ir_edge_next(&reader, writer.written, &edge, &ticks));
+  ir_edge_test_write_gap(&writer);
+  CHECK(ir_edge_next(&reader, writer.written, &edge, &ticks));
+  CHECK(ir_edge_is_frame_gap(edge));
+  CHECK_EQ(ticks, IR_EDGE_TEST_LIMIT);
+
+  // The next frame reads normally
+  ir_edge_test_write(&writer, 500, false);
+  CHECK(ir_edge_next(&reader, writer.written, &edge, &ticks));
+  CHECK_EQ(ticks, 500);
+  CHECK_EQ(reader.overruns, 1);
+
+  // The counts wrap together
+  ir_edge_reader_init(&reader, writer.ring, IR_EDGE_TEST_RING, IR_EDGE_TEST_LIMIT);
+  reader.read    = 0xFFFFFFFE;
+  writer.written = 0xFFFFFFFE;
+  for (uint32_t i = 0; i < 4; i++) {
+    ir_edge_test_write(&writer, 600 + i, false);
+  }
+  for (uint32_t i = 0; i < 4; i++) {
+    CHECK(ir_edge_next(&reader, writer.written, &edge, &ticks));
+    CHECK_EQ(ticks, 600 + i);
+  }
+  CHECK_EQ(reader.overruns, 0);
+}
+
+int main() {
+  ir_edge_test_codes();
+  ir_edge_test_reader();
+  return TEST_RESULT();
+}
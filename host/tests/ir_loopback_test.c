@@ -0,0 +1,155 @@
+// send_aircon_command_blocking() with the loopback check, over the virtual IR line and the
+// channel standing in for the receiver. A clean copy is accepted first time, a corrupted one is
+// sent again, and one that never arrives is given up on after the last attempt. Waiting for the
+// verdict leaves the sender's other notifications alone.
+
+#include "cmd_gen.h"
+#include "hardware/pio.h"
+#include "ir_channel.h"
+#include "ir_line.h"
+#include "ir_loopback.h"
+#include "ir_send.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "task.h"
+#include "test.h"
+
+#define IR_LOOPBACK_TEST_PIN     16
+#define IR_LOOPBACK_TEST_POLL_US 1000
+// Bit 3 of a data byte in the middle of the frame and of the parity byte after it, past the
+// preamble and sync symbols. Flipping both keeps the parity good, so the copy decodes with
+// different bits rather than being rejected.
+#define IR_LOOPBACK_TEST_DATA_SYMBOL   (2 + 8 * 11 + 3)
+#define IR_LOOPBACK_TEST_PARITY_SYMBOL (IR_LOOPBACK_TEST_DATA_SYMBOL + 8)
+
+// Between the channel and the checker, to spoil copies on purpose
+struct IrLoopbackTestReceiver {
+  uint32_t corrupt;  // Frames still to have a bit flipped, along with its parity
+  bool     drop;     // Nothing reaches the checker
+  uint32_t runs;     // Of the current frame, from its first mark
+};
+
+static struct IrLoopbackTestReceiver ir_loopback_test_receiver;
+
+static void ir_loopback_test_receive(bool level, uint32_t duration_us, void *user_data) {
+  struct IrLoopbackTestReceiver *receiver = user_data;
+  bool                           gap      = level && duration_us >= IR_CHANNEL_FRAME_GAP_US;
+  if (receiver->drop) {
+    return;
+  }
+
+  // Swap a zero's space for a one's or the other way round
+  if (receiver->runs > 0 || !level) {
+    if (receiver->corrupt > 0 && (receiver->runs == 2 * IR_LOOPBACK_TEST_DATA_SYMBOL + 1 ||
+                                  receiver->runs == 2 * IR_LOOPBACK_TEST_PARITY_SYMBOL + 1)) {
+      uint32_t zero_us = ir_timeline_protocol_us(IR_TIMING_ZERO_SPACE);
+      uint32_t one_us  = ir_timeline_protocol_us(IR_TIMING_ONE_SPACE);
+      duration_us      = duration_us < (zero_us + one_us) / 2 ? one_us : zero_us;
+    }
+    receiver->runs++;
+  }
+
+  ir_loopback_feed(level, duration_us);
+  if (gap) {
+    ir_loopback_frame_end();
+    if (receiver->runs > 0 && receiver->corrupt > 0) {
+      receiver->corrupt--;
+    }
+    receiver->runs = 0;
+  }
+}
+
+static int32_t ir_loopback_test_send() {
+  return send_aircon_command_blocking(0, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 24,
+                                      0, 0);
+}
+
+// Stands in for another source notifying the sender while it waits, such as an I2C completion
+static int64_t ir_loopback_test_notify(alarm_id_t id, void *user_data) {
+  xTaskNotifyGive((TaskHandle_t)user_data);
+  return 0;
+}
+
+static void ir_loopback_test_clean() {
+  struct IrLoopbackStats stats;
+  add_alarm_in_us(10000, ir_loopback_test_notify, xTaskGetCurrentTaskHandle(), true);
+
+  CHECK_EQ(ir_loopback_test_send(), PICO_ERROR_NONE);
+  ir_loopback_stats(&stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK_EQ(stats.matched, 1);
+  CHECK_EQ(stats.retransmissions, 0);
+  CHECK_EQ(stats.mark.count, IR_TIMELINE_SYMBOL_COUNT);
+
+  // The notification that came in during the wait is still there for whoever it was meant for
+  CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 1);
+}
+
+static void ir_loopback_test_corrupted() {
+  struct IrLoopbackStats before;
+  struct IrLoopbackStats stats;
+  ir_loopback_stats(&before);
+
+  ir_loopback_test_receiver.corrupt = 1;
+  CHECK_EQ(ir_loopback_test_send(), PICO_ERROR_NONE);
+  ir_loopback_stats(&stats);
+  CHECK_EQ(stats.frames - before.frames, 2);
+  CHECK_EQ(stats.mismatched - before.mismatched, 1);
+  CHECK_EQ(stats.bit_errors - before.bit_errors, 2);
+  CHECK_EQ(stats.retransmissions - before.retransmissions, 1);
+  CHECK_EQ(stats.matched - before.matched, 1);
+  CHECK_EQ(stats.failures, 0);
+}
+
+static void ir_loopback_test_missing() {
+  struct IrLoopbackStats before;
+  struct IrLoopbackStats stats;
+  ir_loopback_stats(&before);
+
+  // Each attempt waits out the frame and the settling time before giving up on it
+  struct AirconFrame frame;
+  struct IrTimeline  timeline;
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 24, 0, 0);
+  ir_timeline_encode(&frame, &timeline);
+  uint64_t airtime_us = 0;
+  for (uint32_t i = 0; i < timeline.count; i++) {
+    airtime_us += ir_timeline_mark_us(timeline.symbols[i]) +
+                  ir_timeline_space_us(timeline.symbols[i]);
+  }
+
+  ir_loopback_test_receiver.drop = true;
+  uint64_t start                 = time_us_64();
+  CHECK_EQ(ir_loopback_test_send(), PICO_ERROR_IO);
+  uint64_t elapsed = time_us_64() - start;
+  ir_loopback_test_receiver.drop = false;
+
+  ir_loopback_stats(&stats);
+  CHECK_EQ(stats.missing - before.missing, IR_LOOPBACK_MAX_ATTEMPTS);
+  CHECK_EQ(stats.retransmissions - before.retransmissions, IR_LOOPBACK_MAX_ATTEMPTS - 1);
+  CHECK_EQ(stats.failures, 1);
+  // Give or take a tick per attempt
+  uint64_t attempt_us = airtime_us + IR_LOOPBACK_SETTLE_MS * 1000;
+  CHECK(elapsed + IR_LOOPBACK_MAX_ATTEMPTS * 1000 >= IR_LOOPBACK_MAX_ATTEMPTS * attempt_us);
+  CHECK(elapsed <= IR_LOOPBACK_MAX_ATTEMPTS * (attempt_us + 1000));
+}
+
+int main() {
+  static const uint pins[] = {IR_LOOPBACK_TEST_PIN};
+  ir_line_reset();
+  host_pio_reset();
+  ir_send_init(pins, count_of(pins));
+  ir_loopback_enable(0);
+
+  static struct IrChannel     channel;
+  const struct IrChannelModel model = {0};
+  ir_channel_init(&channel, IR_LOOPBACK_TEST_PIN, &model, 1);
+  ir_channel_set_sink(&channel, ir_loopback_test_receive, &ir_loopback_test_receiver);
+  ir_channel_start(&channel, IR_LOOPBACK_TEST_POLL_US);
+
+  ir_loopback_test_clean();
+  ir_loopback_test_corrupted();
+  ir_loopback_test_missing();
+
+  ir_channel_stop(&channel);
+  return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+// Several emitters sending at once through ir_send. Each zone's frame goes out on its own pin at
+// the same time as the others, and each pin's line carries exactly its own frame's marks and
+// spaces, with nothing from the other emitters in between.
+
+#include "aircon_service.h"
+#include "cmd_gen.h"
+#include "hardware/pio.h"
+#include "ir_line.h"
+#include "ir_send.h"
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "task.h"
+#include "test.h"
+
+#define IR_SEND_MULTI_TEST_ZONES    3
+#define IR_SEND_MULTI_TEST_IDLE_PIN 19  // Next to the emitters, never driven
+#define IR_SEND_MULTI_TEST_MAX_RUNS (2 * IR_TIMELINE_SYMBOL_COUNT + 1)
+
+static const uint ir_send_multi_test_pins[IR_SEND_MULTI_TEST_ZONES] = {16, 17, 18};
+
+// A different frame for each zone, so one zone's symbols can't pass for another's
+static const struct AirconSettings ir_send_multi_test_settings[IR_SEND_MULTI_TEST_ZONES] = {
+    {AC_MODE_COOLING, AC_FAN_AUTO, 20, 0, 0},
+    {AC_MODE_HEATING, AC_FAN_2, 24, 0, 0},
+    {AC_MODE_DEHUMIDIFY, AC_FAN_AUTO, 28, 60, 0},
+};
+
+static void ir_send_multi_test_frame(uint zone, struct AirconFrame *frame) {
+  const struct AirconSettings *s = &ir_send_multi_test_settings[zone];
+  aircon_frame_encode(frame, AC_UPDATE_AIRCON_MODE, s->mode, s->fan_speed, s->temperature,
+                      s->timer_on_duration, s->timer_off_duration);
+}
+
+static int32_t ir_send_multi_test_send(uint zone) {
+  const struct AirconSettings *s = &ir_send_multi_test_settings[zone];
+  return send_aircon_command(zone, AC_UPDATE_AIRCON_MODE, s->mode, s->fan_speed, s->temperature,
+                             s->timer_on_duration, s->timer_off_duration);
+}
+
+// The pin's runs from `start` on are the zone's timeline, mark for mark and space for space
+static void ir_send_multi_test_check_line(uint zone, uint64_t start) {
+  struct AirconFrame frame;
+  struct IrTimeline  timeline;
+  ir_send_multi_test_frame(zone, &frame);
+  ir_timeline_encode(&frame, &timeline);
+
+  static struct IrLineRun runs[IR_SEND_MULTI_TEST_MAX_RUNS];
+  size_t count = ir_line_runs(ir_send_multi_test_pins[zone], runs, count_of(runs));
+  CHECK_EQ(count, 2 * timeline.count + (start > 0));
+
+  // Idle until the send, then low for each mark and high for each space
+  const struct IrLineRun *symbol_runs = runs + (start > 0);
+  uint32_t                mismatches  = 0;
+  for (uint32_t i = 0; i < timeline.count && 2 * i + 1 < count - (start > 0); i++) {
+    if (symbol_runs[2 * i].level || !symbol_runs[2 * i + 1].level ||
+        symbol_runs[2 * i].duration_us != ir_timeline_mark_us(timeline.symbols[i]) ||
+        symbol_runs[2 * i + 1].duration_us != ir_timeline_space_us(timeline.symbols[i])) {
+      fprintf(stderr, "zone %u symbol %u: %u/%u us, expected %u/%u\n", zone, i,
+              symbol_runs[2 * i].duration_us, symbol_runs[2 * i + 1].duration_us,
+              ir_timeline_mark_us(timeline.symbols[i]),
+              ir_timeline_space_us(timeline.symbols[i]));
+      mismatches++;
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+int main() {
+  ir_line_reset();
+  host_pio_reset();
+  ir_send_init(ir_send_multi_test_pins, IR_SEND_MULTI_TEST_ZONES);
+  CHECK_EQ(ir_send_emitter_count(), IR_SEND_MULTI_TEST_ZONES);
+
+  // Past the end of the pool
+  CHECK_EQ(send_aircon_command(IR_SEND_MULTI_TEST_ZONES, AC_UPDATE_AIRCON_MODE, AC_MODE_OFF,
+                               AC_FAN_AUTO, 25, 0, 0),
+           PICO_ERROR_INVALID_ARG);
+
+  // Every zone at once, each handed to its own transmitter
+  uint64_t start = time_us_64();
+  for (uint zone = 0; zone < IR_SEND_MULTI_TEST_ZONES; zone++) {
+    CHECK_EQ(ir_send_multi_test_send(zone), PICO_ERROR_NONE);
+    CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 1);
+  }
+
+  // They all started together, so all three carry the leader's carrier now and finish within a
+  // frame of the start rather than one after the other
+  uint64_t frame_us = ir_line_busy_until(ir_send_multi_test_pins[0]) - start;
+  for (uint zone = 0; zone < IR_SEND_MULTI_TEST_ZONES; zone++) {
+    uint pin = ir_send_multi_test_pins[zone];
+    CHECK(ir_line_carrier_at(pin, start));
+    CHECK(ir_line_busy_until(pin) - start <= frame_us + frame_us / 10);
+    ir_send_multi_test_check_line(zone, start);
+  }
+
+  // Nothing leaks onto a pin no emitter drives
+  struct IrLineRun idle[1];
+  CHECK_EQ(ir_line_runs(IR_SEND_MULTI_TEST_IDLE_PIN, idle, count_of(idle)), 0);
+  CHECK_EQ(ir_line_busy_until(IR_SEND_MULTI_TEST_IDLE_PIN), 0);
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,242 @@
+// The transmit timeline against ir_send.pio run cycle by cycle. The host model of the program
+// (see ir_send.pio.h) takes its durations from ir_timeline.h rather than running it, so this
+// checks both against a small interpreter of the program as written: the word layout, that each
+// word comes out as the mark and space it was packed for, that those land on the protocol's
+// 410/422/1256 us timings, and that a frame sent through ir_send reaches the virtual IR line with
+// the same runs.
+
+#include "cmd_gen.h"
+#include "hardware/pio.h"
+#include "ir_line.h"
+#include "ir_send.h"
+#include "ir_timeline.h"
+#include "math.h"
+#include "pico/stdlib.h"
+#include "string.h"
+#include "task.h"
+#include "test.h"
+
+#define IR_PIO_TEST_PIN         16
+#define IR_PIO_TEST_MAX_PERIODS 16384  // Carrier periods in a frame, about 8300
+
+/////////////////
+// Interpreter //
+/////////////////
+
+enum IrPioOp {
+  IR_PIO_PULL,       // pull block
+  IR_PIO_OUT_X,      // out x, 16
+  IR_PIO_SET_PINS,   // set pins, value
+  IR_PIO_JMP_X_DEC,  // jmp x-- target
+};
+
+struct IrPioInstruction {
+  enum IrPioOp op;
+  uint32_t     value;  // Pin level for set, target for jmp
+  uint32_t     delay;
+};
+
+// ir_send.pio, instruction for instruction
+static const struct IrPioInstruction ir_pio_program[] = {
+    {IR_PIO_PULL, 0, 0},       // 0: pull block
+    {IR_PIO_OUT_X, 0, 0},      // 1: out x, 16
+    {IR_PIO_SET_PINS, 1, 7},   // 2: carrier: set pins, 1 [7]
+    {IR_PIO_SET_PINS, 0, 16},  // 3: set pins, 0 [16]
+    {IR_PIO_JMP_X_DEC, 2, 0},  // 4: jmp x-- carrier
+    {IR_PIO_OUT_X, 0, 0},      // 5: out x, 16
+    {IR_PIO_JMP_X_DEC, 6, 0},  // 6: space: jmp x-- space
+};
+
+// Cycle at which the pin went high, for each carrier period the program produced
+struct IrPioTrace {
+  uint64_t *rises;
+  size_t    count;
+};
+
+// Runs the program over `words` until it stalls on an empty FIFO
+static void ir_pio_run(const uint32_t *words, size_t count, struct IrPioTrace *trace) {
+  uint64_t cycle = 0;
+  size_t   next  = 0;
+  uint32_t pc    = 0;
+  uint32_t osr   = 0;
+  uint32_t x     = 0;
+  bool     pin   = false;
+
+  trace->count = 0;
+  while (true) {
+    const struct IrPioInstruction *in = &ir_pio_program[pc];
+    pc = (pc + 1) % count_of(ir_pio_program);  // .wrap after the last instruction
+
+    switch (in->op) {
+      case IR_PIO_PULL:
+        if (next == count) {
+          return;
+        }
+        osr = words[next++];
+        break;
+      case IR_PIO_OUT_X:
+        x = osr & 0xFFFF;  // Shifting right
+        osr >>= 16;
+        break;
+      case IR_PIO_SET_PINS:
+        if (in->value && !pin && trace->count < IR_PIO_TEST_MAX_PERIODS) {
+          trace->rises[trace->count++] = cycle;
+        }
+        pin = in->value;
+        break;
+      case IR_PIO_JMP_X_DEC:
+        if (x-- != 0) {
+          pc = in->value;
+        }
+        x &= 0xFFFF;  // Only ever loaded from 16 bits
+        break;
+    }
+    cycle += 1 + in->delay;
+  }
+}
+
+// Splits a trace into symbols, one burst of carrier and the idle time after it each, in state
+// machine cycles. The last symbol has nothing after it to end its space, so it isn't returned.
+static size_t ir_pio_symbols(const struct IrPioTrace *trace, uint32_t *marks, uint32_t *spaces,
+                             size_t max) {
+  size_t   count = 0;
+  uint64_t start = trace->count ? trace->rises[0] : 0;
+  for (size_t i = 1; i < trace->count && count < max; i++) {
+    uint64_t period_end = trace->rises[i - 1] + IR_SEND_CARRIER_CYCLES;
+    if (trace->rises[i] > period_end) {
+      marks[count]  = (uint32_t)(period_end - start);
+      spaces[count] = (uint32_t)(trace->rises[i] - period_end);
+      count++;
+      start = trace->rises[i];
+    }
+  }
+  return count;
+}
+
+static double ir_pio_cycles_to_us(uint32_t cycles) { return cycles * 1e6 / IR_SEND_PIO_HZ; }
+
+///////////
+// Tests //
+///////////
+
+static void ir_pio_test_word_layout() {
+  // 410 us is 15.58 carrier periods and 422 us 416.9 state machine cycles
+  CHECK_EQ(IR_US_TO_CARRIER_PERIODS(410), 16);
+  CHECK_EQ(IR_US_TO_SEND_CYCLES(422), 417);
+  CHECK_EQ(IR_US_TO_SEND_CYCLES(1256), 1241);
+  CHECK_EQ(IR_TIMELINE_SYMBOL(410, 422), (417u - 4) << 16 | (16 - 1));
+  CHECK_EQ(IR_TIMELINE_SYMBOL(410, 1256), (1241u - 4) << 16 | (16 - 1));
+  CHECK_EQ(IR_TIMELINE_SYMBOL(30000, 49500),
+           (IR_US_TO_SEND_CYCLES(49500) - 4) << 16 | (IR_US_TO_CARRIER_PERIODS(30000) - 1));
+
+  // Every word of a frame has the layout, with the space in range of its 16 bits
+  struct AirconFrame frame;
+  struct IrTimeline  timeline;
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0);
+  ir_timeline_encode(&frame, &timeline);
+  CHECK_EQ(timeline.count, IR_TIMELINE_SYMBOL_COUNT);
+  for (uint32_t i = 0; i < timeline.count; i++) {
+    uint32_t mark_us  = ir_timeline_mark_us(timeline.symbols[i]);
+    uint32_t space_us = ir_timeline_space_us(timeline.symbols[i]);
+    CHECK(IR_US_TO_SEND_CYCLES(space_us) - IR_SEND_SPACE_OVERHEAD_CYCLES <= 0xFFFF);
+    CHECK_EQ(timeline.symbols[i] & 0xFFFF, IR_US_TO_CARRIER_PERIODS(mark_us) - 1);
+  }
+}
+
+// Expected protocol durations of each symbol of a frame
+static void ir_pio_expected(const struct AirconFrame *frame, uint32_t symbol, uint32_t *mark_us,
+                            uint32_t *space_us) {
+  if (symbol == 0) {
+    *mark_us  = 30000;
+    *space_us = 49500;
+  } else if (symbol == 1) {
+    *mark_us  = 3380;
+    *space_us = 1700;
+  } else if (symbol == IR_TIMELINE_SYMBOL_COUNT - 1) {
+    *mark_us  = 410;
+    *space_us = 65000;  // Trailer
+  } else {
+    uint32_t bit = symbol - 2;  // LSB first
+    *mark_us     = 410;
+    *space_us    = frame->bytes[bit / 8] >> (bit % 8) & 1 ? 1256 : 422;
+  }
+}
+
+static void ir_pio_test_timeline(const struct AirconFrame *frame, uint32_t *marks,
+                                 uint32_t *spaces) {
+  struct IrTimeline timeline;
+  ir_timeline_encode(frame, &timeline);
+
+  // A short symbol after the frame ends the trailer space
+  static uint32_t words[IR_TIMELINE_SYMBOL_COUNT + 1];
+  static uint64_t rises[IR_PIO_TEST_MAX_PERIODS];
+  memcpy(words, timeline.symbols, sizeof(timeline.symbols));
+  words[timeline.count] = IR_TIMELINE_SYMBOL(410, 422);
+
+  struct IrPioTrace trace = {.rises = rises};
+  ir_pio_run(words, timeline.count + 1, &trace);
+  size_t count = ir_pio_symbols(&trace, marks, spaces, IR_TIMELINE_SYMBOL_COUNT);
+  CHECK_EQ(count, timeline.count);
+
+  for (size_t i = 0; i < count; i++) {
+    uint32_t word = timeline.symbols[i];
+
+    // The program as written takes what the word says
+    CHECK_EQ(marks[i], ((word & 0xFFFF) + 1) * IR_SEND_CARRIER_CYCLES);
+    CHECK_EQ(spaces[i], (word >> 16) + IR_SEND_SPACE_OVERHEAD_CYCLES);
+
+    // ir_timeline.h's reading of the word, which the host model sends, agrees to the microsecond
+    CHECK_EQ((uint32_t)ir_pio_cycles_to_us(marks[i]), ir_timeline_mark_us(word));
+    CHECK_EQ((uint32_t)ir_pio_cycles_to_us(spaces[i]), ir_timeline_space_us(word));
+
+    // Marks are whole carrier periods, so within half of one of the protocol's timing. Spaces
+    // are counted in cycles.
+    uint32_t mark_us, space_us;
+    ir_pio_expected(frame, i, &mark_us, &space_us);
+    double mark_error  = fabs(ir_pio_cycles_to_us(marks[i]) - mark_us);
+    double space_error = fabs(ir_pio_cycles_to_us(spaces[i]) - space_us);
+    if (mark_error > 0.5e6 / IR_CARRIER_HZ || space_error > 0.5e6 / IR_SEND_PIO_HZ) {
+      fprintf(stderr, "symbol %zu: %.1f/%.1f us, expected %u/%u\n", i,
+              ir_pio_cycles_to_us(marks[i]), ir_pio_cycles_to_us(spaces[i]), mark_us, space_us);
+      test_failures++;
+    }
+  }
+}
+
+// The frame sent through ir_send shows up on the line as the runs the program produces
+static void ir_pio_test_line(const uint32_t *marks, const uint32_t *spaces) {
+  const uint pin = IR_PIO_TEST_PIN;
+  ir_line_reset();
+  host_pio_reset();
+  ir_send_init(&pin, 1);
+
+  uint64_t start = time_us_64();
+  CHECK_EQ(send_aircon_command(0, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0),
+           PICO_ERROR_NONE);
+  CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 1);
+
+  static struct IrLineRun runs[2 * IR_TIMELINE_SYMBOL_COUNT + 1];
+  size_t                  count = ir_line_runs(pin, runs, count_of(runs));
+  CHECK_EQ(count, 2 * IR_TIMELINE_SYMBOL_COUNT + (start > 0));
+
+  // Idle until the send, then low for each mark and high for each space
+  const struct IrLineRun *symbol_runs = runs + (start > 0);
+  for (size_t i = 0; 2 * i + 1 < count - (start > 0); i++) {
+    CHECK_EQ(symbol_runs[2 * i].level, false);
+    CHECK_EQ(symbol_runs[2 * i + 1].level, true);
+    CHECK(fabs(symbol_runs[2 * i].duration_us - ir_pio_cycles_to_us(marks[i])) < 1);
+    CHECK(fabs(symbol_runs[2 * i + 1].duration_us - ir_pio_cycles_to_us(spaces[i])) < 1);
+  }
+}
+
+int main() {
+  static uint32_t    marks[IR_TIMELINE_SYMBOL_COUNT];
+  static uint32_t    spaces[IR_TIMELINE_SYMBOL_COUNT];
+  struct AirconFrame frame;
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, AC_MODE_COOLING, AC_FAN_AUTO, 25, 0, 0);
+
+  ir_pio_test_word_layout();
+  ir_pio_test_timeline(&frame, marks, spaces);
+  ir_pio_test_line(marks, spaces);
+  return TEST_RESULT();
+}
@@ -0,0 +1,78 @@
+// The SCD40 fixed point conversions in scd40_convert.h against the datasheet formulas in double
+// precision, for every raw input, and the offset conversion's inverse for every offset it takes.
+
+#include "math.h"
+#include "pico/stdlib.h"
+#include "scd40_convert.h"
+#include "test.h"
+
+// Rounds half up, as the fixed point conversions do
+static long scd40_convert_test_round(double value) { return (long)floor(value + 0.5); }
+
+static void scd40_convert_test_raw() {
+  uint32_t mismatches = 0;
+  for (uint32_t raw = 0; raw <= UINT16_MAX; raw++) {
+    long temperature = scd40_convert_test_round(-4500 + 17500.0 * raw / 65536);
+    long humidity    = scd40_convert_test_round(10000.0 * raw / 65536);
+    long offset      = scd40_convert_test_round(17500.0 * raw / 65536);
+    if (scd40_temperature_centi_cel(raw) != temperature ||
+        scd40_humidity_centi_percent(raw) != humidity ||
+        scd40_temperature_offset_centi_cel(raw) != offset) {
+      fprintf(stderr, "raw 0x%04X: %d %u %u, expected %ld %ld %ld\n", raw,
+              scd40_temperature_centi_cel(raw), scd40_humidity_centi_percent(raw),
+              scd40_temperature_offset_centi_cel(raw), temperature, humidity, offset);
+      mismatches++;
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+
+  // Both ends of each range
+  CHECK_EQ(scd40_temperature_centi_cel(0), -4500);
+  CHECK_EQ(scd40_temperature_centi_cel(UINT16_MAX), 13000);
+  CHECK_EQ(scd40_humidity_centi_percent(UINT16_MAX), 10000);
+}
+
+static void scd40_convert_test_offset_raw() {
+  uint32_t mismatches = 0;
+  for (uint32_t centi = 0; centi <= UINT16_MAX; centi++) {
+    long clamped  = centi > SCD40_TEMPERATURE_OFFSET_MAX_CENTI_CEL ?
+                        SCD40_TEMPERATURE_OFFSET_MAX_CENTI_CEL :
+                        (long)centi;
+    long expected = scd40_convert_test_round(clamped * 65536.0 / 17500);
+    if (expected > UINT16_MAX) {
+      expected = UINT16_MAX;
+    }
+    uint16_t raw = scd40_temperature_offset_raw(centi);
+    // What's written reads back as what was asked for
+    if (raw != expected || scd40_temperature_offset_centi_cel(raw) != clamped) {
+      fprintf(stderr, "offset %u: raw %u reads back %u, expected raw %ld\n", centi, raw,
+              scd40_temperature_offset_centi_cel(raw), expected);
+      mismatches++;
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+static void scd40_convert_test_batch() {
+  struct Scd40RawMeasurement raw[64];
+  struct Scd40Measurement    batch[count_of(raw)];
+  for (uint i = 0; i < count_of(raw); i++) {
+    raw[i] = (struct Scd40RawMeasurement){400 + i, i * 1021, UINT16_MAX - i * 1021};
+  }
+  scd40_convert_batch(raw, batch, count_of(raw));
+
+  for (uint i = 0; i < count_of(raw); i++) {
+    struct Scd40Measurement single;
+    scd40_convert(&raw[i], &single);
+    CHECK_EQ(batch[i].co2_ppm, raw[i].co2_ppm);
+    CHECK_EQ(batch[i].temperature_centi_cel, single.temperature_centi_cel);
+    CHECK_EQ(batch[i].humidity_centi_percent, single.humidity_centi_percent);
+  }
+}
+
+int main() {
+  scd40_convert_test_raw();
+  scd40_convert_test_offset_raw();
+  scd40_convert_test_batch();
+  return TEST_RESULT();
+}
@@ -0,0 +1,72 @@
+// The SCD4x CRC-8 against a bitwise reference for every two byte word, the datasheet example,
+// and the response unpacking in scd40_crc_unpack_words(). Built once with each table size.
+
+#include "pico/stdlib.h"
+#include "scd40_crc.h"
+#include "test.h"
+
+// Straight from the datasheet's description
+static uint8_t scd40_crc_test_reference(const uint8_t *data, uint16_t count) {
+  uint8_t crc = CRC8_INIT;
+  for (uint16_t i = 0; i < count; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x80 ? (uint8_t)(crc << 1) ^ CRC8_POLYNOMIAL : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static void scd40_crc_test_words() {
+  const uint8_t example[] = {0xBE, 0xEF};
+  CHECK_EQ(scd40_crc(example, 2), 0x92);
+
+  uint32_t mismatches = 0;
+  for (uint32_t word = 0; word <= 0xFFFF; word++) {
+    const uint8_t data[] = {word >> 8, word & 0xFF};
+    mismatches += scd40_crc(data, 2) != scd40_crc_test_reference(data, 2);
+  }
+  CHECK_EQ(mismatches, 0);
+
+  // Longer runs too, as for the commands with arguments
+  uint8_t data[64];
+  for (uint i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 37 + 11);
+  }
+  for (uint16_t count = 0; count <= sizeof(data); count++) {
+    CHECK_EQ(scd40_crc(data, count), scd40_crc_test_reference(data, count));
+  }
+}
+
+static void scd40_crc_test_unpack() {
+  // A read_measurement response: CO2 0x01F4, temperature 0x6667, humidity 0x5EB9
+  const uint16_t words[] = {0x01F4, 0x6667, 0x5EB9};
+  uint8_t        raw[9];
+  for (uint i = 0; i < 3; i++) {
+    raw[3 * i]     = words[i] >> 8;
+    raw[3 * i + 1] = words[i] & 0xFF;
+    raw[3 * i + 2] = scd40_crc_test_reference(&raw[3 * i], 2);
+  }
+
+  uint8_t out[6];
+  CHECK_EQ(scd40_crc_unpack_words(raw, 3, out), PICO_ERROR_NONE);
+  for (uint i = 0; i < 3; i++) {
+    CHECK_EQ(out[2 * i] << 8 | out[2 * i + 1], words[i]);
+  }
+
+  // Any bad block fails the whole response
+  for (uint i = 0; i < sizeof(raw); i++) {
+    uint8_t corrupt[9];
+    for (uint j = 0; j < sizeof(raw); j++) {
+      corrupt[j] = raw[j] ^ (i == j ? 0x04 : 0);
+    }
+    CHECK_EQ(scd40_crc_unpack_words(corrupt, 3, out), PICO_ERROR_INVALID_DATA);
+  }
+}
+
+int main() {
+  printf("%s table\n", SCD40_CRC_NIBBLE_TABLE ? "16 entry" : "256 entry");
+  scd40_crc_test_words();
+  scd40_crc_test_unpack();
+  return TEST_RESULT();
+}
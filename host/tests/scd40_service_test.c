@@ -0,0 +1,54 @@
+// scd40_service.c against a sensor whose clock runs slower than ours. Its samples fall further
+// behind the service's wakeups each period until one wakeup finds nothing ready. The service then
+// re-aligns to the sample it polled for and wakes a margin after the sensor from there, so it
+// doesn't poll again until that margin has drifted away too.
+
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include "scd40.h"
+#include "scd40_service.h"
+#include "scd40_sim.h"
+#include "test.h"
+
+#define SCD40_SERVICE_TEST_SLOW_US 10000  // Per period, 0.2%
+#define SCD40_SERVICE_TEST_STEPS   40
+#define SCD40_SERVICE_TEST_ALIGNED 10  // Samples after the re-align that must all be on time
+
+int main() {
+  static struct Scd40Sim sim;
+  scd40_sim_init(&sim);
+  sim.period_us = SCD40_SIM_PERIOD_US + SCD40_SERVICE_TEST_SLOW_US;
+  scd40_sim_set_sample(&sim, 800, 21.0f, 50.0f);
+  scd40_sim_attach(&sim, i2c0);
+
+  scd40_init(false);
+  CHECK_EQ(scd40_service_start(SCD40_SERVICE_PERIODIC), PICO_ERROR_NONE);
+
+  // Step until a wakeup comes too early
+  struct Scd40ServiceStats stats = {0};
+  uint32_t                 step  = 0;
+  while (step < SCD40_SERVICE_TEST_STEPS && stats.not_ready == 0) {
+    CHECK_EQ(scd40_service_step(), PICO_ERROR_NONE);
+    scd40_service_stats(&stats);
+    step++;
+  }
+  CHECK(stats.not_ready > 0);
+  uint32_t not_ready = stats.not_ready;
+
+  // Following the sensor from there, every wakeup finds its sample waiting
+  for (uint32_t i = 0; i < SCD40_SERVICE_TEST_ALIGNED; i++) {
+    CHECK_EQ(scd40_service_step(), PICO_ERROR_NONE);
+  }
+  scd40_service_stats(&stats);
+  CHECK_EQ(stats.not_ready, not_ready);
+  CHECK_EQ(stats.samples, step + SCD40_SERVICE_TEST_ALIGNED);
+  CHECK_EQ(stats.missed_samples, 0);
+  CHECK_EQ(stats.errors, 0);
+
+  struct Scd40Sample sample;
+  CHECK(scd40_service_latest(&sample));
+  CHECK_EQ(sample.co2_ppm, 800);
+  CHECK_EQ(sample.index, stats.samples - 1);
+
+  return TEST_RESULT();
+}
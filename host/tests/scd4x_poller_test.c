@@ -0,0 +1,58 @@
+// Two rooms through scd4x_poller.cpp with one sensor missing at first. The one that answers is
+// started, polled and published on its own, and the other joins once a later start finds it.
+
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include "scd40_sim.h"
+#include "scd4x_poller.h"
+#include "test.h"
+
+static const struct Scd4xSensorConfig scd4x_poller_test_sensors[] = {
+    {"Living", 0, 4, 5, false},
+    {"Bedroom", 1, 6, 7, false},
+};
+
+int main() {
+  static struct Scd40Sim living;
+  static struct Scd40Sim bedroom;
+  scd40_sim_init(&living);
+  scd40_sim_init(&bedroom);
+  scd40_sim_set_sample(&living, 600, 22.5f, 45.0f);
+  scd40_sim_set_sample(&bedroom, 900, 19.0f, 55.0f);
+
+  scd4x_poller_init(scd4x_poller_test_sensors, count_of(scd4x_poller_test_sensors));
+  scd40_sim_attach(&living, i2c0);
+
+  // Nothing answers on the bedroom's bus, but the living room still measures and publishes
+  CHECK(scd4x_poller_start(SCD40_SERVICE_PERIODIC) != PICO_ERROR_NONE);
+  CHECK_EQ(living.mode, SCD40_SIM_PERIODIC);
+  CHECK_EQ(scd4x_poller_step(), PICO_ERROR_NONE);
+
+  struct Scd40Sample sample;
+  CHECK(scd4x_poller_latest(0, &sample));
+  CHECK_EQ(sample.co2_ppm, 600);
+  CHECK(!scd4x_poller_latest(1, &sample));
+
+  struct Scd40ServiceStats stats;
+  scd4x_poller_sensor_stats(1, &stats);
+  CHECK(stats.errors > 0);
+  CHECK_EQ(stats.samples, 0);
+
+  // Once the sensor is there, starting again only starts it
+  scd40_sim_attach(&bedroom, i2c1);
+  uint32_t living_commands = living.commands;
+  CHECK_EQ(scd4x_poller_start(SCD40_SERVICE_PERIODIC), PICO_ERROR_NONE);
+  CHECK_EQ(living.commands, living_commands);
+  CHECK_EQ(bedroom.mode, SCD40_SIM_PERIODIC);
+
+  // It started out of step with the other, and is picked up within a round or two
+  for (uint round = 0; round < 3; round++) {
+    scd4x_poller_step();
+  }
+  CHECK(scd4x_poller_latest(0, &sample));
+  CHECK_EQ(sample.co2_ppm, 600);
+  CHECK(scd4x_poller_latest(1, &sample));
+  CHECK_EQ(sample.co2_ppm, 900);
+
+  return TEST_RESULT();
+}
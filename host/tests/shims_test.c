@@ -0,0 +1,176 @@
+// The SDK and FreeRTOS shims the other host tests and simulators stand on: the virtual clock and
+// its alarms, notifications, queues, and the virtual IR line behind the GPIO shim.
+
+#include "FreeRTOS.h"
+#include "ir_line.h"
+#include "pico/stdlib.h"
+#include "queue.h"
+#include "task.h"
+#include "test.h"
+
+static uint32_t shims_fired;
+static uint64_t shims_fired_at_us;
+
+static int64_t shims_alarm(alarm_id_t id, void *user_data) {
+  shims_fired++;
+  shims_fired_at_us = time_us_64();
+  return 0;
+}
+
+static int64_t shims_repeating_alarm(alarm_id_t id, void *user_data) {
+  shims_fired++;
+  return -1000;  // Every millisecond from the previous deadline
+}
+
+static int64_t shims_notify_alarm(alarm_id_t id, void *user_data) {
+  vTaskNotifyGiveFromISR((TaskHandle_t)user_data, NULL);
+  return 0;
+}
+
+static int64_t shims_queue_alarm(alarm_id_t id, void *user_data) {
+  uint32_t item = 42;
+  xQueueSendFromISR((QueueHandle_t)user_data, &item, NULL);
+  return 0;
+}
+
+static void shims_test_clock() {
+  uint64_t start = time_us_64();
+  sleep_us(250);
+  CHECK_EQ(time_us_64() - start, 250);
+  busy_wait_us_32(750);
+  CHECK_EQ(time_us_64() - start, 1000);
+  vTaskDelay(pdMS_TO_TICKS(3));
+  CHECK_EQ(time_us_64() - start, 4000);
+  CHECK_EQ(xTaskGetTickCount(), time_us_64() / 1000);
+
+  // Alarms run as the clock passes them, at their own deadline
+  shims_fired         = 0;
+  start               = time_us_64();
+  alarm_id_t early    = add_alarm_in_us(100, shims_alarm, NULL, false);
+  alarm_id_t canceled = add_alarm_in_us(50, shims_alarm, NULL, false);
+  CHECK(early > 0);
+  CHECK(cancel_alarm(canceled));
+  CHECK(!cancel_alarm(canceled));
+  sleep_us(99);
+  CHECK_EQ(shims_fired, 0);
+  sleep_us(10);
+  CHECK_EQ(shims_fired, 1);
+  CHECK_EQ(shims_fired_at_us - start, 100);
+  CHECK_EQ(time_us_64() - start, 109);
+
+  // A negative return reschedules against the previous deadline, so there's no drift
+  shims_fired        = 0;
+  alarm_id_t repeats = add_alarm_in_us(1000, shims_repeating_alarm, NULL, false);
+  sleep_ms(10);
+  CHECK_EQ(shims_fired, 10);
+  CHECK(cancel_alarm(repeats));
+
+  // Zero delay with fire_if_past runs it on the spot
+  shims_fired = 0;
+  CHECK_EQ(add_alarm_in_us(0, shims_alarm, NULL, true), 0);
+  CHECK_EQ(shims_fired, 1);
+
+  CHECK(!host_time_run_next_alarm(UINT64_MAX));
+}
+
+static void shims_test_notifications() {
+  TaskHandle_t task;
+  CHECK_EQ(xTaskCreate(NULL, "ShimsTask", configMINIMAL_STACK_SIZE, NULL, 1, &task), pdPASS);
+  host_task_set_current(task);
+  CHECK(xTaskGetCurrentTaskHandle() == task);
+
+  // Waiting runs alarms until one notifies
+  uint64_t start = time_us_64();
+  add_alarm_in_us(500, shims_notify_alarm, task, false);
+  CHECK_EQ(ulTaskNotifyTake(pdTRUE, portMAX_DELAY), 1);
+  CHECK_EQ(time_us_64() - start, 500);
+
+  // A timeout moves the clock to the deadline
+  start = time_us_64();
+  CHECK_EQ(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2)), 0);
+  CHECK_EQ(time_us_64() - start, 2000);
+
+  // Without clearing, each take uses up one notification
+  xTaskNotifyGive(task);
+  xTaskNotifyGive(task);
+  CHECK_EQ(ulTaskNotifyTake(pdFALSE, 0), 2);
+  CHECK_EQ(ulTaskNotifyTake(pdFALSE, 0), 1);
+  CHECK_EQ(ulTaskNotifyTake(pdFALSE, 0), 0);
+
+  host_task_set_current(NULL);
+  CHECK(xTaskGetCurrentTaskHandle() != task);
+}
+
+static void shims_test_queues() {
+  QueueHandle_t queue = xQueueCreate(2, sizeof(uint32_t));
+  uint32_t      item  = 1;
+  CHECK_EQ(xQueueSend(queue, &item, 0), pdPASS);
+  item = 2;
+  CHECK_EQ(xQueueSend(queue, &item, 0), pdPASS);
+  CHECK_EQ(xQueueSend(queue, &item, portMAX_DELAY), pdFAIL);  // Full fails without waiting
+  CHECK_EQ(uxQueueMessagesWaiting(queue), 2);
+
+  CHECK_EQ(xQueueReceive(queue, &item, 0), pdPASS);
+  CHECK_EQ(item, 1);
+  CHECK_EQ(xQueueReceive(queue, &item, 0), pdPASS);
+  CHECK_EQ(item, 2);
+
+  // Empty waits for an alarm to fill it, or times out
+  uint64_t start = time_us_64();
+  CHECK_EQ(xQueueReceive(queue, &item, pdMS_TO_TICKS(1)), pdFAIL);
+  CHECK_EQ(time_us_64() - start, 1000);
+  add_alarm_in_us(300, shims_queue_alarm, queue, false);
+  CHECK_EQ(xQueueReceive(queue, &item, portMAX_DELAY), pdPASS);
+  CHECK_EQ(item, 42);
+
+  vQueueDelete(queue);
+}
+
+static void shims_test_ir_line() {
+  const uint tx = 16;
+  const uint rx = 5;
+  ir_line_reset();
+  ir_line_connect(rx, tx);
+  CHECK_EQ(ir_line_source(rx), tx);
+  CHECK_EQ(ir_line_source(tx), -1);
+
+  // Carrier follows the pin under SIO
+  gpio_init(tx);
+  gpio_set_dir(tx, GPIO_OUT);
+  uint64_t start = time_us_64();
+  sleep_us(100);
+  gpio_put(tx, true);
+  CHECK(!gpio_get(rx));  // The receiver's output is low during a mark
+  sleep_us(400);
+  gpio_put(tx, false);
+  CHECK(gpio_get(rx));
+  sleep_us(100);
+
+  // Symbols queue up behind each other
+  ir_line_append_symbol(tx, 300, 200);
+  ir_line_append_symbol(tx, 300, 0);
+  ir_line_append_symbol(tx, 300, 700);
+  CHECK_EQ(ir_line_busy_until(tx), start + 600 + 500 + 300 + 1000);
+
+  // The zero length space merges its neighbours into one mark
+  const struct IrLineRun expected[] = {
+      {true, start + 100}, {false, 400}, {true, 100}, {false, 300},
+      {true, 200},         {false, 600}, {true, 700},
+  };
+  struct IrLineRun runs[8];
+  size_t           count = ir_line_runs(tx, runs, count_of(runs));
+  CHECK_EQ(count, count_of(expected));
+  for (size_t i = 0; i < count && i < count_of(expected); i++) {
+    CHECK_EQ(runs[i].level, expected[i].level);
+    CHECK_EQ(runs[i].duration_us, expected[i].duration_us);
+  }
+  ir_line_reset();
+}
+
+int main() {
+  shims_test_clock();
+  shims_test_notifications();
+  shims_test_queues();
+  shims_test_ir_line();
+  return TEST_RESULT();
+}
@@ -0,0 +1,36 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "stdio.h"
+#include "stdlib.h"
+
+// Checks for the host tests. A failed check prints where it was and carries on, so one run shows
+// every failure. Each test's main() returns TEST_RESULT(), which ctest takes as the verdict.
+
+static unsigned test_failures;
+
+#define CHECK(cond)                                                              \
+  do {                                                                           \
+    if (!(cond)) {                                                               \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      test_failures++;                                                           \
+    }                                                                            \
+  } while (0)
+
+// Integers only, printed as such when they differ
+#define CHECK_EQ(actual, expected)                                                        \
+  do {                                                                                    \
+    long long test_actual_   = (long long)(actual);                                       \
+    long long test_expected_ = (long long)(expected);                                     \
+    if (test_actual_ != test_expected_) {                                                 \
+      fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, \
+              test_actual_, test_expected_);                                              \
+      test_failures++;                                                                    \
+    }                                                                                     \
+  } while (0)
+
+#define TEST_RESULT()                                                   \
+  (test_failures == 0 ? (printf("All checks passed\n"), EXIT_SUCCESS) : \
+                        (printf("%u checks failed\n", test_failures), EXIT_FAILURE))
+
+#endif  // HOST_TEST_H
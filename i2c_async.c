@@ -0,0 +1,170 @@
+#include "i2c_async.h"
+
+#include "hardware/sync.h"
+#include "perf_trace.h"
+#include "string.h"
+
+#define I2C_ASYNC_BUSES 2
+
+enum I2cAsyncPhase {
+  I2C_ASYNC_IDLE,
+  I2C_ASYNC_WRITE,
+  I2C_ASYNC_DELAY,
+  I2C_ASYNC_READ,
+};
+
+struct I2cAsyncBus {
+  i2c_inst_t                 *i2c;
+  spin_lock_t                *lock;  // Guards the queue, which either core may submit to
+  struct I2cAsyncTransaction *head;  // In progress
+  struct I2cAsyncTransaction *tail;
+  volatile uint8_t            phase;
+};
+
+static struct I2cAsyncBus i2c_async_buses[I2C_ASYNC_BUSES];
+
+static inline struct I2cAsyncBus *i2c_async_bus(i2c_inst_t *i2c) {
+  return &i2c_async_buses[i2c_hw_index(i2c)];
+}
+
+void i2c_async_init(i2c_inst_t *i2c, uint baudrate) {
+  struct I2cAsyncBus *bus = i2c_async_bus(i2c);
+  memset(bus, 0, sizeof(*bus));
+  bus->i2c  = i2c;
+  bus->lock = spin_lock_instance(spin_lock_claim_unused(true));
+
+  i2c_async_port_init(i2c, baudrate);
+}
+
+// Only the bus owner (whoever moved it out of idle, then the completion path) calls these, so
+// they don't need the lock
+static void i2c_async_read_phase(struct I2cAsyncBus *bus) {
+  struct I2cAsyncTransaction *transaction = bus->head;
+  bus->phase                              = I2C_ASYNC_READ;
+  i2c_async_port_read(bus->i2c, transaction->address, transaction->read, transaction->read_len);
+}
+
+static void i2c_async_start(struct I2cAsyncBus *bus) {
+  struct I2cAsyncTransaction *transaction = bus->head;
+  PERF_TRACE_SPAN_BEGIN(PERF_TRACE_I2C, bus - i2c_async_buses);
+  if (transaction->write_len > 0) {
+    bus->phase = I2C_ASYNC_WRITE;
+    i2c_async_port_write(bus->i2c, transaction->address, transaction->write,
+                         transaction->write_len);
+  } else {
+    i2c_async_read_phase(bus);
+  }
+}
+
+static void i2c_async_finish(struct I2cAsyncBus *bus, int32_t result) {
+  struct I2cAsyncTransaction *transaction = bus->head;
+  PERF_TRACE_SPAN_END(PERF_TRACE_I2C, bus - i2c_async_buses);
+
+  uint32_t saved_irq  = spin_lock_blocking(bus->lock);
+  bus->head           = transaction->next;
+  bool     start_next = bus->head != NULL;
+  if (!start_next) {
+    bus->tail  = NULL;
+    bus->phase = I2C_ASYNC_IDLE;
+  }
+  spin_unlock(bus->lock, saved_irq);
+
+  // Keep the bus busy before handing the finished transaction back
+  if (start_next) {
+    i2c_async_start(bus);
+  }
+
+  transaction->result       = result;
+  transaction->completed_us = time_us_32();
+  if (transaction->callback != NULL) {
+    transaction->callback(transaction);
+  }
+
+  // The owner may reuse the transaction as soon as it sees `complete`
+  TaskHandle_t task = transaction->notify_task;
+  __dmb();
+  transaction->complete = true;
+
+  if (task != NULL) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+  }
+}
+
+static int64_t i2c_async_delay_elapsed(alarm_id_t id, void *user_data) {
+  struct I2cAsyncBus *bus = user_data;
+  if (bus->head->read_len > 0) {
+    i2c_async_read_phase(bus);
+  } else {
+    i2c_async_finish(bus, PICO_ERROR_NONE);
+  }
+  return 0;
+}
+
+void i2c_async_port_done(i2c_inst_t *i2c, int32_t result) {
+  struct I2cAsyncBus         *bus         = i2c_async_bus(i2c);
+  struct I2cAsyncTransaction *transaction = bus->head;
+
+  if (result == PICO_ERROR_NONE && bus->phase == I2C_ASYNC_WRITE) {
+    if (transaction->delay_us > 0) {
+      bus->phase = I2C_ASYNC_DELAY;
+      if (add_alarm_in_us(transaction->delay_us, i2c_async_delay_elapsed, bus, true) >= 0) {
+        return;
+      }
+      result = PICO_ERROR_INSUFFICIENT_RESOURCES;
+    } else if (transaction->read_len > 0) {
+      i2c_async_read_phase(bus);
+      return;
+    }
+  }
+
+  i2c_async_finish(bus, result);
+}
+
+int32_t i2c_async_submit(i2c_inst_t *i2c, struct I2cAsyncTransaction *transaction) {
+  if (transaction->write_len > I2C_ASYNC_MAX_WRITE || transaction->read_len > I2C_ASYNC_MAX_READ ||
+      (transaction->write_len == 0 && transaction->read_len == 0) ||
+      (transaction->read_len > 0 && transaction->read == NULL)) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+
+  transaction->complete     = false;
+  transaction->result       = PICO_ERROR_NONE;
+  transaction->next         = NULL;
+  transaction->submitted_us = time_us_32();
+
+  struct I2cAsyncBus *bus       = i2c_async_bus(i2c);
+  uint32_t            saved_irq = spin_lock_blocking(bus->lock);
+  bool                idle      = bus->head == NULL;
+  if (idle) {
+    bus->head  = transaction;
+    bus->phase = I2C_ASYNC_WRITE;  // Claimed, so a submit from the other core just queues
+  } else {
+    bus->tail->next = transaction;
+  }
+  bus->tail = transaction;
+  spin_unlock(bus->lock, saved_irq);
+
+  if (idle) {
+    i2c_async_start(bus);
+  }
+
+  return PICO_ERROR_NONE;
+}
+
+int32_t i2c_async_transfer(i2c_inst_t *i2c, struct I2cAsyncTransaction *transaction) {
+  transaction->notify_task = xTaskGetCurrentTaskHandle();
+
+  int32_t err = i2c_async_submit(i2c, transaction);
+  if (err != PICO_ERROR_NONE) {
+    return err;
+  }
+
+  // Other notifications to this task may arrive first, so wait for the flag
+  while (!transaction->complete) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+
+  return transaction->result;
+}
@@ -0,0 +1,73 @@
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include "FreeRTOS.h"
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+#include "task.h"
+
+// Queued I2C transactions that run from interrupts. A transaction is an optional write, a delay
+// and an optional read, each a complete bus transfer. That covers the Sensirion pattern of a
+// command, its execution time and the response, without anyone sleeping in between: the delay
+// is a timer alarm and the bus is free for other devices while it runs.
+
+#define I2C_ASYNC_MAX_WRITE 8
+#define I2C_ASYNC_MAX_READ  16  // Bounded by the controller's RX FIFO
+
+struct I2cAsyncTransaction;
+
+// Runs in interrupt context once the transaction has finished
+typedef void (*i2c_async_callback_t)(struct I2cAsyncTransaction *transaction);
+
+struct I2cAsyncTransaction {
+  // Request
+  uint8_t  address;
+  uint8_t  write_len;
+  uint8_t  read_len;
+  uint8_t  write[I2C_ASYNC_MAX_WRITE];
+  uint8_t *read;
+  uint32_t delay_us;  // After the write, before the read or completion
+
+  // Completion. Either or both may be set.
+  i2c_async_callback_t callback;
+  void                *user_data;
+  TaskHandle_t         notify_task;
+
+  // Result, valid once `complete` is set
+  volatile int32_t result;
+  volatile bool    complete;
+  uint32_t         submitted_us;
+  uint32_t         completed_us;
+
+  struct I2cAsyncTransaction *next;
+};
+
+// Sets the bus up for interrupt driven transfers. Up to 400 kHz (fast mode).
+void i2c_async_init(i2c_inst_t *i2c, uint baudrate);
+
+// Queues a transaction and returns immediately. The transaction must stay valid until complete.
+int32_t i2c_async_submit(i2c_inst_t *i2c, struct I2cAsyncTransaction *transaction);
+
+// Queues a transaction and blocks the calling task on a notification until it completes.
+// Returns the transaction's result.
+int32_t i2c_async_transfer(i2c_inst_t *i2c, struct I2cAsyncTransaction *transaction);
+
+static inline uint32_t i2c_async_latency_us(const struct I2cAsyncTransaction *transaction) {
+  return transaction->completed_us - transaction->submitted_us;
+}
+
+//////////
+// Port //
+//////////
+
+// Implemented by i2c_async_rp2040.c on the board and host/host_i2c.c in the host build. Each
+// call starts one complete transfer ending in a STOP, and the port reports the outcome through
+// i2c_async_port_done() from interrupt context.
+void i2c_async_port_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_async_port_write(i2c_inst_t *i2c, uint8_t address, const uint8_t *src, uint8_t len);
+void i2c_async_port_read(i2c_inst_t *i2c, uint8_t address, uint8_t *dst, uint8_t len);
+
+void i2c_async_port_done(i2c_inst_t *i2c, int32_t result);
+
+#endif  // I2C_ASYNC_H
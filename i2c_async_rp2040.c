@@ -0,0 +1,98 @@
+#include "core_partition.h"
+#include "hardware/irq.h"
+#include "i2c_async.h"
+
+// Interrupt driven port for the RP2040's I2C controllers. Writes are at most I2C_ASYNC_MAX_WRITE
+// bytes and reads at most I2C_ASYNC_MAX_READ, so a whole transfer fits in the 16 entry FIFOs: it
+// is loaded in one go and the controller raises STOP_DET once it is done, with no need for DMA.
+
+struct I2cAsyncPort {
+  uint8_t *dst;  // NULL for writes
+  uint8_t  len;
+  bool     aborted;
+};
+
+static struct I2cAsyncPort i2c_async_ports[2];
+
+static void i2c_async_port_target(i2c_hw_t *hw, uint8_t address) {
+  hw->enable = 0;
+  hw->tar    = address;
+  hw->enable = 1;
+  (void)hw->clr_intr;
+  hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+}
+
+static void __isr i2c_async_port_irq(i2c_inst_t *i2c) {
+  i2c_hw_t            *hw     = i2c_get_hw(i2c);
+  struct I2cAsyncPort *port   = &i2c_async_ports[i2c_hw_index(i2c)];
+  uint32_t             status = hw->intr_stat;
+
+  // An abort (usually a NACK) flushes the TX FIFO and is followed by the STOP
+  if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+    port->aborted = true;
+    (void)hw->clr_tx_abrt;
+  }
+  if (!(status & I2C_IC_INTR_STAT_R_STOP_DET_BITS)) {
+    return;
+  }
+  (void)hw->clr_stop_det;
+  hw->intr_mask = 0;
+
+  int32_t result = port->aborted ? PICO_ERROR_GENERIC : PICO_ERROR_NONE;
+  if (port->dst != NULL && result == PICO_ERROR_NONE) {
+    if (hw->rxflr < port->len) {
+      result = PICO_ERROR_IO;
+    }
+    for (uint8_t i = 0; i < port->len && result == PICO_ERROR_NONE; i++) {
+      port->dst[i] = (uint8_t)hw->data_cmd;
+    }
+  }
+  // Leave nothing behind for the next transfer
+  while (hw->rxflr > 0) {
+    (void)hw->data_cmd;
+  }
+
+  i2c_async_port_done(i2c, result);
+}
+
+static void __isr i2c_async_port_irq0() { i2c_async_port_irq(i2c0); }
+
+static void __isr i2c_async_port_irq1() { i2c_async_port_irq(i2c1); }
+
+void i2c_async_port_init(i2c_inst_t *i2c, uint baudrate) {
+  i2c_init(i2c, baudrate);
+  i2c_get_hw(i2c)->intr_mask = 0;
+
+  uint irq = i2c_hw_index(i2c) == 0 ? I2C0_IRQ : I2C1_IRQ;
+  irq_set_exclusive_handler(irq, i2c_hw_index(i2c) == 0 ? i2c_async_port_irq0 :
+                                                          i2c_async_port_irq1);
+  core_partition_enable_irq(irq, CORE_ROLE_SYSTEM);
+}
+
+void i2c_async_port_write(i2c_inst_t *i2c, uint8_t address, const uint8_t *src, uint8_t len) {
+  i2c_hw_t            *hw   = i2c_get_hw(i2c);
+  struct I2cAsyncPort *port = &i2c_async_ports[i2c_hw_index(i2c)];
+
+  port->dst     = NULL;
+  port->len     = len;
+  port->aborted = false;
+
+  i2c_async_port_target(hw, address);
+  for (uint8_t i = 0; i < len; i++) {
+    hw->data_cmd = (i + 1 == len ? I2C_IC_DATA_CMD_STOP_BITS : 0) | src[i];
+  }
+}
+
+void i2c_async_port_read(i2c_inst_t *i2c, uint8_t address, uint8_t *dst, uint8_t len) {
+  i2c_hw_t            *hw   = i2c_get_hw(i2c);
+  struct I2cAsyncPort *port = &i2c_async_ports[i2c_hw_index(i2c)];
+
+  port->dst     = dst;
+  port->len     = len;
+  port->aborted = false;
+
+  i2c_async_port_target(hw, address);
+  for (uint8_t i = 0; i < len; i++) {
+    hw->data_cmd = (i + 1 == len ? I2C_IC_DATA_CMD_STOP_BITS : 0) | I2C_IC_DATA_CMD_CMD_BITS;
+  }
+}
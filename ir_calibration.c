@@ -0,0 +1,215 @@
+#include "ir_calibration.h"
+
+#include "FreeRTOS.h"
+#include "event_log.h"
+#include "hardware/flash.h"
+#include "ir_loopback.h"
+#include "pico/flash.h"
+#include "stddef.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "task.h"
+
+// The last sector, clear of the program image
+#define IR_CALIBRATION_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define IR_CALIBRATION_MAGIC        0x54524D49  // "IMRT"
+#define IR_CALIBRATION_VERSION      1
+
+struct IrCalibrationRecord {
+  uint32_t              magic;
+  uint16_t              version;
+  uint16_t              kinds;
+  struct IrTimelineTrim trim;
+  uint32_t              check;  // Inverted sum of the words above
+};
+_Static_assert(sizeof(struct IrCalibrationRecord) <= FLASH_PAGE_SIZE, "Record must fit a page");
+_Static_assert(sizeof(struct IrCalibrationRecord) % 4 == 0, "Check covers whole words");
+
+struct IrCalibrationHistogram {
+  uint32_t sent_us;  // As the transmitter actually produced it, after rounding
+  uint32_t bin_us;
+  uint16_t bins[IR_CALIBRATION_BINS];
+  uint32_t below;  // Shorter than the first bin
+  uint32_t above;  // Longer than the last bin
+  uint32_t samples;
+};
+
+// Filled in by the receive path through the loopback observer while a pass runs
+static struct IrCalibrationHistogram ir_calibration_histograms[IR_TIMING_KINDS];
+
+/////////////
+// Storage //
+/////////////
+
+static uint32_t ir_calibration_check(const struct IrCalibrationRecord *record) {
+  const uint32_t *words = (const uint32_t *)record;
+  uint32_t        sum   = 0;
+  for (size_t i = 0; i < offsetof(struct IrCalibrationRecord, check) / 4; i++) {
+    sum += words[i];
+  }
+  return ~sum;
+}
+
+static const struct IrCalibrationRecord *ir_calibration_stored() {
+  return (const struct IrCalibrationRecord *)(XIP_BASE + IR_CALIBRATION_FLASH_OFFSET);
+}
+
+bool ir_calibration_load() {
+  const struct IrCalibrationRecord *record = ir_calibration_stored();
+  if (record->magic != IR_CALIBRATION_MAGIC || record->version != IR_CALIBRATION_VERSION ||
+      record->kinds != IR_TIMING_KINDS || record->check != ir_calibration_check(record)) {
+    return false;
+  }
+  ir_timeline_set_trim(&record->trim);
+  return true;
+}
+
+// Runs with the other core locked out, since it can't execute from flash while it's written
+static void ir_calibration_program(void *param) {
+  flash_range_erase(IR_CALIBRATION_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(IR_CALIBRATION_FLASH_OFFSET, param, FLASH_PAGE_SIZE);
+}
+
+static int32_t ir_calibration_store(const struct IrTimelineTrim *trim) {
+  static uint8_t page[FLASH_PAGE_SIZE];
+  memset(page, 0xFF, sizeof(page));
+
+  struct IrCalibrationRecord record = {
+      .magic   = IR_CALIBRATION_MAGIC,
+      .version = IR_CALIBRATION_VERSION,
+      .kinds   = IR_TIMING_KINDS,
+      .trim    = *trim,
+  };
+  record.check = ir_calibration_check(&record);
+  memcpy(page, &record, sizeof(record));
+
+  return flash_safe_execute(ir_calibration_program, page, UINT32_MAX);
+}
+
+////////////////
+// Histograms //
+////////////////
+
+static void ir_calibration_observe(uint32_t symbol, bool mark, uint32_t sent_us,
+                                   uint32_t received_us) {
+  enum IrTimingKind kind = ir_timeline_kind(symbol, mark, sent_us);
+
+  struct IrCalibrationHistogram *histogram = &ir_calibration_histograms[kind];
+  int32_t offset = (int32_t)received_us - (int32_t)ir_timeline_target_us(kind) +
+                   (int32_t)(IR_CALIBRATION_BINS / 2 * histogram->bin_us);
+  if (offset < 0) {
+    histogram->below++;
+  } else if (offset >= (int32_t)(IR_CALIBRATION_BINS * histogram->bin_us)) {
+    histogram->above++;
+  } else if (histogram->bins[offset / histogram->bin_us] < UINT16_MAX) {
+    histogram->bins[offset / histogram->bin_us]++;
+  }
+  histogram->sent_us = sent_us;
+  histogram->samples++;
+}
+
+static void ir_calibration_reset() {
+  memset(ir_calibration_histograms, 0, sizeof(ir_calibration_histograms));
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    uint32_t bin_us = ir_timeline_target_us(kind) / 1024;
+    ir_calibration_histograms[kind].bin_us =
+        bin_us > IR_CALIBRATION_MIN_BIN_US ? bin_us : IR_CALIBRATION_MIN_BIN_US;
+  }
+}
+
+// Median received length minus target. A median outside the histogram reads as its edge.
+static int16_t ir_calibration_median_error(const struct IrCalibrationHistogram *histogram) {
+  int32_t  range = IR_CALIBRATION_BINS / 2 * histogram->bin_us;
+  uint32_t half  = (histogram->samples + 1) / 2;
+  uint32_t seen  = histogram->below;
+  if (seen >= half) {
+    return (int16_t)-range;
+  }
+  for (uint i = 0; i < IR_CALIBRATION_BINS; i++) {
+    seen += histogram->bins[i];
+    if (seen >= half) {
+      // The middle of the bin
+      return (int16_t)(i * histogram->bin_us + histogram->bin_us / 2 - range);
+    }
+  }
+  return (int16_t)range;
+}
+
+// Sends the test frame `frames` times with the current trim, collecting histograms. How many
+// copies matched doesn't matter, only their timing.
+static int32_t ir_calibration_pass(uint emitter, uint frames) {
+  ir_calibration_reset();
+  int32_t matched = ir_loopback_measure(emitter, frames, ir_calibration_observe);
+  return matched < 0 ? matched : PICO_ERROR_NONE;
+}
+
+int32_t ir_calibration_run(uint emitter, uint frames, struct IrCalibrationReport *report) {
+  if (!ir_loopback_enabled(emitter) || frames == 0) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+
+  struct IrTimelineTrim before;
+  struct IrTimelineTrim after;
+  ir_timeline_get_trim(&before);
+  after = before;
+
+  memset(report, 0, sizeof(*report));
+  report->frames = frames;
+
+  int32_t err = ir_calibration_pass(emitter, frames);
+  if (err) {
+    return err;
+  }
+
+  bool measured = true;
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    struct IrCalibrationTiming *timing = &report->timings[kind];
+    timing->target_us       = ir_timeline_target_us(kind);
+    timing->samples         = ir_calibration_histograms[kind].samples;
+    timing->trim_before_us  = before.us[kind];
+    timing->error_before_us = ir_calibration_median_error(&ir_calibration_histograms[kind]);
+    measured                = measured && timing->samples > 0;
+
+    // Send shorter by as much as the receiver sees it longer. Working from what was really sent
+    // lets the encoder's rounding pick the nearest length it can produce.
+    int32_t sent          = (int32_t)ir_calibration_histograms[kind].sent_us;
+    after.us[kind]        = sent - timing->error_before_us - ir_timeline_protocol_us(kind);
+    timing->trim_after_us = after.us[kind];
+  }
+
+  ir_timeline_set_trim(&after);
+  err = ir_calibration_pass(emitter, frames);
+
+  uint32_t total_before = 0;
+  uint32_t total_after  = 0;
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    struct IrCalibrationTiming *timing = &report->timings[kind];
+    timing->error_after_us = ir_calibration_median_error(&ir_calibration_histograms[kind]);
+    measured               = measured && ir_calibration_histograms[kind].samples > 0;
+    total_before += abs(timing->error_before_us);
+    total_after += abs(timing->error_after_us);
+    EVENT_LOG3(LOG_IR_CALIBRATION, kind, timing->error_before_us, timing->error_after_us);
+  }
+
+  if (err == PICO_ERROR_NONE && (!measured || total_after > total_before)) {
+    err = PICO_ERROR_INVALID_DATA;
+  }
+  if (err) {
+    ir_timeline_set_trim(&before);
+    return err;
+  }
+
+  return ir_calibration_store(&after);
+}
+
+void ir_calibration_print(const struct IrCalibrationReport *report) {
+  printf("IR timing calibration, %u frames per pass\n", report->frames);
+  printf("%-16s %8s %8s %8s %8s %8s\n", "", "target", "trim", "error", "trim", "error");
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    const struct IrCalibrationTiming *timing = &report->timings[kind];
+    printf("%-16s %8u %8d %8d %8d %8d\n", ir_timing_kind_names[kind], timing->target_us,
+           timing->trim_before_us, timing->error_before_us, timing->trim_after_us,
+           timing->error_after_us);
+  }
+}
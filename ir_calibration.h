@@ -0,0 +1,48 @@
+#ifndef IR_CALIBRATION_H
+#define IR_CALIBRATION_H
+
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+
+// Transmit timing calibration. What the receiver sees of each mark and space differs from what
+// the PIO sends. The LED, the receiver's AGC and the carrier rounding all contribute, by amounts
+// that depend on the parts fitted. Calibration sends test frames through the loopback check (see
+// ir_loopback.h) and builds a histogram of each kind of duration as received. It then trims each
+// kind so its median lands on its target (see ir_timeline_target_us()), and checks the result
+// with a second pass. Marks are whole carrier periods, so they only get as close as 13 us.
+// The trim is kept in the last flash sector and applied at boot by ir_calibration_load().
+
+#define IR_CALIBRATION_FRAMES 8  // Test frames per pass
+// Histograms are centred on the targets. Bins are the receiver's 2 us resolution, or 1/1024 of
+// the target for the long leader durations, so every histogram spans about 6% either way.
+#define IR_CALIBRATION_BINS       128
+#define IR_CALIBRATION_MIN_BIN_US 2
+
+struct IrCalibrationTiming {
+  uint32_t target_us;
+  uint32_t samples;  // Received runs of this kind in the first pass
+  int16_t  trim_before_us;
+  int16_t  trim_after_us;
+  // Median received length minus target, with each trim. Saturates at the histogram's edge.
+  int16_t  error_before_us;
+  int16_t  error_after_us;
+};
+
+struct IrCalibrationReport {
+  uint32_t                   frames;  // Test frames sent in each pass
+  struct IrCalibrationTiming timings[IR_TIMING_KINDS];
+};
+
+// Applies the stored trim. Returns false, leaving the timeline untrimmed, if none is stored.
+bool ir_calibration_load();
+
+// Calibrates `emitter`, which needs the loopback check enabled and ir_recv_task running. Takes
+// about 1.5 s per test frame. The new trim is stored and kept if every kind was seen in both
+// passes and the total error didn't grow. Otherwise the old trim is restored and the result is
+// PICO_ERROR_INVALID_DATA. The report is filled in either way.
+int32_t ir_calibration_run(uint emitter, uint frames, struct IrCalibrationReport *report);
+
+void ir_calibration_print(const struct IrCalibrationReport *report);
+
+#endif  // IR_CALIBRATION_H
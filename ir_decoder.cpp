@@ -0,0 +1,28 @@
+#include "ir_protocol.hpp"
+
+extern "C" {
+#include "ir_decoder.h"
+#include "string.h"
+}
+
+using ShirokumaDecoder = ir::Decoder<ir::Shirokuma>;
+
+void ir_decoder_init(struct IrDecoder *decoder, ir_decoder_callback_t callback, void *user_data) {
+  memset(decoder, 0, sizeof(*decoder));
+  decoder->callback  = callback;
+  decoder->user_data = user_data;
+}
+
+bool ir_decoder_feed(struct IrDecoder *decoder, bool logic_level, uint32_t duration_us) {
+  // The receiver output is active low, it pulls the line down while it sees carrier
+  return ShirokumaDecoder::feed(*decoder, !logic_level, duration_us);
+}
+
+bool ir_decoder_poll(struct IrDecoder *decoder, uint8_t *frame) {
+  if (!decoder->frame_ready) {
+    return false;
+  }
+  memcpy(frame, decoder->last_frame, ir::Shirokuma::kFrameBytes);
+  decoder->frame_ready = false;
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef IR_DECODER_H
+#define IR_DECODER_H
+
+#include "cmd_gen.h"
+#include "stdbool.h"
+#include "stdint.h"
+
+// Longest frame any protocol in ir_protocol.hpp can have
+#define IR_DECODER_MAX_FRAME_BYTES COMMAND_BYTE_COUNT
+
+struct IrDecoderStats {
+  uint32_t frames;           // Complete frames decoded
+  uint32_t preamble_errors;  // Preamble started but a later stage was out of window
+  uint32_t mark_errors;      // Data mark out of window
+  uint32_t space_errors;     // Data space neither a zero nor a one
+  uint32_t parity_errors;    // Parity byte wasn't the inverse of its data byte
+};
+
+// Called from ir_decoder_feed() each time a frame completes. `frame` is only valid for the
+// duration of the call.
+typedef void (*ir_decoder_callback_t)(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                      void *user_data);
+
+// All decoder state lives here, so any number of decoders can run side by side. The protocol
+// logic is ir::Decoder in ir_protocol.hpp.
+struct IrDecoder {
+  uint8_t preamble_stage;
+  uint8_t byte_index;
+  uint8_t incoming_byte;
+  uint8_t incoming_bit;
+  bool    expecting_space;
+  bool    parity_byte;
+  bool    frame_ready;
+
+  uint8_t               frame[IR_DECODER_MAX_FRAME_BYTES];       // Frame being received
+  uint8_t               last_frame[IR_DECODER_MAX_FRAME_BYTES];  // Last complete frame
+  struct IrDecoderStats stats;
+
+  ir_decoder_callback_t callback;
+  void                 *user_data;
+};
+
+void ir_decoder_init(struct IrDecoder *decoder, ir_decoder_callback_t callback, void *user_data);
+
+// Feeds one receiver level run to the Shirokuma decoder. Returns true if it completed a frame. A
+// malformed frame is dropped and the decoder waits for the next preamble.
+bool ir_decoder_feed(struct IrDecoder *decoder, bool logic_level, uint32_t duration_us);
+
+// Copies out the last completed frame if it hasn't been polled yet
+bool ir_decoder_poll(struct IrDecoder *decoder, uint8_t *frame);
+
+#endif  // IR_DECODER_H
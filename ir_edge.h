@@ -0,0 +1,83 @@
+#ifndef IR_EDGE_H
+#define IR_EDGE_H
+
+#include "stdbool.h"
+#include "stdint.h"
+
+// Capture halfwords pushed by ir_recv.pio, one per level run:
+//   bit 0     - pin level during the run
+//   bits 15:1 - ticks left from the run limit when the run ended
+// A high run that used up the whole limit is the gap between frames. Its counter has wrapped, so
+// it's pushed as all ones, which no run that ended in time can be: those have at most the limit
+// left, and the run limit must be under 15 bits. At 2us per tick a run can be up to 65ms long.
+
+typedef uint16_t ir_edge_t;
+
+#define IR_EDGE_LEVEL_MASK     0x1
+#define IR_EDGE_REMAINING_MASK 0x7FFF
+#define IR_EDGE_MAX_TICKS      IR_EDGE_REMAINING_MASK
+#define IR_EDGE_FRAME_GAP      0xFFFF
+
+static inline bool ir_edge_level(ir_edge_t edge) { return edge & IR_EDGE_LEVEL_MASK; }
+
+static inline uint32_t ir_edge_ticks(ir_edge_t edge, uint32_t run_limit_ticks) {
+  uint32_t remaining = (edge >> 1) & IR_EDGE_REMAINING_MASK;
+  // A run that exhausted the limit, the gap or a low one, has a wrapped counter
+  return remaining > run_limit_ticks ? run_limit_ticks : run_limit_ticks - remaining;
+}
+
+static inline bool ir_edge_is_frame_gap(ir_edge_t edge) { return edge == IR_EDGE_FRAME_GAP; }
+
+// Streams runs straight out of a power of two ring of capture halfwords, without unpacking them
+// anywhere else first.
+//
+// The writer never waits for the reader, so the reader goes by how many halfwords have been
+// written in all rather than where the writer is in the ring. If the writer has lapped it, the
+// runs it hadn't read are gone and the frame they were part of can't be decoded. The reader
+// counts an overrun, skips to the newest run and drops runs until the next frame gap, which it
+// returns so the decoder discards what it had of the frame.
+struct IrEdgeReader {
+  const volatile ir_edge_t *ring;
+  uint32_t                  mask;  // Ring length minus one
+  uint32_t                  read;  // Halfwords read in all, wrapping like the writer's count
+  uint32_t                  run_limit_ticks;
+  uint32_t                  overruns;
+  bool                      resyncing;  // Dropping runs until a frame gap
+};
+
+static inline void ir_edge_reader_init(struct IrEdgeReader *reader, const volatile ir_edge_t *ring,
+                                       uint32_t length, uint32_t run_limit_ticks) {
+  reader->ring            = ring;
+  reader->mask            = length - 1;
+  reader->read            = 0;
+  reader->run_limit_ticks = run_limit_ticks;
+  reader->overruns        = 0;
+  reader->resyncing       = false;
+}
+
+// `written` is how many halfwords the writer has put in the ring since the reader started. Read
+// it again for each call, so a lap during a long batch is caught too. Returns false once the
+// reader has caught up.
+static inline bool ir_edge_next(struct IrEdgeReader *reader, uint32_t written, ir_edge_t *edge,
+                                uint32_t *ticks) {
+  while (reader->read != written) {
+    if (written - reader->read > reader->mask + 1) {
+      reader->overruns++;
+      reader->read      = written;
+      reader->resyncing = true;
+      return false;
+    }
+
+    *edge = reader->ring[reader->read & reader->mask];
+    reader->read++;
+    if (reader->resyncing && !ir_edge_is_frame_gap(*edge)) {
+      continue;
+    }
+    reader->resyncing = false;
+    *ticks            = ir_edge_ticks(*edge, reader->run_limit_ticks);
+    return true;
+  }
+  return false;
+}
+
+#endif  // IR_EDGE_H
@@ -0,0 +1,87 @@
+#include "ir_jitter.h"
+
+#include "FreeRTOS.h"
+#include "core_partition.h"
+#include "event_log.h"
+#include "ir_loopback.h"
+#include "ir_recv.h"
+#include "stdio.h"
+#include "string.h"
+#include "task.h"
+
+// Filled in by the receive path through the loopback observer while a run is going
+static struct IrJitterTiming ir_jitter_timings[IR_TIMING_KINDS];
+
+static void ir_jitter_observe(uint32_t symbol, bool mark, uint32_t sent_us,
+                              uint32_t received_us) {
+  struct IrJitterTiming *timing    = &ir_jitter_timings[ir_timeline_kind(symbol, mark, sent_us)];
+  int32_t                deviation = (int32_t)received_us - (int32_t)sent_us;
+
+  if (timing->samples == 0 || deviation < timing->min_us) {
+    timing->min_us = deviation;
+  }
+  if (timing->samples == 0 || deviation > timing->max_us) {
+    timing->max_us = deviation;
+  }
+  timing->samples++;
+}
+
+int32_t ir_jitter_run(uint emitter, uint frames, struct IrJitterReport *report) {
+  if (!ir_loopback_enabled(emitter) || frames == 0) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+
+  memset(report, 0, sizeof(*report));
+  report->frames      = frames;
+  report->partitioned = CORE_PARTITION;
+
+  memset(ir_jitter_timings, 0, sizeof(ir_jitter_timings));
+  ir_recv_clear_stats();
+
+  // The same frames as calibration
+  int32_t matched = ir_loopback_measure(emitter, frames, ir_jitter_observe);
+  int32_t err     = matched < 0 ? matched : PICO_ERROR_NONE;
+  report->matched = matched < 0 ? 0 : (uint32_t)matched;
+
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    struct IrJitterTiming *timing = &report->timings[kind];
+    *timing                       = ir_jitter_timings[kind];
+    uint32_t spread               = (uint32_t)(timing->max_us - timing->min_us);
+    if (timing->samples > 0 && spread > report->worst_us) {
+      report->worst_us = spread;
+    }
+  }
+
+  struct IrRecvStats recv;
+  ir_recv_stats(&recv);
+  report->wakeups     = recv.wakeups;
+  report->max_wake_us = recv.max_wake_us;
+
+  EVENT_LOG3(LOG_IR_JITTER, report->partitioned, report->worst_us, report->max_wake_us);
+  return err;
+}
+
+void ir_jitter_print(const struct IrJitterReport *report) {
+  printf("IR jitter, cores %s, %u frames, %u copies matched\n",
+         report->partitioned ? "partitioned" : "shared", report->frames, report->matched);
+  printf("%-16s %8s %8s %8s %8s\n", "", "samples", "min", "max", "spread");
+  for (uint kind = 0; kind < IR_TIMING_KINDS; kind++) {
+    const struct IrJitterTiming *timing = &report->timings[kind];
+    printf("%-16s %8u %8d %8d %8d\n", ir_timing_kind_names[kind], timing->samples,
+           timing->min_us, timing->max_us, timing->max_us - timing->min_us);
+  }
+  printf("Worst symbol jitter %u us, decode wake-up at most %u us in %u wake-ups\n",
+         report->worst_us, report->max_wake_us, report->wakeups);
+}
+
+void ir_jitter_task(void *params) {
+  uint emitter = (uint)(uintptr_t)params;
+
+  while (1) {
+    struct IrJitterReport report;
+    if (ir_jitter_run(emitter, IR_JITTER_FRAMES, &report) == PICO_ERROR_NONE) {
+      ir_jitter_print(&report);
+    }
+    vTaskDelay(pdMS_TO_TICKS(IR_JITTER_PERIOD_MS));
+  }
+}
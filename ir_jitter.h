@@ -0,0 +1,48 @@
+#ifndef IR_JITTER_H
+#define IR_JITTER_H
+
+#include "ir_timeline.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+
+// Worst case IR timing jitter, to compare the core partitioning modes (see core_partition.h)
+// while the network is loaded, for instance by iperf (see main.c). Sends test frames through the
+// loopback check (see ir_loopback.h) and keeps, for each kind of duration, the shortest and
+// longest of what the receiver saw against what was sent. Their spread is the symbol jitter.
+//
+// The PIO times every symbol on both sides, so most of that spread is the LED's and the
+// receiver's own. It only grows with CPU load if the DMA falls behind feeding the transmitter or
+// draining the receiver. What the CPU does delay is the receive path waking up after the PIO
+// interrupt, which is reported alongside (see ir_recv.h).
+
+#define IR_JITTER_FRAMES    32     // Per run
+#define IR_JITTER_PERIOD_MS 10000  // Between runs of ir_jitter_task
+
+// Received length minus sent
+struct IrJitterTiming {
+  uint32_t samples;
+  int32_t  min_us;
+  int32_t  max_us;
+};
+
+struct IrJitterReport {
+  uint32_t              frames;
+  bool                  partitioned;  // Built with CORE_PARTITION
+  uint32_t              matched;      // Copies the loopback check found identical
+  struct IrJitterTiming timings[IR_TIMING_KINDS];
+  uint32_t              worst_us;  // Widest spread of any kind
+  uint32_t              wakeups;
+  uint32_t              max_wake_us;  // PIO interrupt to the decode task running
+};
+
+// Measures `emitter`, which needs the loopback check enabled and ir_recv_task running. Takes
+// about as long as sending the frames with the loopback check. Clears the receive path's stats.
+int32_t ir_jitter_run(uint emitter, uint frames, struct IrJitterReport *report);
+
+void ir_jitter_print(const struct IrJitterReport *report);
+
+// Measures the emitter given as the parameter every IR_JITTER_PERIOD_MS, printing and logging
+// each report
+void ir_jitter_task(void *params);
+
+#endif  // IR_JITTER_H
@@ -0,0 +1,232 @@
+#include "ir_loopback.h"
+
+#include "event_log.h"
+#include "hardware/sync.h"
+#include "ir_decoder.h"
+#include "ir_send.h"
+#include "ir_timeline.h"
+#include "string.h"
+
+struct IrLoopbackCheck {
+  int          emitter;  // -1 while disabled
+  spin_lock_t *lock;     // Guards arming and judging, which happen on different cores
+
+  // Set by the sender before arming
+  uint8_t         frame[COMMAND_BYTE_COUNT];
+  const uint32_t *symbols;
+  uint32_t        count;
+  TaskHandle_t    task;
+
+  // Receive side, only touched while armed
+  struct IrDecoder decoder;
+  uint32_t         runs;  // Runs of this frame so far, 0 until its first mark
+  bool             decoded;
+  uint32_t         bit_errors;
+
+  volatile bool                  armed;
+  volatile bool                  judged;
+  volatile enum IrLoopbackResult result;
+
+  ir_loopback_observer_t observer;
+  struct IrLoopbackStats stats;
+};
+
+static struct IrLoopbackCheck ir_loopback = {.emitter = -1};
+
+static void ir_loopback_frame_decoded(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                      void *user_data) {
+  uint32_t bit_errors = 0;
+  for (uint i = 0; i < COMMAND_BYTE_COUNT; i++) {
+    bit_errors += __builtin_popcount(frame[i] ^ ir_loopback.frame[i]);
+  }
+  ir_loopback.decoded    = true;
+  ir_loopback.bit_errors = bit_errors;
+}
+
+void ir_loopback_enable(uint emitter) {
+  if (ir_loopback.lock == NULL) {
+    ir_loopback.lock = spin_lock_instance(spin_lock_claim_unused(true));
+  }
+  ir_loopback.emitter = (int)emitter;
+}
+
+bool ir_loopback_enabled(uint emitter) { return ir_loopback.emitter == (int)emitter; }
+
+void ir_loopback_stats(struct IrLoopbackStats *stats) { *stats = ir_loopback.stats; }
+
+/////////////////
+// Sender side //
+/////////////////
+
+void ir_loopback_expect(const uint8_t *frame, const uint32_t *symbols, uint32_t count) {
+  memcpy(ir_loopback.frame, frame, COMMAND_BYTE_COUNT);
+  ir_loopback.symbols = symbols;
+  ir_loopback.count   = count;
+  ir_loopback.task    = xTaskGetCurrentTaskHandle();
+
+  // A verdict that came in after its wait saw the flag is still pending
+  ulTaskNotifyTakeIndexed(IR_LOOPBACK_NOTIFY_INDEX, pdTRUE, 0);
+
+  ir_decoder_init(&ir_loopback.decoder, ir_loopback_frame_decoded, NULL);
+  ir_loopback.runs       = 0;
+  ir_loopback.decoded    = false;
+  ir_loopback.bit_errors = 0;
+
+  uint32_t saved_irq = spin_lock_blocking(ir_loopback.lock);
+  ir_loopback.judged = false;
+  __dmb();
+  ir_loopback.armed = true;
+  spin_unlock(ir_loopback.lock, saved_irq);
+}
+
+// Called with the lock held, by whichever side gets there first
+static void ir_loopback_judge(enum IrLoopbackResult result) {
+  struct IrLoopbackStats *stats = &ir_loopback.stats;
+  stats->frames++;
+  switch (result) {
+    case IR_LOOPBACK_MATCH:
+      stats->matched++;
+      break;
+    case IR_LOOPBACK_MISMATCH:
+      stats->mismatched++;
+      stats->bit_errors += ir_loopback.bit_errors;
+      break;
+    case IR_LOOPBACK_MISSING:
+      stats->missing++;
+      break;
+  }
+
+  ir_loopback.result = result;
+  ir_loopback.armed  = false;
+  __dmb();
+  ir_loopback.judged = true;
+}
+
+static uint32_t ir_loopback_airtime_us() {
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < ir_loopback.count; i++) {
+    total += ir_timeline_mark_us(ir_loopback.symbols[i]) +
+             ir_timeline_space_us(ir_loopback.symbols[i]);
+  }
+  return total;
+}
+
+enum IrLoopbackResult ir_loopback_wait() {
+  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ir_loopback_airtime_us() / 1000 +
+                                                            IR_LOOPBACK_SETTLE_MS);
+
+  int32_t remaining;
+  while (!ir_loopback.judged &&
+         (remaining = (int32_t)(deadline - xTaskGetTickCount())) > 0) {
+    ulTaskNotifyTakeIndexed(IR_LOOPBACK_NOTIFY_INDEX, pdTRUE, (TickType_t)remaining);
+  }
+
+  uint32_t saved_irq = spin_lock_blocking(ir_loopback.lock);
+  if (!ir_loopback.judged) {
+    ir_loopback_judge(IR_LOOPBACK_MISSING);
+  }
+  spin_unlock(ir_loopback.lock, saved_irq);
+
+  enum IrLoopbackResult result = ir_loopback.result;
+  if (result != IR_LOOPBACK_MATCH) {
+    EVENT_LOG3(LOG_IR_LOOPBACK_FAILED, result, ir_loopback.bit_errors,
+               ir_loopback.decoder.stats.preamble_errors + ir_loopback.decoder.stats.mark_errors +
+                   ir_loopback.decoder.stats.space_errors +
+                   ir_loopback.decoder.stats.parity_errors);
+  }
+  return result;
+}
+
+void ir_loopback_retransmitted() { ir_loopback.stats.retransmissions++; }
+
+void ir_loopback_failed() { ir_loopback.stats.failures++; }
+
+int32_t ir_loopback_measure(uint emitter, uint frames, ir_loopback_observer_t observer) {
+  struct AirconFrame frame;
+  struct IrTimeline  timeline;
+  aircon_frame_encode(&frame, AC_UPDATE_AIRCON_MODE, IR_LOOPBACK_MEASURE_MODE, AC_FAN_AUTO,
+                      IR_LOOPBACK_MEASURE_TEMPERATURE, 0, 0);
+  ir_timeline_encode(&frame, &timeline);
+
+  ir_loopback.observer = observer;
+
+  int32_t matched = 0;
+  int32_t err     = PICO_ERROR_NONE;
+  for (uint i = 0; i < frames && err == PICO_ERROR_NONE; i++) {
+    ir_loopback_expect(frame.bytes, timeline.symbols, timeline.count);
+    err = ir_send_symbols(emitter, timeline.symbols, timeline.count);
+    if (err == PICO_ERROR_NONE) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      matched += ir_loopback_wait() == IR_LOOPBACK_MATCH;
+    }
+  }
+
+  ir_loopback.observer = NULL;
+  return err ? err : matched;
+}
+
+//////////////////
+// Receive side //
+//////////////////
+
+static void ir_loopback_deviation(struct IrTimingDeviation *deviation, int32_t us) {
+  if (deviation->count == 0 || us < deviation->min_us) {
+    deviation->min_us = us;
+  }
+  if (deviation->count == 0 || us > deviation->max_us) {
+    deviation->max_us = us;
+  }
+  deviation->sum_us += us;
+  deviation->count++;
+}
+
+void ir_loopback_feed(bool level, uint32_t duration_us) {
+  if (!ir_loopback.armed) {
+    return;
+  }
+  // Idle line before the frame
+  if (ir_loopback.runs == 0 && level) {
+    return;
+  }
+
+  // Runs alternate mark and space from the first mark, so run n is half of symbol n / 2. The
+  // final space runs into the gap after the frame, so it has no length to compare.
+  uint32_t symbol = ir_loopback.runs / 2;
+  bool     mark   = !level;
+  if (symbol < ir_loopback.count && mark == (ir_loopback.runs % 2 == 0) &&
+      !(symbol == ir_loopback.count - 1 && !mark)) {
+    uint32_t sent = mark ? ir_timeline_mark_us(ir_loopback.symbols[symbol]) :
+                           ir_timeline_space_us(ir_loopback.symbols[symbol]);
+    ir_loopback_deviation(mark ? &ir_loopback.stats.mark : &ir_loopback.stats.space,
+                          (int32_t)duration_us - (int32_t)sent);
+    if (ir_loopback.observer != NULL) {
+      ir_loopback.observer(symbol, mark, sent, duration_us);
+    }
+  }
+  ir_loopback.runs++;
+
+  ir_decoder_feed(&ir_loopback.decoder, level, duration_us);
+}
+
+void ir_loopback_frame_end() {
+  if (!ir_loopback.armed || ir_loopback.runs == 0) {
+    return;  // Not checking, or a gap before our frame started
+  }
+
+  enum IrLoopbackResult result = !ir_loopback.decoded         ? IR_LOOPBACK_MISSING :
+                                 ir_loopback.bit_errors > 0 ? IR_LOOPBACK_MISMATCH :
+                                                              IR_LOOPBACK_MATCH;
+
+  TaskHandle_t task      = NULL;
+  uint32_t     saved_irq = spin_lock_blocking(ir_loopback.lock);
+  // The sender may have given up on this frame already
+  if (ir_loopback.armed) {
+    ir_loopback_judge(result);
+    task = ir_loopback.task;
+  }
+  spin_unlock(ir_loopback.lock, saved_irq);
+
+  if (task != NULL) {
+    xTaskNotifyGiveIndexed(task, IR_LOOPBACK_NOTIFY_INDEX);
+  }
+}
@@ -0,0 +1,98 @@
+#ifndef IR_LOOPBACK_H
+#define IR_LOOPBACK_H
+
+#include "FreeRTOS.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+#include "task.h"
+
+// Optional self check of our own transmissions. The receiver on GPIO 15 sits next to the emitter
+// on GPIO 16 and sees every frame it sends. While a check is armed the receive path decodes that
+// copy on its own core, compares it bit for bit with the frame that was sent and measures each
+// mark and space against the transmitted timeline. The sender waits for the verdict and only
+// sends the frame again if the copy didn't match, see send_aircon_command_blocking().
+
+#define IR_LOOPBACK_MAX_ATTEMPTS 3  // Including the first transmission
+// Allowed on top of the frame's own length for the receiver to see the gap after it and decode
+#define IR_LOOPBACK_SETTLE_MS 100
+// The verdict comes on a task notification index of its own, so waiting for it neither takes nor
+// clears the sender's other notifications, such as the transmitter's on the default index
+#define IR_LOOPBACK_NOTIFY_INDEX 1
+
+enum IrLoopbackResult {
+  IR_LOOPBACK_MATCH,
+  IR_LOOPBACK_MISMATCH,  // Decoded, but with different bits
+  IR_LOOPBACK_MISSING,   // The decoder rejected the copy, or nothing arrived in time
+};
+
+// Receiver run length minus the transmitted one
+struct IrTimingDeviation {
+  uint32_t count;
+  int32_t  min_us;
+  int32_t  max_us;
+  int64_t  sum_us;
+};
+
+struct IrLoopbackStats {
+  uint32_t frames;           // Transmissions checked
+  uint32_t matched;          // Copies identical to the frame sent
+  uint32_t mismatched;       // Copies decoded with different bits
+  uint32_t missing;          // Copies the decoder rejected or that never arrived
+  uint32_t bit_errors;       // Differing bits over all mismatched copies
+  uint32_t retransmissions;  // Frames sent again after a failed check
+  uint32_t failures;         // Frames still wrong after the last attempt
+  struct IrTimingDeviation mark;
+  struct IrTimingDeviation space;
+};
+
+// Sees every run the checker matched to a transmitted mark or space: the symbol's index in the
+// timeline, which half of it, and its length as sent and as received. Runs on the receive path.
+typedef void (*ir_loopback_observer_t)(uint32_t symbol, bool mark, uint32_t sent_us,
+                                       uint32_t received_us);
+
+// The frame ir_loopback_measure() sends: an ordinary one, with both bit values in the usual
+// proportions
+#define IR_LOOPBACK_MEASURE_MODE        AC_MODE_OFF
+#define IR_LOOPBACK_MEASURE_TEMPERATURE 25
+
+// Checks frames sent on `emitter`, which must be the one the receiver can see. Without this no
+// frame is checked and sends don't wait for the receiver.
+void ir_loopback_enable(uint emitter);
+bool ir_loopback_enabled(uint emitter);
+
+// Counters are updated by the receive path and the sender, individually consistent
+void ir_loopback_stats(struct IrLoopbackStats *stats);
+
+/////////////////
+// Sender side //
+/////////////////
+
+// Arms a check for a frame about to be sent. Both buffers must stay valid until the check ends.
+void ir_loopback_expect(const uint8_t *frame, const uint32_t *symbols, uint32_t count);
+
+// Blocks until the receive path has judged the armed frame, or the frame plus
+// IR_LOOPBACK_SETTLE_MS has passed since the call. Call it as soon as the frame has been handed
+// to the transmitter.
+enum IrLoopbackResult ir_loopback_wait();
+
+// Counts a frame sent again after a failed check, or given up on
+void ir_loopback_retransmitted();
+void ir_loopback_failed();
+
+// For timing measurements, see ir_calibration.h and ir_jitter.h. Sends the test frame `frames`
+// times on `emitter` with the current trim, waiting for each verdict, while `observer` sees every
+// run. A copy the decoder rejects still has its timing measured, so a failed check doesn't end
+// the run. Returns how many copies matched, or the transmitter's error.
+int32_t ir_loopback_measure(uint emitter, uint frames, ir_loopback_observer_t observer);
+
+//////////////////
+// Receive side //
+//////////////////
+
+// Every level run the receiver captured, in order, as its output level (low during a mark)
+void ir_loopback_feed(bool level, uint32_t duration_us);
+
+// The line has been idle long enough to end a frame. Ends the armed check if a frame started.
+void ir_loopback_frame_end();
+
+#endif  // IR_LOOPBACK_H
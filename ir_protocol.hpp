@@ -0,0 +1,255 @@
+#ifndef IR_PROTOCOL_HPP
+#define IR_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+extern "C" {
+#include "ir_decoder.h"
+#include "ir_timeline.h"
+}
+
+// Pulse distance IR protocols described at compile time. A protocol is a type with these
+// static constexpr members:
+//   kCarrierHz      carrier frequency
+//   kLeader         Stage array sent before the data, alternating mark and space from a mark
+//   kBitMark        the mark in front of every bit
+//   kZeroSpace      the space that makes a bit a zero
+//   kOneSpace       the space that makes a bit a one
+//   kTrailerSpace   the space after the closing mark that ends the last bit
+//   kBitOrder       order of the bits within a byte
+//   kFrameBytes     bytes per frame
+//   kPairedFrom     first byte of the complement pairs, each data byte followed by its inverse.
+//                   kFrameBytes for a protocol without them.
+// Encoder<P> and Decoder<P> are specialised from it, so every window and length is an immediate
+// and adding a protocol adds no lookups at run time.
+
+namespace ir {
+
+enum class BitOrder { kLsbFirst, kMsbFirst };
+
+// What the encoder sends, and the range the decoder accepts
+struct Timing {
+  uint32_t us;
+  uint32_t min_us;
+  uint32_t max_us;
+
+  constexpr bool accepts(uint32_t duration_us) const {
+    return duration_us >= min_us && duration_us <= max_us;
+  }
+};
+
+struct Stage {
+  bool   mark;
+  Timing timing;
+};
+
+///////////////
+// Protocols //
+///////////////
+
+// Hitachi Shirokuma-kun aircon remote
+struct Shirokuma {
+  static constexpr uint32_t kCarrierHz = 38000;
+
+  static constexpr Stage kLeader[] = {
+      {true, {30000, 28000, 31000}},
+      {false, {49500, 48000, 51000}},
+      {true, {3380, 3300, 3500}},  // Sync
+      {false, {1700, 1600, 1800}},
+  };
+
+  static constexpr Timing kBitMark      = {410, 400, 470};
+  static constexpr Timing kZeroSpace    = {422, 390, 450};
+  static constexpr Timing kOneSpace     = {1256, 1230, 1290};
+  static constexpr Timing kTrailerSpace = {65000, 0, 0};  // Keeps back-to-back frames apart
+
+  static constexpr BitOrder kBitOrder   = BitOrder::kLsbFirst;
+  static constexpr size_t   kFrameBytes = COMMAND_BYTE_COUNT;
+  static constexpr size_t   kPairedFrom = 3;  // After the preamble bytes
+};
+
+/////////////
+// Encoder //
+/////////////
+
+// Produces the packed mark/space symbols ir_send.pio pulls from its FIFO, see ir_timeline.h
+template <typename P>
+struct Encoder {
+  static_assert(P::kCarrierHz == IR_CARRIER_HZ, "ir_send.pio is clocked for one carrier");
+  static_assert(std::size(P::kLeader) % 2 == 0, "The leader must be whole mark/space symbols");
+  static_assert(P::kFrameBytes <= IR_DECODER_MAX_FRAME_BYTES, "Frame too long");
+
+  static constexpr size_t kLeaderSymbols = std::size(P::kLeader) / 2;
+  // Leader, one symbol per bit and the closing mark
+  static constexpr size_t kSymbolCount = kLeaderSymbols + 8 * P::kFrameBytes + 1;
+
+  static constexpr uint32_t symbol(uint32_t mark_us, uint32_t space_us) {
+    return IR_TIMELINE_SYMBOL(mark_us, space_us);
+  }
+
+  static constexpr bool leader_alternates() {
+    for (size_t i = 0; i < std::size(P::kLeader); i++) {
+      if (P::kLeader[i].mark != (i % 2 == 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(leader_alternates(), "The leader must alternate mark and space from a mark");
+
+  // Signed corrections added to each transmitted duration, see ir_calibration.h. Zero sends the
+  // protocol's own timings.
+  struct Trim {
+    int32_t leader_us[std::size(P::kLeader)];
+    int32_t bit_mark_us;
+    int32_t zero_space_us;
+    int32_t one_space_us;
+  };
+
+  static constexpr uint32_t trimmed(uint32_t us, int32_t trim_us) {
+    return trim_us < 0 && (uint32_t)-trim_us >= us ? 1 : (uint32_t)((int32_t)us + trim_us);
+  }
+
+  // Writes kSymbolCount symbols. constexpr, so frames known at build time encode to constants.
+  static constexpr size_t encode(const uint8_t *bytes, uint32_t *symbols, const Trim &trim = {}) {
+    const uint32_t bit_mark = trimmed(P::kBitMark.us, trim.bit_mark_us);
+    const uint32_t zero     = symbol(bit_mark, trimmed(P::kZeroSpace.us, trim.zero_space_us));
+    const uint32_t one      = symbol(bit_mark, trimmed(P::kOneSpace.us, trim.one_space_us));
+
+    size_t n = 0;
+    for (size_t i = 0; i < kLeaderSymbols; i++) {
+      symbols[n++] = symbol(trimmed(P::kLeader[2 * i].timing.us, trim.leader_us[2 * i]),
+                            trimmed(P::kLeader[2 * i + 1].timing.us, trim.leader_us[2 * i + 1]));
+    }
+
+    // Selecting with a mask keeps the inner loop branch free
+    for (size_t i = 0; i < P::kFrameBytes; i++) {
+      uint32_t byte = bytes[i];
+      for (int bit = 0; bit < 8; bit++) {
+        uint32_t value = P::kBitOrder == BitOrder::kLsbFirst ? (byte >> bit) & 0x01 :
+                                                               (byte >> (7 - bit)) & 0x01;
+        symbols[n++] = zero ^ ((zero ^ one) & -value);
+      }
+    }
+
+    // The last bit finishes on a pause, so a closing pulse is needed to mark its end
+    symbols[n++] = symbol(bit_mark, P::kTrailerSpace.us);
+    return n;
+  }
+};
+
+/////////////
+// Decoder //
+/////////////
+
+// Runs on the state in struct IrDecoder, so the C API and the trace replay keep working whatever
+// the protocol
+template <typename P>
+struct Decoder {
+  static_assert(P::kFrameBytes <= IR_DECODER_MAX_FRAME_BYTES, "Frame too long");
+
+  static void reset(IrDecoder &decoder) {
+    decoder.preamble_stage  = 0;
+    decoder.byte_index      = 0;
+    decoder.incoming_byte   = 0;
+    decoder.incoming_bit    = 0;
+    decoder.expecting_space = false;
+    decoder.parity_byte     = false;
+  }
+
+  // Feeds one mark or space. Returns true if it completed a frame. A malformed frame is dropped
+  // and the decoder waits for the next leader.
+  static bool feed(IrDecoder &decoder, bool mark, uint32_t duration_us) {
+    if (leader(decoder, mark, duration_us)) {
+      return false;
+    }
+
+    if (!decoder.expecting_space) {
+      // The bit mark is always the same length
+      if (!mark || !P::kBitMark.accepts(duration_us)) {
+        drop_frame(decoder, &decoder.stats.mark_errors, mark, duration_us);
+        return false;
+      }
+      decoder.expecting_space = true;
+      return false;
+    }
+
+    // The space length gives the bit
+    bool one = !mark && P::kOneSpace.accepts(duration_us);
+    if (!one && (mark || !P::kZeroSpace.accepts(duration_us))) {
+      drop_frame(decoder, &decoder.stats.space_errors, mark, duration_us);
+      return false;
+    }
+    decoder.expecting_space = false;
+
+    uint8_t bit = P::kBitOrder == BitOrder::kLsbFirst ? decoder.incoming_bit :
+                                                        7 - decoder.incoming_bit;
+    decoder.incoming_byte |= one << bit;
+    if (++decoder.incoming_bit < 8) {
+      return false;
+    }
+
+    uint8_t byte          = decoder.incoming_byte;
+    decoder.incoming_byte = 0;
+    decoder.incoming_bit  = 0;
+
+    if (decoder.byte_index >= P::kPairedFrom) {
+      if (decoder.parity_byte && decoder.frame[decoder.byte_index - 1] != (uint8_t)~byte) {
+        decoder.stats.parity_errors++;
+        reset(decoder);
+        return false;
+      }
+      decoder.parity_byte = !decoder.parity_byte;
+    }
+    decoder.frame[decoder.byte_index++] = byte;
+
+    if (decoder.byte_index < P::kFrameBytes) {
+      return false;
+    }
+
+    for (size_t i = 0; i < P::kFrameBytes; i++) {
+      decoder.last_frame[i] = decoder.frame[i];
+    }
+    decoder.stats.frames++;
+    decoder.frame_ready = true;
+    if (decoder.callback != nullptr) {
+      decoder.callback(decoder.last_frame, &decoder.stats, decoder.user_data);
+    }
+    reset(decoder);
+    return true;
+  }
+
+ private:
+  // Returns true if the symbol was consumed by the leader stages
+  static bool leader(IrDecoder &decoder, bool mark, uint32_t duration_us) {
+    if (decoder.preamble_stage >= std::size(P::kLeader)) {
+      return false;  // Leader done, this is data
+    }
+
+    const Stage &stage = P::kLeader[decoder.preamble_stage];
+    if (stage.mark == mark && stage.timing.accepts(duration_us)) {
+      decoder.preamble_stage++;
+      return true;
+    }
+    if (decoder.preamble_stage == 0) {
+      return true;  // Anything other than the leading mark is idle time or noise between frames
+    }
+
+    decoder.stats.preamble_errors++;
+    reset(decoder);
+    // The symbol that broke this leader may be the start of the next one
+    return leader(decoder, mark, duration_us);
+  }
+
+  static void drop_frame(IrDecoder &decoder, uint32_t *counter, bool mark, uint32_t duration_us) {
+    (*counter)++;
+    reset(decoder);
+    leader(decoder, mark, duration_us);
+  }
+};
+
+}  // namespace ir
+
+#endif  // IR_PROTOCOL_HPP
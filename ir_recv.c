@@ -2,17 +2,160 @@
 
 #include "FreeRTOS.h"
 #include "cmd_gen.h"
+#include "core_partition.h"
+#include "event_log.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "ir_decoder.h"
+#include "ir_edge.h"
+#include "ir_loopback.h"
+#include "ir_recv.pio.h"
+#include "ir_trace.h"
+#include "perf_trace.h"
+#include "string.h"
 #include "task.h"
 
 #define GPIO_IR_RECV_PIN 15
 
-static uint32_t durations[1000] = {0};
-static bool     value[1000]     = {0};
+// 2us resolution is well inside the decoder's windows and lets a run fit in a capture halfword
+#define IR_RECV_US_PER_TICK 2
+#define IR_RECV_TICK_HZ     (1000000 / IR_RECV_US_PER_TICK)
+// Longest high run inside a frame is the 49.5ms preamble space. Anything longer ends the frame.
+#define IR_RECV_FRAME_GAP_US    55000
+#define IR_RECV_FRAME_GAP_TICKS (IR_RECV_FRAME_GAP_US / IR_RECV_US_PER_TICK)
+_Static_assert(IR_RECV_FRAME_GAP_TICKS < IR_EDGE_MAX_TICKS, "Frame gap doesn't fit a capture");
+
+// A full frame is ~860 runs. The ring must hold all of them since the decoder only runs per frame.
+// At two bytes per run that's 2KB, half what 32 bit capture words needed.
+#define IR_RECV_RING_BITS  11
+#define IR_RECV_RING_EDGES ((1 << IR_RECV_RING_BITS) / sizeof(ir_edge_t))
+
+static ir_edge_t ir_recv_ring[IR_RECV_RING_EDGES] __attribute__((aligned(1 << IR_RECV_RING_BITS)));
+
+// Halfwords each DMA channel writes before handing over to the other. Two passes are 2^32, the
+// range of the written count, and each is a whole number of laps of the ring.
+#define IR_RECV_DMA_PASS (1u << 31)
+_Static_assert(IR_RECV_DMA_PASS % IR_RECV_RING_EDGES == 0, "A pass must end where the ring starts");
+
+static PIO          ir_recv_pio;
+static uint         ir_recv_sm;
+static int          ir_recv_dma_chans[2] = {-1, -1};
+static uint         ir_recv_irq;
+static TaskHandle_t ir_recv_decode_task;
+
+static struct IrRecvStats ir_recv_counters;
+// The first interrupt since the decode task last ran
+static volatile uint32_t ir_recv_irq_us;
+static volatile bool     ir_recv_irq_pending;
+
+static struct IrDecoder    ir_recv_decoder;
+static struct IrEdgeReader ir_recv_reader;
+
+#if IR_RECV_TRACE
+// Raw captures for the trace corpus, printed each time the line goes idle after a frame
+#define IR_RECV_TRACE_RUNS 1024
+
+static uint32_t               ir_recv_trace_runs[IR_RECV_TRACE_RUNS];
+static struct IrTraceRecorder ir_recv_trace;
+
+static void ir_recv_trace_feed(ir_edge_t edge, bool level, uint32_t ticks) {
+  if (ir_recv_trace.count == 0) {
+    ir_trace_recorder_start(&ir_recv_trace, time_us_32());
+  }
+  ir_trace_record(&ir_recv_trace, level, ticks);
+
+  if (ir_edge_is_frame_gap(edge)) {
+    ir_trace_print(&ir_recv_trace, IR_RECV_TICK_HZ);
+    ir_trace_recorder_start(&ir_recv_trace, 0);
+  }
+}
+#else
+static inline void ir_recv_trace_feed(ir_edge_t edge, bool level, uint32_t ticks) {}
+#endif
+
+static void __isr ir_recv_pio_irq_handler() {
+  if (!pio_interrupt_get(ir_recv_pio, ir_recv_sm)) {
+    return;
+  }
+  pio_interrupt_clear(ir_recv_pio, ir_recv_sm);
+  if (!ir_recv_irq_pending) {
+    ir_recv_irq_us      = time_us_32();
+    ir_recv_irq_pending = true;
+  }
+
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  vTaskNotifyGiveFromISR(ir_recv_decode_task, &higher_priority_task_woken);
+  portYIELD_FROM_ISR(higher_priority_task_woken);
+}
 
 static void ir_recv_init() {
-  gpio_init(GPIO_IR_RECV_PIN);
-  gpio_pull_up(GPIO_IR_RECV_PIN);
+  ir_recv_decode_task = xTaskGetCurrentTaskHandle();
+
+  uint offset;
+  bool claimed = pio_claim_free_sm_and_add_program_for_gpio_range(
+      &ir_recv_program, &ir_recv_pio, &ir_recv_sm, &offset, GPIO_IR_RECV_PIN, 1, true);
+  hard_assert(claimed);
+
+  // Two DMA channels take turns draining the RX FIFO into the ring, wrapping on the address bits.
+  // Each is chained to the other, so the hardware triggers one as the other's count runs out and
+  // the FIFO is never left without a reader. A pass ends at the start of the ring, which is where
+  // the other channel's write address was left too. The halfword reads take the capture from the
+  // low half of each FIFO entry.
+  ir_recv_dma_chans[0] = dma_claim_unused_channel(true);
+  ir_recv_dma_chans[1] = dma_claim_unused_channel(true);
+  for (uint i = 0; i < 2; i++) {
+    dma_channel_config conf = dma_channel_get_default_config(ir_recv_dma_chans[i]);
+    channel_config_set_transfer_data_size(&conf, DMA_SIZE_16);
+    channel_config_set_read_increment(&conf, false);
+    channel_config_set_write_increment(&conf, true);
+    channel_config_set_ring(&conf, true, IR_RECV_RING_BITS);
+    channel_config_set_dreq(&conf, pio_get_dreq(ir_recv_pio, ir_recv_sm, false));
+    channel_config_set_chain_to(&conf, ir_recv_dma_chans[1 - i]);
+    dma_channel_configure(ir_recv_dma_chans[i], &conf, ir_recv_ring,
+                          &ir_recv_pio->rxf[ir_recv_sm], IR_RECV_DMA_PASS, i == 0);
+  }
+
+  ir_recv_irq = pio_get_index(ir_recv_pio) == 0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
+  irq_add_shared_handler(ir_recv_irq, ir_recv_pio_irq_handler,
+                         PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  pio_set_irq0_source_enabled(ir_recv_pio, pis_interrupt0 + ir_recv_sm, true);
+  core_partition_enable_irq(ir_recv_irq, CORE_ROLE_IR);
+
+  ir_recv_program_init(ir_recv_pio, ir_recv_sm, offset, GPIO_IR_RECV_PIN, IR_RECV_TICK_HZ,
+                       IR_RECV_FRAME_GAP_TICKS);
+}
+
+// Halfwords the DMA has written since it started, modulo 2^32 like the edge reader's count. The
+// first channel's pass covers the first half of that range and the second's the other, so the
+// running channel and its count say where in it the DMA is. Between passes, for the couple of
+// cycles the chain takes, neither channel is busy, so look again.
+static uint32_t ir_recv_written() {
+  while (1) {
+    for (uint i = 0; i < 2; i++) {
+      if (dma_channel_is_busy(ir_recv_dma_chans[i])) {
+        // A pass that ends between the two reads leaves a count of 0, the end of that pass
+        uint32_t remaining = dma_channel_hw_addr(ir_recv_dma_chans[i])->transfer_count;
+        return (i + 1) * IR_RECV_DMA_PASS - remaining;
+      }
+    }
+  }
+}
+
+void ir_recv_stats(struct IrRecvStats *stats) { *stats = ir_recv_counters; }
+
+void ir_recv_clear_stats() { memset(&ir_recv_counters, 0, sizeof(ir_recv_counters)); }
+
+static void ir_recv_count_wakeup() {
+  uint32_t wake_us    = time_us_32() - ir_recv_irq_us;
+  ir_recv_irq_pending = false;
+
+  ir_recv_counters.wakeups++;
+  ir_recv_counters.last_wake_us = wake_us;
+  if (wake_us > ir_recv_counters.max_wake_us) {
+    ir_recv_counters.max_wake_us = wake_us;
+  }
 }
 
 void decompose_test_task(void *params) {
@@ -24,32 +167,51 @@ void decompose_test_task(void *params) {
   while (1);
 }
 
-void ir_recv_task(void *params) {
-  ir_recv_init();
+static void ir_recv_frame_received(const uint8_t *frame, const struct IrDecoderStats *stats,
+                                   void *user_data) {
+  struct AirconState state;
+  uint32_t           violations = aircon_frame_decode((const struct AirconFrame *)frame, &state);
 
-  bool     last_state = true;
-  uint32_t ticks      = time_us_32();
+  uint32_t packed = (uint32_t)state.mode << 28 | (uint32_t)state.fan_speed << 24 |
+                    (uint32_t)state.temperature << 16 | violations;
+  PERF_TRACE_INSTANT(PERF_TRACE_IR_FRAME, stats->frames);
+  EVENT_LOG3(LOG_IR_RECV_FRAME, stats->frames, state.update_type, packed);
+  EVENT_LOG3(LOG_IR_RECV_ERRORS, stats->preamble_errors, stats->mark_errors,
+             stats->space_errors + stats->parity_errors);
+}
 
-  uint32_t index = 0;
+void ir_recv_task(void *params) {
+  ir_recv_init();
+  ir_decoder_init(&ir_recv_decoder, ir_recv_frame_received, NULL);
+#if IR_RECV_TRACE
+  ir_trace_recorder_init(&ir_recv_trace, ir_recv_trace_runs, IR_RECV_TRACE_RUNS);
+#endif
+  ir_edge_reader_init(&ir_recv_reader, ir_recv_ring, IR_RECV_RING_EDGES, IR_RECV_FRAME_GAP_TICKS);
 
   while (1) {
-    bool     state = gpio_get_all() & (1 << GPIO_IR_RECV_PIN);
-    uint32_t diff  = time_us_32() - ticks;
-    if (state != last_state) {
-      durations[index] = diff;
-      value[index]     = last_state;
-      ticks            = time_us_32();
-      // printf("State update %u %u\n", state, diff);
-      // printf("State update %u\n", state);
-      last_state = state;
-      index++;
-    }
+    // Woken by the PIO once the line has been idle long enough to end a frame
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    ir_recv_count_wakeup();
 
-    if (diff > 5000 && index > 5) {
-      for (uint32_t i = 0; i < index; i++) {
-        decompose_input(value[i], durations[i]);
+    PERF_TRACE_SPAN_BEGIN(PERF_TRACE_IR_DECODE, 0);
+    uint32_t  overruns = ir_recv_reader.overruns;
+    ir_edge_t edge;
+    uint32_t  ticks;
+    while (ir_edge_next(&ir_recv_reader, ir_recv_written(), &edge, &ticks)) {
+      bool level = ir_edge_level(edge);
+      ir_recv_trace_feed(edge, level, ticks);
+      ir_decoder_feed(&ir_recv_decoder, level, ticks * IR_RECV_US_PER_TICK);
+
+      // Our own transmissions are checked here, on this task's core, see ir_loopback.h
+      ir_loopback_feed(level, ticks * IR_RECV_US_PER_TICK);
+      if (ir_edge_is_frame_gap(edge)) {
+        ir_loopback_frame_end();
       }
-      index = 0;
     }
+    if (ir_recv_reader.overruns != overruns) {
+      ir_recv_counters.overruns += ir_recv_reader.overruns - overruns;
+      EVENT_LOG1(LOG_IR_RECV_OVERRUN, ir_recv_reader.overruns);
+    }
+    PERF_TRACE_SPAN_END(PERF_TRACE_IR_DECODE, 0);
   }
 }
\ No newline at end of file
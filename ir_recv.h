@@ -1,6 +1,22 @@
 #ifndef IR_RECV
 #define IR_RECV
 
+#include "stdint.h"
+
+struct IrRecvStats {
+  uint32_t wakeups;  // Times the PIO woke the decode task at the end of a frame
+  // From the PIO interrupt to the decode task running, the part of the receive path that
+  // interrupts and tasks on the same core can delay
+  uint32_t last_wake_us;
+  uint32_t max_wake_us;
+  uint32_t overruns;  // Times the DMA lapped the decode task in the ring, each losing a frame
+};
+
+// Counters are updated by the decode task only, individually consistent
+void ir_recv_stats(struct IrRecvStats *stats);
+// Starts a new measurement, see ir_jitter.h
+void ir_recv_clear_stats();
+
 void ir_recv_task(void *params);
 void decompose_test_task(void *params);
 
@@ -1,118 +1,192 @@
 #include "ir_send.h"
 
 #include "FreeRTOS.h"
-#include "cmd_gen.h"
+#include "aircon_presets.h"
+#include "core_partition.h"
+#include "event_log.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
-#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "ir_loopback.h"
+#include "ir_send.pio.h"
+#include "ir_timeline.h"
+#include "perf_trace.h"
 #include "task.h"
 
-#define GPIO_IR_SEND_PIN 16
+struct IrEmitter {
+  uint         pin;
+  PIO          pio;
+  uint         sm;
+  int          dma_chan;
+  TaskHandle_t waiting_task;
+
+  // Frames that aren't presets are encoded here
+  struct AirconFrame frame;
+  struct IrTimeline  timeline;
+};
+
+static struct IrEmitter ir_send_emitters[IR_SEND_MAX_EMITTERS];
+static uint             ir_send_emitter_total;
+
+// Shared by every emitter's channel
+static void __isr ir_send_dma_irq_handler() {
+  BaseType_t higher_priority_task_woken = pdFALSE;
+
+  for (uint i = 0; i < ir_send_emitter_total; i++) {
+    struct IrEmitter *emitter = &ir_send_emitters[i];
+    if (!dma_channel_get_irq1_status(emitter->dma_chan)) {
+      continue;
+    }
+    dma_channel_acknowledge_irq1(emitter->dma_chan);
+    // The last symbol is in the FIFO, the PIO takes one more symbol's time to send it
+    PERF_TRACE_SPAN_END(PERF_TRACE_IR_SEND, i);
 
-#define PWM_IR_SEND_WRAP  ((uint16_t)(125e9 / 38e6) - 1)
-#define PWM_IR_SEND_LEVEL ((uint16_t)(PWM_IR_SEND_WRAP * 0.3))
+    if (emitter->waiting_task != NULL) {
+      vTaskNotifyGiveFromISR(emitter->waiting_task, &higher_priority_task_woken);
+      emitter->waiting_task = NULL;
+    }
+  }
 
-static void ir_send_init() {
-  gpio_init(GPIO_IR_SEND_PIN);
-  gpio_set_dir(GPIO_IR_SEND_PIN, GPIO_OUT);
-  gpio_put(GPIO_IR_SEND_PIN, false);
-  gpio_pull_down(GPIO_IR_SEND_PIN);
-  gpio_set_slew_rate(GPIO_IR_SEND_PIN, GPIO_SLEW_RATE_FAST);
+  portYIELD_FROM_ISR(higher_priority_task_woken);
 }
 
-inline void pwm_on(uint slice_num) {
-  pwm_set_counter(slice_num, 0);
-  gpio_set_function(GPIO_IR_SEND_PIN, GPIO_FUNC_PWM);
-  pwm_set_enabled(slice_num, true);
+static void ir_send_emitter_init(struct IrEmitter *emitter, uint pin) {
+  uint offset;
+  bool claimed = pio_claim_free_sm_and_add_program_for_gpio_range(
+      &ir_send_program, &emitter->pio, &emitter->sm, &offset, pin, 1, true);
+  hard_assert(claimed);
+  ir_send_program_init(emitter->pio, emitter->sm, offset, pin, IR_CARRIER_HZ);
+
+  emitter->pin            = pin;
+  emitter->dma_chan       = dma_claim_unused_channel(true);
+  dma_channel_config conf = dma_channel_get_default_config(emitter->dma_chan);
+  channel_config_set_transfer_data_size(&conf, DMA_SIZE_32);
+  channel_config_set_read_increment(&conf, true);
+  channel_config_set_write_increment(&conf, false);
+  channel_config_set_dreq(&conf, pio_get_dreq(emitter->pio, emitter->sm, true));
+  dma_channel_configure(emitter->dma_chan, &conf, &emitter->pio->txf[emitter->sm], NULL, 0,
+                        false);
+  dma_channel_set_irq1_enabled(emitter->dma_chan, true);
 }
 
-inline void pwm_off(uint slice_num) {
-  gpio_put(GPIO_IR_SEND_PIN, false);
-  gpio_set_function(GPIO_IR_SEND_PIN, GPIO_FUNC_SIO);
-  pwm_set_enabled(slice_num, false);
+void ir_send_init(const uint *pins, uint count) {
+  hard_assert(ir_send_emitter_total == 0 && count <= IR_SEND_MAX_EMITTERS);
+
+  for (uint i = 0; i < count; i++) {
+    ir_send_emitter_init(&ir_send_emitters[i], pins[i]);
+  }
+  ir_send_emitter_total = count;
+
+  irq_add_shared_handler(DMA_IRQ_1, ir_send_dma_irq_handler,
+                         PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  core_partition_enable_irq(DMA_IRQ_1, CORE_ROLE_IR);
 }
 
-inline void send_ir_symbol(bool new_transmission, bool value) {
-  const uint slice_num = pwm_gpio_to_slice_num(GPIO_IR_SEND_PIN);
-  if (new_transmission) {
-    printf("STARTING NEW TRANSMISSION\n");
-    // Send the start of transmission symbols
+uint ir_send_emitter_count() { return ir_send_emitter_total; }
 
-    // First Pulse (3200us)
-    pwm_on(slice_num);
-    busy_wait_us_32(30000);
+int32_t ir_send_symbols(uint emitter, const uint32_t *symbols, uint32_t count) {
+  if (emitter >= ir_send_emitter_total) {
+    return PICO_ERROR_INVALID_ARG;
+  }
 
-    // First Pause (49500us)
-    pwm_off(slice_num);
-    busy_wait_us_32(49500);
+  struct IrEmitter *e = &ir_send_emitters[emitter];
+  if (dma_channel_is_busy(e->dma_chan)) {
+    EVENT_LOG2(LOG_IR_SEND_BUSY, PICO_ERROR_RESOURCE_IN_USE, emitter);
+    return PICO_ERROR_RESOURCE_IN_USE;
+  }
 
-    // Second Pulse (3200us)
-    pwm_on(slice_num);
-    busy_wait_us_32(3380);
+  EVENT_LOG2(LOG_IR_SEND_QUEUED, count, emitter);
+  e->waiting_task = xTaskGetCurrentTaskHandle();
+  PERF_TRACE_SPAN_BEGIN(PERF_TRACE_IR_SEND, emitter);
+  dma_channel_transfer_from_buffer_now(e->dma_chan, symbols, count);
 
-    // Second Pause (1700us)
-    pwm_off(slice_num);
-    busy_wait_us_32(1700);
+  return PICO_ERROR_NONE;
+}
+
+// Finds or encodes the timeline for a frame. `frame` is left pointing at the frame's bytes.
+static int32_t ir_send_prepare(uint emitter, enum AirconUpdateType update_type,
+                               enum AirconMode mode, enum AirconFanSpeed fan_speed,
+                               uint8_t temperature, uint16_t timer_on_duration,
+                               uint16_t timer_off_duration, const struct AirconFrame **frame,
+                               const uint32_t **symbols, uint32_t *count) {
+  if (emitter >= ir_send_emitter_total) {
+    return PICO_ERROR_INVALID_ARG;
   }
 
-  // Set pulse (always 410us)
-  pwm_on(slice_num);
-  busy_wait_us_32(410);
-
-  // Set pause (1260us for one, 410us for zero)
-  pwm_off(slice_num);
-  gpio_put(GPIO_IR_SEND_PIN, false);
-  if (value) {
-    busy_wait_us_32(1256);  // Aiming for 1260
-  } else {
-    busy_wait_us_32(422);  // Aiming for 425us
+  // The emitter's timeline is only free again once the DMA has handed all of it to the PIO
+  struct IrEmitter *e = &ir_send_emitters[emitter];
+  if (dma_channel_is_busy(e->dma_chan)) {
+    return PICO_ERROR_RESOURCE_IN_USE;
   }
-}
 
-void send_aircon_command(enum AirconUpdateType update_type, enum AirconMode mode,
-                         enum AirconFanSpeed fan_speed, uint8_t temperature,
-                         uint16_t timer_on_duration, uint16_t timer_off_duration) {
-  uint8_t *command_buffer = populate_command_buffer(update_type, mode, fan_speed, temperature,
-                                                    timer_on_duration, timer_off_duration);
-
-  // Prep PWM unit
-  uint slice_num = pwm_gpio_to_slice_num(GPIO_IR_SEND_PIN);
-  pwm_set_wrap(slice_num, PWM_IR_SEND_WRAP);
-  pwm_set_gpio_level(GPIO_IR_SEND_PIN, PWM_IR_SEND_LEVEL);  // Set PWM trigger
-  pwm_set_enabled(slice_num, true);
-  gpio_set_function(GPIO_IR_SEND_PIN, GPIO_FUNC_SIO);
-  gpio_put(GPIO_IR_SEND_PIN, false);
-  gpio_disable_pulls(GPIO_IR_SEND_PIN);
-  gpio_set_slew_rate(GPIO_IR_SEND_PIN, GPIO_SLEW_RATE_FAST);
-
-  for (int i = 0; i < COMMAND_BYTE_COUNT; i++) {
-    uint8_t byte = command_buffer[i];
-    for (int j = 0; j < 8; j++) {
-      send_ir_symbol(i == 0 && j == 0, byte & 0x01);
-      // printf("Sent bit %u\n", byte & 0x01);
-      byte = byte >> 1;
-    }
-    // printf("---- Just sent byte %u (0x%X)\n", i, command_buffer[i]);
+  // Presets were encoded at build time and go out straight from flash, unless the timing has
+  // been trimmed since
+  const struct AirconPreset *preset =
+      ir_timeline_trimmed() ? NULL :
+                              aircon_preset_find(update_type, mode, fan_speed, temperature,
+                                                 timer_on_duration, timer_off_duration);
+  if (preset != NULL) {
+    *frame   = &preset->frame;
+    *symbols = preset->symbols;
+    *count   = IR_TIMELINE_SYMBOL_COUNT;
+    return PICO_ERROR_NONE;
   }
 
-  // Set pulse (always 410us) to finish off the transmission
-  // This is needed because send_ir_symbol() finishes on a pause. We need a pulse to signal the end
-  // of the last bit
-  pwm_on(slice_num);
-  busy_wait_us_32(410);
-  // Disable PWM now that the transmission is completed
-  pwm_off(slice_num);
+  aircon_frame_encode(&e->frame, update_type, mode, fan_speed, temperature, timer_on_duration,
+                      timer_off_duration);
+  ir_timeline_encode(&e->frame, &e->timeline);
+  *frame   = &e->frame;
+  *symbols = e->timeline.symbols;
+  *count   = e->timeline.count;
+  return PICO_ERROR_NONE;
 }
 
-void ir_send_task(void *params) {
-  printf("Settings %u %u\n", PWM_IR_SEND_WRAP, PWM_IR_SEND_LEVEL);
-  ir_send_init();
+int32_t send_aircon_command(uint emitter, enum AirconUpdateType update_type, enum AirconMode mode,
+                            enum AirconFanSpeed fan_speed, uint8_t temperature,
+                            uint16_t timer_on_duration, uint16_t timer_off_duration) {
+  const struct AirconFrame *frame;
+  const uint32_t           *symbols;
+  uint32_t                  count;
+  int32_t err = ir_send_prepare(emitter, update_type, mode, fan_speed, temperature,
+                                timer_on_duration, timer_off_duration, &frame, &symbols, &count);
+  return err ? err : ir_send_symbols(emitter, symbols, count);
+}
 
-  while (1) {
-    printf("Sending Command\n");
-    send_aircon_command(AC_UPDATE_AIRCON_MODE, AC_MODE_OFF, AC_FAN_AUTO, 25, 0, 0);
-    printf("Command Sent\n");
-    vTaskDelay(pdMS_TO_TICKS(5000));
+int32_t send_aircon_command_blocking(uint emitter, enum AirconUpdateType update_type,
+                                     enum AirconMode mode, enum AirconFanSpeed fan_speed,
+                                     uint8_t temperature, uint16_t timer_on_duration,
+                                     uint16_t timer_off_duration) {
+  const struct AirconFrame *frame;
+  const uint32_t           *symbols;
+  uint32_t                  count;
+  int32_t err = ir_send_prepare(emitter, update_type, mode, fan_speed, temperature,
+                                timer_on_duration, timer_off_duration, &frame, &symbols, &count);
+  if (err) {
+    return err;
   }
 
-  while (1);
-}
\ No newline at end of file
+  bool checked = ir_loopback_enabled(emitter);
+  for (uint attempt = 1;; attempt++) {
+    if (checked) {
+      ir_loopback_expect(frame->bytes, symbols, count);
+    }
+    err = ir_send_symbols(emitter, symbols, count);
+    if (err) {
+      return err;
+    }
+
+    // Notified once the whole frame is queued in the PIO FIFO
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    EVENT_LOG0(LOG_IR_SEND_DONE);
+    if (!checked || ir_loopback_wait() == IR_LOOPBACK_MATCH) {
+      return PICO_ERROR_NONE;
+    }
+
+    if (attempt == IR_LOOPBACK_MAX_ATTEMPTS) {
+      ir_loopback_failed();
+      return PICO_ERROR_IO;
+    }
+    ir_loopback_retransmitted();
+  }
+}
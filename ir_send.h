@@ -1,6 +1,38 @@
 #ifndef IR_SEND
 #define IR_SEND
 
-void ir_send_task(void *params);
+#include "cmd_gen.h"
 
-#endif  // IR_SEND
\ No newline at end of file
+// A pool of IR emitters, one per zone. Each emitter has its own PIO state machine and DMA channel,
+// so frames to different zones go out at the same time and only frames to the same zone queue
+// behind each other.
+
+#define IR_SEND_MAX_EMITTERS 4  // Leaves PIO state machines for the receiver
+#define IR_SEND_DEFAULT_PIN  16
+
+// Claims a state machine and a DMA channel for each pin. Emitter i drives pins[i]. Call once,
+// before any task sends.
+void ir_send_init(const uint *pins, uint count);
+
+uint ir_send_emitter_count();
+
+// Starts transmitting a precomputed symbol timeline (see ir_timeline.h) on an emitter. The buffer
+// must stay valid until the calling task has been notified.
+int32_t ir_send_symbols(uint emitter, const uint32_t *symbols, uint32_t count);
+
+// Queues a frame for transmission and returns immediately. The calling task receives a task
+// notification once the frame has been handed to the transmitter.
+int32_t send_aircon_command(uint emitter, enum AirconUpdateType update_type, enum AirconMode mode,
+                            enum AirconFanSpeed fan_speed, uint8_t temperature,
+                            uint16_t timer_on_duration, uint16_t timer_off_duration);
+
+// Sends a frame and blocks until it has been handed to the transmitter. If the loopback check is
+// enabled on the emitter (see ir_loopback.h), it also waits for the receiver's copy, and sends the
+// frame again while the copy doesn't match, up to IR_LOOPBACK_MAX_ATTEMPTS times in all. Returns
+// PICO_ERROR_IO if no copy matched.
+int32_t send_aircon_command_blocking(uint emitter, enum AirconUpdateType update_type,
+                                     enum AirconMode mode, enum AirconFanSpeed fan_speed,
+                                     uint8_t temperature, uint16_t timer_on_duration,
+                                     uint16_t timer_off_duration);
+
+#endif  // IR_SEND
@@ -0,0 +1,75 @@
+#include "ir_protocol.hpp"
+
+extern "C" {
+#include "ir_timeline.h"
+}
+
+using ShirokumaEncoder = ir::Encoder<ir::Shirokuma>;
+
+static_assert(ShirokumaEncoder::kSymbolCount == IR_TIMELINE_SYMBOL_COUNT);
+static_assert(std::size(ir::Shirokuma::kLeader) == IR_TIMING_BIT_MARK,
+              "One trim per leader stage, ahead of the data timings");
+
+const char *const ir_timing_kind_names[IR_TIMING_KINDS] = {
+    "preamble mark", "preamble space", "sync mark", "sync space",
+    "bit mark",      "zero space",     "one space",
+};
+
+static struct IrTimelineTrim  ir_timeline_trim;
+static ShirokumaEncoder::Trim ir_timeline_encoder_trim;
+static bool                   ir_timeline_is_trimmed;
+
+void ir_timeline_encode(const struct AirconFrame *frame, struct IrTimeline *timeline) {
+  timeline->count =
+      ShirokumaEncoder::encode(frame->bytes, timeline->symbols, ir_timeline_encoder_trim);
+}
+
+static const ir::Timing &ir_timeline_timing(enum IrTimingKind kind) {
+  return kind == IR_TIMING_BIT_MARK   ? ir::Shirokuma::kBitMark :
+         kind == IR_TIMING_ZERO_SPACE ? ir::Shirokuma::kZeroSpace :
+         kind == IR_TIMING_ONE_SPACE  ? ir::Shirokuma::kOneSpace :
+                                        ir::Shirokuma::kLeader[kind].timing;
+}
+
+uint32_t ir_timeline_target_us(enum IrTimingKind kind) {
+  const ir::Timing &timing = ir_timeline_timing(kind);
+  return (timing.min_us + timing.max_us) / 2;
+}
+
+uint32_t ir_timeline_protocol_us(enum IrTimingKind kind) { return ir_timeline_timing(kind).us; }
+
+enum IrTimingKind ir_timeline_kind(uint32_t symbol, bool mark, uint32_t sent_us) {
+  // The first symbols are the leader, every later one a bit or the closing mark
+  if (symbol < 2) {
+    return symbol == 0 ? (mark ? IR_TIMING_PREAMBLE_MARK : IR_TIMING_PREAMBLE_SPACE) :
+                         (mark ? IR_TIMING_SYNC_MARK : IR_TIMING_SYNC_SPACE);
+  }
+  if (mark) {
+    return IR_TIMING_BIT_MARK;
+  }
+  uint32_t midpoint = (ir_timeline_target_us(IR_TIMING_ZERO_SPACE) +
+                       ir_timeline_target_us(IR_TIMING_ONE_SPACE)) / 2;
+  return sent_us > midpoint ? IR_TIMING_ONE_SPACE : IR_TIMING_ZERO_SPACE;
+}
+
+void ir_timeline_set_trim(const struct IrTimelineTrim *trim) {
+  ShirokumaEncoder::Trim encoder_trim{};
+  bool                   trimmed = false;
+  for (size_t i = 0; i < std::size(ir::Shirokuma::kLeader); i++) {
+    encoder_trim.leader_us[i] = trim->us[i];
+  }
+  encoder_trim.bit_mark_us   = trim->us[IR_TIMING_BIT_MARK];
+  encoder_trim.zero_space_us = trim->us[IR_TIMING_ZERO_SPACE];
+  encoder_trim.one_space_us  = trim->us[IR_TIMING_ONE_SPACE];
+  for (int16_t us : trim->us) {
+    trimmed = trimmed || us != 0;
+  }
+
+  ir_timeline_trim         = *trim;
+  ir_timeline_encoder_trim = encoder_trim;
+  ir_timeline_is_trimmed   = trimmed;
+}
+
+void ir_timeline_get_trim(struct IrTimelineTrim *trim) { *trim = ir_timeline_trim; }
+
+bool ir_timeline_trimmed() { return ir_timeline_is_trimmed; }
@@ -0,0 +1,95 @@
+#ifndef IR_TIMELINE_H
+#define IR_TIMELINE_H
+
+#include "cmd_gen.h"
+#include "stdint.h"
+
+// Symbol timeline for the PIO transmitter. Each symbol is one mark followed by one space, packed
+// exactly as ir_send.pio pulls it from its FIFO:
+//   bits 15:0  - carrier periods in the mark, minus one
+//   bits 31:16 - state machine cycles in the space, minus IR_SEND_SPACE_OVERHEAD_CYCLES
+
+#define IR_CARRIER_HZ                 38000
+#define IR_SEND_CARRIER_CYCLES        26  // State machine cycles per carrier period
+#define IR_SEND_SPACE_OVERHEAD_CYCLES 4   // out + loop exit + pull + out between marks
+#define IR_SEND_PIO_HZ                (IR_CARRIER_HZ * IR_SEND_CARRIER_CYCLES)
+
+#define IR_US_TO_CARRIER_PERIODS(us) \
+  ((uint32_t)(((uint64_t)(us) * IR_CARRIER_HZ + 500000) / 1000000))
+#define IR_US_TO_SEND_CYCLES(us) \
+  ((uint32_t)(((uint64_t)(us) * IR_SEND_PIO_HZ + 500000) / 1000000))
+
+#define IR_TIMELINE_SPACE_FIELD(us)                               \
+  (IR_US_TO_SEND_CYCLES(us) > IR_SEND_SPACE_OVERHEAD_CYCLES ?     \
+       IR_US_TO_SEND_CYCLES(us) - IR_SEND_SPACE_OVERHEAD_CYCLES : \
+       0)
+
+// Packs a mark/space pair. Folds to a constant when given constants.
+#define IR_TIMELINE_SYMBOL(mark_us, space_us) \
+  ((IR_TIMELINE_SPACE_FIELD(space_us) << 16) | ((IR_US_TO_CARRIER_PERIODS(mark_us) - 1) & 0xFFFF))
+
+// Preamble, sync, one symbol per bit and the closing mark. The timings are in ir_protocol.hpp.
+#define IR_TIMELINE_SYMBOL_COUNT (2 + 8 * COMMAND_BYTE_COUNT + 1)
+
+struct IrTimeline {
+  uint32_t symbols[IR_TIMELINE_SYMBOL_COUNT];
+  uint32_t count;
+};
+
+// Encodes a Shirokuma frame, with the current trim
+void ir_timeline_encode(const struct AirconFrame *frame, struct IrTimeline *timeline);
+
+//////////
+// Trim //
+//////////
+
+// The durations the transmitter produces, each with its own correction. Calibration (see
+// ir_calibration.h) measures what the receiver sees of each one and trims it onto its target.
+enum IrTimingKind {
+  IR_TIMING_PREAMBLE_MARK,
+  IR_TIMING_PREAMBLE_SPACE,
+  IR_TIMING_SYNC_MARK,
+  IR_TIMING_SYNC_SPACE,
+  IR_TIMING_BIT_MARK,
+  IR_TIMING_ZERO_SPACE,
+  IR_TIMING_ONE_SPACE,
+  IR_TIMING_KINDS,
+};
+
+// For reports, indexed by enum IrTimingKind
+extern const char *const ir_timing_kind_names[IR_TIMING_KINDS];
+
+struct IrTimelineTrim {
+  int16_t us[IR_TIMING_KINDS];  // Added to the protocol's duration
+};
+
+// What the receiver should see of a kind: the middle of the window the decoder accepts, which
+// leaves the most margin either side. Not always the duration the protocol sends, since the
+// windows allow for receivers stretching marks.
+uint32_t ir_timeline_target_us(enum IrTimingKind kind);
+
+// The duration ir_protocol.hpp sends for a kind, before any trim
+uint32_t ir_timeline_protocol_us(enum IrTimingKind kind);
+
+// Which kind a run of a frame is, from its symbol's index in the timeline, whether it's the mark
+// and its length as sent. Takes what the loopback observer gets, see ir_loopback.h.
+enum IrTimingKind ir_timeline_kind(uint32_t symbol, bool mark, uint32_t sent_us);
+
+// Applies to frames encoded from now on. Frames built into flash are untrimmed, so the
+// transmitter only uses them while the trim is all zero.
+void ir_timeline_set_trim(const struct IrTimelineTrim *trim);
+void ir_timeline_get_trim(struct IrTimelineTrim *trim);
+bool ir_timeline_trimmed();
+
+// Duration of a packed symbol's mark as seen by the receiver
+static inline uint32_t ir_timeline_mark_us(uint32_t symbol) {
+  return ((symbol & 0xFFFF) + 1) * 1000000 / IR_CARRIER_HZ;
+}
+
+// Duration of a packed symbol's space, including the state machine overhead
+static inline uint32_t ir_timeline_space_us(uint32_t symbol) {
+  return (uint32_t)(((uint64_t)(symbol >> 16) + IR_SEND_SPACE_OVERHEAD_CYCLES) * 1000000 /
+                    IR_SEND_PIO_HZ);
+}
+
+#endif  // IR_TIMELINE_H
@@ -0,0 +1,100 @@
+#include "ir_trace.h"
+
+#include "pico/stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#define IR_TRACE_RUNS_PER_LINE 8
+
+void ir_trace_recorder_init(struct IrTraceRecorder *recorder, uint32_t *runs, uint32_t capacity) {
+  memset(recorder, 0, sizeof(*recorder));
+  recorder->runs     = runs;
+  recorder->capacity = capacity;
+}
+
+void ir_trace_recorder_start(struct IrTraceRecorder *recorder, uint32_t timestamp_us) {
+  recorder->count        = 0;
+  recorder->dropped      = 0;
+  recorder->timestamp_us = timestamp_us;
+}
+
+void ir_trace_print(const struct IrTraceRecorder *recorder, uint32_t tick_hz) {
+  printf("irtrace %u %u %u\n", tick_hz, recorder->timestamp_us, recorder->count);
+  for (uint32_t i = 0; i < recorder->count; i++) {
+    bool last_in_line = (i + 1) % IR_TRACE_RUNS_PER_LINE == 0 || i + 1 == recorder->count;
+    printf("%08x%c", recorder->runs[i], last_in_line ? '\n' : ' ');
+  }
+  printf("irtrace end\n");
+}
+
+static inline uint32_t load_le32(const uint8_t *bytes) {
+  return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 |
+         (uint32_t)bytes[3] << 24;
+}
+
+static inline uint16_t load_le16(const uint8_t *bytes) {
+  return (uint16_t)(bytes[0] | bytes[1] << 8);
+}
+
+int32_t ir_trace_reader_init(struct IrTraceReader *reader, const uint8_t *data, size_t size) {
+  memset(reader, 0, sizeof(*reader));
+  if (size < sizeof(struct IrTraceHeader) || load_le32(&data[0]) != IR_TRACE_MAGIC) {
+    return PICO_ERROR_INVALID_DATA;
+  }
+
+  uint16_t version      = load_le16(&data[4]);
+  uint16_t header_bytes = load_le16(&data[6]);
+  if (version > IR_TRACE_VERSION) {
+    return PICO_ERROR_VERSION_MISMATCH;
+  }
+  if (header_bytes < sizeof(struct IrTraceHeader) || header_bytes > size) {
+    return PICO_ERROR_INVALID_DATA;
+  }
+
+  reader->data          = data;
+  reader->size          = size;
+  reader->offset        = header_bytes;
+  reader->tick_hz       = load_le32(&data[8]);
+  reader->captures_left = load_le32(&data[12]);
+
+  return reader->tick_hz > 0 ? PICO_ERROR_NONE : PICO_ERROR_INVALID_DATA;
+}
+
+int32_t ir_trace_next_capture(struct IrTraceReader *reader, struct IrTraceCapture *capture) {
+  if (reader->captures_left == 0) {
+    return PICO_ERROR_NO_DATA;
+  }
+  if (reader->size - reader->offset < sizeof(struct IrTraceCaptureHeader)) {
+    return PICO_ERROR_INVALID_DATA;
+  }
+
+  const uint8_t *header = &reader->data[reader->offset];
+  capture->run_count    = load_le32(&header[0]);
+  capture->timestamp_us = load_le32(&header[4]);
+  capture->runs         = header + sizeof(struct IrTraceCaptureHeader);
+
+  size_t remaining = reader->size - reader->offset - sizeof(struct IrTraceCaptureHeader);
+  if (capture->run_count > remaining / sizeof(uint32_t)) {
+    return PICO_ERROR_INVALID_DATA;
+  }
+
+  reader->offset += sizeof(struct IrTraceCaptureHeader) + capture->run_count * sizeof(uint32_t);
+  reader->captures_left--;
+
+  return PICO_ERROR_NONE;
+}
+
+uint32_t ir_trace_capture_run(const struct IrTraceCapture *capture, uint32_t index) {
+  return load_le32(&capture->runs[index * sizeof(uint32_t)]);
+}
+
+uint32_t ir_trace_replay(const struct IrTraceCapture *capture, uint32_t tick_hz,
+                         struct IrDecoder *decoder) {
+  uint32_t frames = 0;
+  for (uint32_t i = 0; i < capture->run_count; i++) {
+    uint32_t run = ir_trace_capture_run(capture, i);
+    uint32_t us  = (uint32_t)((uint64_t)ir_trace_run_ticks(run) * 1000000 / tick_hz);
+    frames += ir_decoder_feed(decoder, ir_trace_run_level(run), us);
+  }
+  return frames;
+}
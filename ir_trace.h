@@ -0,0 +1,104 @@
+#ifndef IR_TRACE_H
+#define IR_TRACE_H
+
+#include "ir_decoder.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// Versioned file format for raw receiver captures. All fields are little endian.
+//   file header:    uint32 magic, uint16 version, uint16 header bytes, uint32 tick rate in Hz,
+//                   uint32 capture count
+//   capture header: uint32 run count, uint32 timestamp in us
+//   runs:           one uint32 per level run, bit 31 the level and bits 30:0 the length in ticks
+// Readers skip any header bytes they don't know about, so fields can be appended to the file
+// header without bumping the version.
+
+#define IR_TRACE_MAGIC    0x52545249  // "IRTR"
+#define IR_TRACE_VERSION  1
+#define IR_TRACE_RUN_MASK 0x7FFFFFFF
+
+struct IrTraceHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_bytes;
+  uint32_t tick_hz;
+  uint32_t capture_count;
+};
+
+struct IrTraceCaptureHeader {
+  uint32_t run_count;
+  uint32_t timestamp_us;
+};
+
+static inline uint32_t ir_trace_run(bool level, uint32_t ticks) {
+  return (uint32_t)level << 31 | (ticks & IR_TRACE_RUN_MASK);
+}
+
+static inline bool ir_trace_run_level(uint32_t run) { return run >> 31; }
+
+static inline uint32_t ir_trace_run_ticks(uint32_t run) { return run & IR_TRACE_RUN_MASK; }
+
+///////////////
+// Recording //
+///////////////
+
+// Collects the runs of one capture into a caller provided buffer
+struct IrTraceRecorder {
+  uint32_t *runs;
+  uint32_t  capacity;
+  uint32_t  count;
+  uint32_t  timestamp_us;
+  uint32_t  dropped;  // Runs that didn't fit
+};
+
+void ir_trace_recorder_init(struct IrTraceRecorder *recorder, uint32_t *runs, uint32_t capacity);
+void ir_trace_recorder_start(struct IrTraceRecorder *recorder, uint32_t timestamp_us);
+
+static inline void ir_trace_record(struct IrTraceRecorder *recorder, bool level, uint32_t ticks) {
+  if (recorder->count < recorder->capacity) {
+    recorder->runs[recorder->count++] = ir_trace_run(level, ticks);
+  } else {
+    recorder->dropped++;
+  }
+}
+
+// Prints the capture as text that tools/ir_trace.py turns back into a trace file:
+//   irtrace <tick_hz> <timestamp_us> <run count>
+//   <up to 8 hex runs per line>
+//   irtrace end
+void ir_trace_print(const struct IrTraceRecorder *recorder, uint32_t tick_hz);
+
+////////////
+// Replay //
+////////////
+
+struct IrTraceCapture {
+  uint32_t       run_count;
+  uint32_t       timestamp_us;
+  const uint8_t *runs;  // Not necessarily aligned, read with ir_trace_capture_run()
+};
+
+struct IrTraceReader {
+  const uint8_t *data;
+  size_t         size;
+  size_t         offset;
+  uint32_t       tick_hz;
+  uint32_t       captures_left;
+};
+
+// Returns PICO_ERROR_INVALID_DATA for a truncated or foreign file and PICO_ERROR_VERSION_MISMATCH
+// for a newer major version
+int32_t ir_trace_reader_init(struct IrTraceReader *reader, const uint8_t *data, size_t size);
+
+// Returns PICO_ERROR_NO_DATA once every capture has been read
+int32_t ir_trace_next_capture(struct IrTraceReader *reader, struct IrTraceCapture *capture);
+
+uint32_t ir_trace_capture_run(const struct IrTraceCapture *capture, uint32_t index);
+
+// Feeds every run of a capture through a decoder, converting ticks to microseconds. Returns the
+// number of frames completed.
+uint32_t ir_trace_replay(const struct IrTraceCapture *capture, uint32_t tick_hz,
+                         struct IrDecoder *decoder);
+
+#endif  // IR_TRACE_H
@@ -5,16 +5,31 @@
  */
 
 #include "FreeRTOS.h"
+#include "aircon_service.h"
+#include "core_partition.h"
+#include "event_log.h"
+#include "ir_calibration.h"
+#include "ir_jitter.h"
+#include "ir_loopback.h"
 #include "ir_recv.h"
 #include "ir_send.h"
+#include "lwip/apps/lwiperf.h"
 #include "lwip/ip4_addr.h"
+#include "perf_trace.h"
 #include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
 #include "ping.h"
 #include "scd40.h"
+#include "scd40_service.h"
+#include "scd4x_poller.h"
 #include "task.h"
+#include "task_monitor.h"
 #include "tusb.h"
 
+#if AIRCON_ENCODE_BENCH
+#include "aircon_encode_bench.h"
+#endif
+
 #ifndef PING_ADDR
 #define PING_ADDR "10.0.1.11"
 #endif
@@ -27,6 +42,17 @@
 #define STRING(x)    #x
 #define STRINGIZE(x) STRING(x)
 
+#if IPERF_SERVER
+static void main_iperf_report(void *arg, enum lwiperf_report_type report_type,
+                              const ip_addr_t *local_addr, u16_t local_port,
+                              const ip_addr_t *remote_addr, u16_t remote_port,
+                              u32_t bytes_transferred, u32_t ms_duration,
+                              u32_t bandwidth_kbitpsec) {
+  printf("iperf: %u bytes in %u ms, %u kbit/s\n", bytes_transferred, ms_duration,
+         bandwidth_kbitpsec);
+}
+#endif
+
 void main_task(__unused void *params) {
   if (cyw43_arch_init()) {
     printf("failed to initialise\n");
@@ -34,11 +60,15 @@ void main_task(__unused void *params) {
   }
   cyw43_arch_enable_sta_mode();
   printf("Connecting to Wi-Fi...\n");
-  if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA3_SAE_AES_PSK,
-                                         30000)) {
+  PERF_TRACE_SPAN_BEGIN(PERF_TRACE_WIFI_CONNECT, 0);
+  int connect_err = cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD,
+                                                       CYW43_AUTH_WPA3_SAE_AES_PSK, 30000);
+  PERF_TRACE_SPAN_END(PERF_TRACE_WIFI_CONNECT, 0);
+  if (connect_err) {
     printf("failed to connect.\n");
     exit(1);
   } else {
+    PERF_TRACE_INSTANT(PERF_TRACE_WIFI_CONNECTED, 0);
     printf("Connected.\n");
   }
 
@@ -46,6 +76,16 @@ void main_task(__unused void *params) {
   ipaddr_aton(PING_ADDR, &ping_addr);
   ping_init(&ping_addr);
 
+#if IPERF_SERVER
+  // Network load for ir_jitter_task, from another machine: iperf -c <address> -t 600
+  cyw43_arch_lwip_begin();
+  lwiperf_start_tcp_server_default(main_iperf_report, NULL);
+  cyw43_arch_lwip_end();
+  printf("iperf server on %s\n", ip4addr_ntoa(netif_ip4_addr(netif_list)));
+#endif
+  // lwIP and the driver created their tasks during init
+  core_partition_pin_system_tasks();
+
   while (true) {
     // not much to do as LED is in another task, and we're using RAW (callback) lwIP API
     vTaskDelay(100);
@@ -55,15 +95,63 @@ void main_task(__unused void *params) {
 }
 
 void vLaunch(void) {
-  verify_checksum_calculation();
-
-  while (1);
-
   TaskHandle_t task;
-  // xTaskCreate(ir_recv_task, "IrRecvTask", configMINIMAL_STACK_SIZE, NULL, TEST_TASK_PRIORITY,
+  // With -DCORE_PARTITION=ON the IR tasks get core 1 and everything else core 0, see
+  // core_partition.h. Pinning does nothing without it.
+  xTaskCreate(event_log_task, "EventLogTask", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY,
+              &task);
+  core_partition_pin(task, CORE_ROLE_SYSTEM);
+#if PERF_TRACE
+  xTaskCreate(perf_trace_task, "PerfTraceTask", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY,
+              &task);
+  core_partition_pin(task, CORE_ROLE_SYSTEM);
+#endif
+#if AIRCON_ENCODE_BENCH
+  // Prints the old byte loop's and the timeline encoder's time per frame on this core, once
+  xTaskCreate(aircon_encode_bench_task, "EncodeBenchTask", configMINIMAL_STACK_SIZE * 2, NULL,
+              TEST_TASK_PRIORITY, &task);
+  core_partition_pin(task, CORE_ROLE_SYSTEM);
+#endif
+  // Alarms for a task over 90% of a core, under 32 words of stack left or the heap under 8 KiB
+  static const struct TaskMonitorThresholds monitor_limits = {900, 32, 8 * 1024};
+  task_monitor_init(&monitor_limits);
+  xTaskCreate(task_monitor_task, "MonitorTask", configMINIMAL_STACK_SIZE, NULL, TEST_TASK_PRIORITY,
+              &task);
+  core_partition_pin(task, CORE_ROLE_SYSTEM);
+  xTaskCreate(scd40_service_task, "Scd40Task", configMINIMAL_STACK_SIZE,
+              (void *)SCD40_SERVICE_PERIODIC, TEST_TASK_PRIORITY, &task);
+  core_partition_pin(task, CORE_ROLE_SYSTEM);
+  // One sensor per room on both controllers. Replaces scd40_service_task.
+  // static const struct Scd4xSensorConfig rooms[] = {{"Living", 0, 4, 5, false},
+  //                                                  {"Bedroom", 1, 6, 7, false}};
+  // scd4x_poller_init(rooms, count_of(rooms));
+  // xTaskCreate(scd4x_poller_task, "Scd4xPollTask", configMINIMAL_STACK_SIZE,
+  //             (void *)SCD40_SERVICE_PERIODIC, TEST_TASK_PRIORITY, &task);
+  // core_partition_pin(task, CORE_ROLE_SYSTEM);
+  // Connects to Wi-Fi and answers pings, and serves iperf with -DIPERF_SERVER=ON
+  // xTaskCreate(main_task, "MainTask", configMINIMAL_STACK_SIZE * 4, NULL, TEST_TASK_PRIORITY,
   //             &task);
-  // xTaskCreate(ir_send_task, "IrSendTask", configMINIMAL_STACK_SIZE, NULL, TEST_TASK_PRIORITY,
+  // core_partition_pin(task, CORE_ROLE_SYSTEM);
+  // xTaskCreate(ir_recv_task, "IrRecvTask", configMINIMAL_STACK_SIZE, NULL, TEST_TASK_PRIORITY,
   //             &task);
+  // core_partition_pin(task, CORE_ROLE_IR);
+  // Owns the emitters, one task per zone.
+  // static const uint                  aircon_pins[]    = {IR_SEND_DEFAULT_PIN};
+  // static const struct AirconSettings aircon_initial[] = {{AC_MODE_OFF, AC_FAN_AUTO, 25, 0, 0}};
+  // aircon_service_init(aircon_pins, aircon_initial, 1);
+  // Checks zone 0's frames through the receiver next to its emitter. Needs ir_recv_task.
+  // ir_loopback_enable(0);
+  // Applies the stored transmit timing trim. To measure a new one, call from a task once
+  // ir_recv_task is running: ir_calibration_run(0, IR_CALIBRATION_FRAMES, &report)
+  // ir_calibration_load();
+  // xTaskCreate(aircon_service_task, "AirconTask0", configMINIMAL_STACK_SIZE, (void *)0,
+  //             TEST_TASK_PRIORITY, &task);
+  // core_partition_pin(task, CORE_ROLE_IR);
+  // Measures zone 0's worst symbol jitter over and over, see ir_jitter.h. Needs the loopback
+  // check, and main_task for iperf load. Start it in place of zone 0's aircon_service_task.
+  // xTaskCreate(ir_jitter_task, "IrJitterTask", configMINIMAL_STACK_SIZE * 2, (void *)0,
+  //             TEST_TASK_PRIORITY, &task);
+  // core_partition_pin(task, CORE_ROLE_IR);
   // xTaskCreate(decompose_test_task, "IrTestTask", configMINIMAL_STACK_SIZE, NULL,
   // TEST_TASK_PRIORITY,
   //             &task);
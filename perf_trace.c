@@ -0,0 +1,78 @@
+#include "perf_trace.h"
+
+#if PERF_TRACE
+
+#include "FreeRTOS.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "task.h"
+
+#define PERF_TRACE_RING_MASK    (PERF_TRACE_RING_RECORDS - 1)
+#define PERF_TRACE_POLL_MS      100
+#define PERF_TRACE_DUMP_COMMAND 't'
+
+// Unlike the event log these rings overwrite their oldest records, so the last moments before a
+// problem are always there to dump. Only the owning core writes a ring, with interrupts masked.
+struct PerfTraceRing {
+  volatile uint32_t      head;  // Records written since the last dump
+  struct PerfTraceRecord records[PERF_TRACE_RING_RECORDS];
+};
+
+static struct PerfTraceRing perf_trace_rings[NUM_CORES];
+static volatile bool        perf_trace_paused;
+
+void __not_in_flash_func(perf_trace_record)(uint16_t id, uint8_t phase, uint32_t arg) {
+  uint                  core   = get_core_num();
+  struct PerfTraceRing *ring   = &perf_trace_rings[core];
+  uint32_t              status = save_and_disable_interrupts();
+
+  if (!perf_trace_paused) {
+    uint32_t                head   = ring->head;
+    struct PerfTraceRecord *record = &ring->records[head & PERF_TRACE_RING_MASK];
+    record->timestamp_us           = time_us_32();
+    record->id                     = id;
+    record->core                   = core;
+    record->phase                  = phase;
+    record->arg                    = arg;
+    ring->head                     = head + 1;
+  }
+
+  restore_interrupts(status);
+}
+
+void perf_trace_dump() {
+  perf_trace_paused = true;
+  __dmb();
+  // A record the other core started before it saw the flag takes well under this
+  busy_wait_us_32(10);
+
+  for (uint core = 0; core < NUM_CORES; core++) {
+    struct PerfTraceRing *ring  = &perf_trace_rings[core];
+    uint32_t              head  = ring->head;
+    uint32_t              count = head < PERF_TRACE_RING_RECORDS ? head : PERF_TRACE_RING_RECORDS;
+
+    printf("perftrace %u %u %u\n", core, count, head - count);
+    for (uint32_t i = head - count; i != head; i++) {
+      const struct PerfTraceRecord *record = &ring->records[i & PERF_TRACE_RING_MASK];
+      printf("%08x %04x %02x %08x\n", record->timestamp_us, record->id, record->phase, record->arg);
+    }
+    printf("perftrace end\n");
+    ring->head = 0;
+  }
+
+  __dmb();
+  perf_trace_paused = false;
+}
+
+void perf_trace_task(void *params) {
+  while (1) {
+    int c = getchar_timeout_us(0);
+    if (c == PERF_TRACE_DUMP_COMMAND) {
+      perf_trace_dump();
+    } else if (c == PICO_ERROR_TIMEOUT) {
+      vTaskDelay(pdMS_TO_TICKS(PERF_TRACE_POLL_MS));
+    }
+  }
+}
+
+#endif  // PERF_TRACE
@@ -0,0 +1,69 @@
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include "stdint.h"
+
+// Timeline tracing. Spans and instant events are stored with the core and a microsecond timestamp
+// in a per-core ring that keeps the most recent PERF_TRACE_RING_RECORDS. perf_trace_dump() prints
+// the rings over USB serial, and tools/perf_trace.py turns the dump into Chrome trace JSON for
+// ui.perfetto.dev or chrome://tracing, with both cores on one timeline.
+//
+// Spans are matched by ID and argument, so a span can begin in a task and end in an interrupt on
+// either core, and spans on different buses or emitters can overlap. Build with -DPERF_TRACE=ON.
+// Without it the macros compile to nothing and none of this takes any RAM.
+
+#ifndef PERF_TRACE
+#define PERF_TRACE 0
+#endif
+
+#define PERF_TRACE_RING_RECORDS 512  // Per core, must be a power of two
+
+enum PerfTraceId {
+#define PERF_TRACE_EVENT(id, name) id,
+#include "perf_trace_events.def"
+#undef PERF_TRACE_EVENT
+  PERF_TRACE_EVENT_COUNT,
+};
+
+// The Chrome trace event phases
+enum PerfTracePhase {
+  PERF_TRACE_BEGIN   = 'B',
+  PERF_TRACE_END     = 'E',
+  PERF_TRACE_INSTANT = 'i',
+};
+
+struct PerfTraceRecord {
+  uint32_t timestamp_us;
+  uint16_t id;
+  uint8_t  core;
+  uint8_t  phase;
+  uint32_t arg;  // Which emitter, bus or similar. Begin and end must agree.
+};
+
+#if PERF_TRACE
+
+// Safe from tasks and ISRs on either core
+void perf_trace_record(uint16_t id, uint8_t phase, uint32_t arg);
+
+#define PERF_TRACE_SPAN_BEGIN(id, arg) perf_trace_record((id), PERF_TRACE_BEGIN, (uint32_t)(arg))
+#define PERF_TRACE_SPAN_END(id, arg)   perf_trace_record((id), PERF_TRACE_END, (uint32_t)(arg))
+#define PERF_TRACE_INSTANT(id, arg)    perf_trace_record((id), PERF_TRACE_INSTANT, (uint32_t)(arg))
+
+// Prints both rings, oldest record first, and empties them. Recording pauses while it runs.
+//   perftrace <core> <records> <records overwritten since the last dump>
+//   <timestamp> <id> <phase> <arg>   one record per line, in hex
+//   perftrace end
+void perf_trace_dump();
+
+// Dumps the rings each time a 't' arrives on the serial console
+void perf_trace_task(void *params);
+
+#else
+
+#define PERF_TRACE_SPAN_BEGIN(id, arg) ((void)0)
+#define PERF_TRACE_SPAN_END(id, arg)   ((void)0)
+#define PERF_TRACE_INSTANT(id, arg)    ((void)0)
+
+#endif  // PERF_TRACE
+
+#endif  // PERF_TRACE_H
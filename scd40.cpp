@@ -0,0 +1,191 @@
+#include "scd4x.hpp"
+
+extern "C" {
+#include "hardware/i2c.h"
+#include "pico/binary_info.h"
+#include "scd40.h"
+}
+
+// https://d2air1d4eqhwg2.cloudfront.net/media/files/262fda6e-3a57-4326-b93d-a9d627defdc4.pdf
+
+// The C API below wraps one SCD40 on the default bus, see scd4x.hpp for the driver itself
+
+#define SCD40_I2C_INDEX    PICO_DEFAULT_I2C
+#define SCD40_I2C_BAUDRATE (400 * 1000)  // Fast mode, the fastest the SCD4x supports
+
+using Scd40Bus = scd4x::I2cAsyncBus<SCD40_I2C_INDEX>;
+using Scd40    = scd4x::Scd4x<Scd40Bus, scd4x::Variant::kScd40>;
+using scd4x::CommandId;
+using scd4x::Response;
+
+static Scd40 scd40;
+
+void scd40_init(bool enable_internal_pullup) {
+  Scd40Bus::init(SCD40_I2C_BAUDRATE);
+  gpio_set_function(PICO_DEFAULT_I2C_SDA_PIN, GPIO_FUNC_I2C);
+  gpio_set_function(PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C);
+  if (enable_internal_pullup) {
+    gpio_pull_up(PICO_DEFAULT_I2C_SDA_PIN);
+    gpio_pull_up(PICO_DEFAULT_I2C_SCL_PIN);
+  }
+  // Populate metadata in the binary for picotool
+  bi_decl(bi_2pins_with_func(PICO_DEFAULT_I2C_SDA_PIN, PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C));
+
+  sleep_ms(1000);  // Wait for powerup
+}
+
+//////////////////////////
+// Header Only Commands //
+//////////////////////////
+
+int32_t scd40_start_periodic_measurement() {
+  return scd40.start_periodic_measurement();
+}
+
+int32_t scd40_start_low_power_periodic_measurement() {
+  return scd40.start_low_power_periodic_measurement();
+}
+
+int32_t scd40_stop_periodic_measurement() {
+  return scd40.stop_periodic_measurement();
+}
+
+int32_t scd40_perform_factory_reset() {
+  return scd40.send<CommandId::kPerformFactoryReset>();
+}
+
+int32_t scd40_reinit() {
+  return scd40.send<CommandId::kReinit>();
+}
+
+// The SCD40 doesn't have the single shot commands, so scd40.measure_single_shot() doesn't compile
+// here. The C API keeps the entry points for an SCD41 build.
+int32_t scd40_measure_single_shot() {
+  return PICO_ERROR_VERSION_MISMATCH;
+}
+
+int32_t scd40_measure_single_shot_rht_only() {
+  return PICO_ERROR_VERSION_MISMATCH;
+}
+
+////////////////////////
+// Read Only Commands //
+////////////////////////
+
+// The sensor NACKs this if no new sample is waiting, see scd40_get_data_ready_status()
+int32_t scd40_read_measurement_raw(uint16_t *co2_ppm, uint16_t *temp_raw, uint16_t *humidity_raw) {
+  Response<CommandId::kReadMeasurement> output{};
+
+  int32_t err = scd40.read<CommandId::kReadMeasurement>(output);
+
+  *co2_ppm      = output[0];  // CO2 doesn't require post-processing
+  *temp_raw     = output[1];
+  *humidity_raw = output[2];
+
+  return err;
+}
+
+int32_t scd40_read_measurement(uint16_t *co2_ppm, int16_t *temp_centi_cel,
+                               uint16_t *humidity_centi_percent) {
+  uint16_t temp_raw;
+  uint16_t humidity_raw;
+
+  int32_t err = scd40_read_measurement_raw(co2_ppm, &temp_raw, &humidity_raw);
+
+  *humidity_centi_percent = scd40_humidity_centi_percent(humidity_raw);  // Apply post-processing
+  *temp_centi_cel         = scd40_temperature_centi_cel(temp_raw);       // Apply post-processing
+
+  return err;
+}
+
+int32_t scd40_get_temperature_offset(uint16_t *offset_centi_cel) {
+  Response<CommandId::kGetTemperatureOffset> output{};
+
+  int32_t err = scd40.read<CommandId::kGetTemperatureOffset>(output);
+
+  *offset_centi_cel = scd40_temperature_offset_centi_cel(output[0]);  // Apply post-processing
+
+  return err;
+}
+
+int32_t scd40_get_sensor_altitude(uint16_t *altitude_meters) {
+  Response<CommandId::kGetSensorAltitude> output{};
+
+  int32_t err = scd40.read<CommandId::kGetSensorAltitude>(output);
+
+  *altitude_meters = output[0];
+
+  return err;
+}
+
+int32_t scd40_get_automatic_self_calibration_enabled(bool *self_calibration_enabled) {
+  Response<CommandId::kGetAutomaticSelfCalibrationEnabled> output{};
+
+  int32_t err = scd40.read<CommandId::kGetAutomaticSelfCalibrationEnabled>(output);
+
+  *self_calibration_enabled = output[0] == 1;
+
+  return err;
+}
+
+int32_t scd40_get_data_ready_status(bool *data_waiting) {
+  Response<CommandId::kGetDataReadyStatus> output{};
+
+  int32_t err = scd40.read<CommandId::kGetDataReadyStatus>(output);
+
+  *data_waiting = scd4x::data_ready(output[0]);
+  EVENT_LOG1(LOG_SCD40_DATA_READY, output[0]);
+
+  return err;
+}
+
+int32_t scd40_get_serial_number(uint16_t *serial_number) {
+  Response<CommandId::kGetSerialNumber> output{};
+
+  int32_t err = scd40.read<CommandId::kGetSerialNumber>(output);
+
+  serial_number[0] = output[0];
+  serial_number[1] = output[1];
+  serial_number[2] = output[2];
+
+  EVENT_LOG3(LOG_SCD40_SERIAL, serial_number[0], serial_number[1], serial_number[2]);
+
+  return err;
+}
+
+int32_t scd40_perform_self_test() {
+  Response<CommandId::kPerformSelfTest> output{};
+
+  int32_t err = scd40.read<CommandId::kPerformSelfTest>(output);
+
+  // Any non-zero word means a malfunction was detected
+  if (err == PICO_ERROR_NONE && output[0] != 0) {
+    EVENT_LOG1(LOG_SCD40_SELF_TEST_FAILED, output[0]);
+    err = PICO_ERROR_GENERIC;
+  }
+
+  return err;
+}
+
+/////////////////////////
+// Write Only Commands //
+/////////////////////////
+
+int32_t scd40_set_temperature_offset(uint16_t offset_centi_cel) {
+  uint16_t offset_raw = scd40_temperature_offset_raw(offset_centi_cel);
+  return scd40.write<CommandId::kSetTemperatureOffset>(offset_raw);
+}
+
+int32_t scd40_set_sensor_altitude(uint16_t altitude) {
+  return scd40.write<CommandId::kSetSensorAltitude>(altitude);
+}
+
+int32_t scd40_set_ambient_pressure(uint16_t pressure_pa) {
+  uint16_t post_processed_pressure = pressure_pa / 100;
+  return scd40.write<CommandId::kSetAmbientPressure>(post_processed_pressure);
+}
+
+int32_t scd40_set_automatic_self_calibration_enabled(bool enabled) {
+  uint16_t self_calibration_status = enabled ? 1 : 0;
+  return scd40.write<CommandId::kSetAutomaticSelfCalibrationEnabled>(self_calibration_status);
+}
@@ -2,8 +2,13 @@
 #define SCD40_H
 
 #include "pico/stdlib.h"
+#include "scd40_convert.h"
 #include "stdint.h"
 
+// Sets up the I2C bus for asynchronous transfers and waits for the sensor to power up. Commands
+// block the calling task until the sensor responds, but the CPU is free while they wait.
+void scd40_init(bool enable_internal_pullup);
+
 // Header Only Commands
 int32_t scd40_start_periodic_measurement();
 int32_t scd40_start_low_power_periodic_measurement();
@@ -14,8 +19,12 @@ int32_t scd40_measure_single_shot();
 int32_t scd40_measure_single_shot_rht_only();
 
 // Read Only Commands
-int32_t scd40_read_measurement(uint16_t *co2_ppm, uint16_t *temp_cel, uint16_t *rel_humidity);
-int32_t scd40_get_temperature_offset(uint16_t *temp_offset);
+// Temperatures are in hundredths of a degree and humidity in hundredths of a percent, see
+// scd40_convert.h
+int32_t scd40_read_measurement(uint16_t *co2_ppm, int16_t *temp_centi_cel,
+                               uint16_t *humidity_centi_percent);
+int32_t scd40_read_measurement_raw(uint16_t *co2_ppm, uint16_t *temp_raw, uint16_t *humidity_raw);
+int32_t scd40_get_temperature_offset(uint16_t *offset_centi_cel);
 int32_t scd40_get_sensor_altitude(uint16_t *altitude_meters);
 int32_t scd40_get_automatic_self_calibration_enabled(bool *self_calibration_enabled);
 int32_t scd40_get_data_ready_status(bool *data_waiting);
@@ -23,7 +32,7 @@ int32_t scd40_get_serial_number(uint16_t *serial_number);
 int32_t scd40_perform_self_test();
 
 // Write Only Commands
-int32_t scd40_set_temperature_offset(uint16_t offset);
+int32_t scd40_set_temperature_offset(uint16_t offset_centi_cel);
 int32_t scd40_set_sensor_altitude(uint16_t altitude);
 int32_t scd40_set_ambient_pressure(uint16_t pressure_pa);
 int32_t scd40_set_automatic_self_calibration_enabled(bool enabled);
@@ -0,0 +1,94 @@
+#include "scd40_cadence.h"
+
+#include "event_log.h"
+#include "hardware/sync.h"
+#include "task.h"
+
+#define SCD40_CADENCE_PERIOD_MS           5000
+#define SCD40_CADENCE_LOW_POWER_PERIOD_MS 30000
+// Wake a little after the samples are due, so the sensors' clocks can run slightly slower than ours
+#define SCD40_CADENCE_MARGIN_MS      50
+#define SCD40_CADENCE_RETRY_MS       100
+#define SCD40_CADENCE_MAX_RESTART_MS 60000
+
+void scd40_slot_publish(struct Scd40SampleSlot *slot, const struct Scd40Sample *sample) {
+  uint32_t status   = save_and_disable_interrupts();
+  uint32_t sequence = slot->sequence;
+
+  slot->sequence = sequence + 1;
+  __dmb();
+  slot->sample = *sample;
+  __dmb();
+  slot->sequence = sequence + 2;
+
+  restore_interrupts(status);
+}
+
+bool scd40_slot_latest(const struct Scd40SampleSlot *slot, struct Scd40Sample *sample) {
+  uint32_t sequence;
+  do {
+    sequence = slot->sequence;
+    __dmb();
+    *sample = slot->sample;
+    __dmb();
+  } while ((sequence & 1) || sequence != slot->sequence);
+
+  return sequence != 0;
+}
+
+void scd40_cadence_start(struct Scd40Cadence *cadence, enum Scd40ServiceMode mode) {
+  cadence->period_ms = mode == SCD40_SERVICE_LOW_POWER_PERIODIC ?
+                           SCD40_CADENCE_LOW_POWER_PERIOD_MS :
+                           SCD40_CADENCE_PERIOD_MS;
+  cadence->wake      = xTaskGetTickCount() + pdMS_TO_TICKS(SCD40_CADENCE_MARGIN_MS);
+}
+
+uint32_t scd40_cadence_next(struct Scd40Cadence *cadence, uint32_t waiting, Scd40CadencePoll poll,
+                            void *context) {
+  // After an overrun, skip whole periods to the latest samples instead of polling for stale ones
+  TickType_t period = pdMS_TO_TICKS(cadence->period_ms);
+  while ((int32_t)(xTaskGetTickCount() - (cadence->wake + 2 * period)) >= 0) {
+    cadence->wake += period;
+  }
+  vTaskDelayUntil(&cadence->wake, period);
+
+  for (uint32_t waited_ms = 0; waiting && waited_ms < cadence->period_ms;
+       waited_ms += SCD40_CADENCE_RETRY_MS) {
+    waiting &= ~poll(waiting, context);
+    if (!waiting) {
+      if (waited_ms > 0) {
+        // A sensor has drifted behind us, so follow the slowest one from here. Its sample landed
+        // since the last poll, so the next one is due a period from now and we wake the margin
+        // after it.
+        cadence->wake = xTaskGetTickCount() + pdMS_TO_TICKS(SCD40_CADENCE_MARGIN_MS);
+      }
+      break;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SCD40_CADENCE_RETRY_MS));
+  }
+
+  return waiting;
+}
+
+void scd40_cadence_stamp(const struct Scd40Cadence *cadence, struct Scd40ServiceStats *counters,
+                         uint32_t *last_read_us, uint32_t now_us, struct Scd40Sample *sample) {
+  // Only the latest sample is buffered, anything older than a period was overwritten unread
+  uint32_t period_us = cadence->period_ms * 1000;
+  uint32_t elapsed   = now_us - *last_read_us;
+  if (counters->samples > 0 && elapsed > period_us + period_us / 2) {
+    counters->missed_samples += (elapsed + period_us / 2) / period_us - 1;
+    EVENT_LOG1(LOG_SCD40_MISSED_SAMPLES, (elapsed + period_us / 2) / period_us - 1);
+  }
+  *last_read_us = now_us;
+
+  sample->timestamp_us = now_us;
+  sample->index        = counters->samples;
+  counters->samples++;
+}
+
+uint32_t scd40_cadence_backoff(uint32_t *backoff_ms) {
+  uint32_t wait_ms = *backoff_ms;
+  *backoff_ms      = 2 * wait_ms < SCD40_CADENCE_MAX_RESTART_MS ? 2 * wait_ms :
+                                                                  SCD40_CADENCE_MAX_RESTART_MS;
+  return wait_ms;
+}
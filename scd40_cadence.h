@@ -0,0 +1,57 @@
+#ifndef SCD40_CADENCE_H
+#define SCD40_CADENCE_H
+
+#include "FreeRTOS.h"
+#include "pico/stdlib.h"
+#include "scd40_service.h"
+#include "stdint.h"
+
+// What scd40_service.c and scd4x_poller.cpp share: following the sensors' measurement period,
+// publishing each sensor's latest sample and backing off between start attempts. Sensors are
+// named by bit in the masks below, the service's one sensor being bit 0.
+
+// Seqlock around one published sample. The owning task is the only writer, so it needs no lock
+// of its own. The sequence is odd while an update is in progress; readers retry until they see
+// the same even value on both sides of their copy. That needs no atomic read-modify-write, which
+// the Cortex-M0+ doesn't have. The update runs with interrupts masked so a reader on the writer's
+// own core can never preempt it and spin on a sequence that won't move.
+struct Scd40SampleSlot {
+  volatile uint32_t  sequence;
+  struct Scd40Sample sample;
+};
+
+void scd40_slot_publish(struct Scd40SampleSlot *slot, const struct Scd40Sample *sample);
+
+// Returns false if nothing has been published yet. Safe from any task or ISR on either core.
+bool scd40_slot_latest(const struct Scd40SampleSlot *slot, struct Scd40Sample *sample);
+
+struct Scd40Cadence {
+  uint32_t   period_ms;
+  TickType_t wake;  // The last wakeup, a margin after the samples it was for
+};
+
+// Queries the sensors in `waiting` and reads the ones with a sample ready. Counts the rest as
+// not ready. Returns the sensors that were ready, whether or not their read succeeded.
+typedef uint32_t (*Scd40CadencePoll)(uint32_t waiting, void *context);
+
+// Call as the start commands go out. The first samples are due a period later.
+void scd40_cadence_start(struct Scd40Cadence *cadence, enum Scd40ServiceMode mode);
+
+// Sleeps until the next samples are due, then polls until none of `waiting` is left or a period
+// has gone by. Returns the sensors still waiting. A wakeup that had to poll again re-aligns the
+// cadence to the slowest sensor.
+uint32_t scd40_cadence_next(struct Scd40Cadence *cadence, uint32_t waiting, Scd40CadencePoll poll,
+                            void *context);
+
+// Fills in the sample's timestamp and index and counts it, along with any samples the sensor
+// produced since `*last_read_us` that were never read.
+void scd40_cadence_stamp(const struct Scd40Cadence *cadence, struct Scd40ServiceStats *counters,
+                         uint32_t *last_read_us, uint32_t now_us, struct Scd40Sample *sample);
+
+#define SCD40_CADENCE_RESTART_MS 500  // The sensor takes 500ms to stop measuring
+
+// Returns the wait before the next start attempt, and doubles it for the one after up to a minute.
+// Start `*backoff_ms` at SCD40_CADENCE_RESTART_MS.
+uint32_t scd40_cadence_backoff(uint32_t *backoff_ms);
+
+#endif  // SCD40_CADENCE_H
@@ -0,0 +1,8 @@
+#include "scd40_convert.h"
+
+void scd40_convert_batch(const struct Scd40RawMeasurement *raw,
+                         struct Scd40Measurement *measurements, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    scd40_convert(&raw[i], &measurements[i]);
+  }
+}
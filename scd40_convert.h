@@ -0,0 +1,64 @@
+#ifndef SCD40_CONVERT_H
+#define SCD40_CONVERT_H
+
+#include "stddef.h"
+#include "stdint.h"
+
+// Fixed point conversions for SCD40 readings, in hundredths of a degree and of a percent. The
+// Cortex-M0+ has no divider and the RP2040's is a shared peripheral, so these only multiply and
+// shift. Every result is the exact rounded value of the datasheet formula:
+//   temperature = -45 + 175 * raw / 65536 [C]
+//   humidity    = 100 * raw / 65536 [%]
+//   offset      = 175 * raw / 65536 [C]
+
+#define SCD40_TEMPERATURE_OFFSET_MAX_CENTI_CEL 17500
+
+struct Scd40RawMeasurement {
+  uint16_t co2_ppm;
+  uint16_t temperature_raw;
+  uint16_t humidity_raw;
+};
+
+struct Scd40Measurement {
+  uint16_t co2_ppm;
+  int16_t  temperature_centi_cel;   // -4500 to 13000
+  uint16_t humidity_centi_percent;  // 0 to 10000
+};
+
+static inline int16_t scd40_temperature_centi_cel(uint16_t raw) {
+  return (int16_t)(-4500 + (int32_t)((17500u * raw + 0x8000) >> 16));
+}
+
+static inline uint16_t scd40_humidity_centi_percent(uint16_t raw) {
+  return (uint16_t)((10000u * raw + 0x8000) >> 16);
+}
+
+static inline uint16_t scd40_temperature_offset_centi_cel(uint16_t raw) {
+  return (uint16_t)((17500u * raw + 0x8000) >> 16);
+}
+
+// Inverse of scd40_temperature_offset_centi_cel(), for writing the offset. Clamped to what the
+// sensor can represent.
+static inline uint16_t scd40_temperature_offset_raw(uint16_t centi_cel) {
+  if (centi_cel > SCD40_TEMPERATURE_OFFSET_MAX_CENTI_CEL) {
+    centi_cel = SCD40_TEMPERATURE_OFFSET_MAX_CENTI_CEL;
+  }
+  // round(centi * 65536 / 17500) is floor((32768 * centi + 4375) / 8750). The division is by a
+  // reciprocal that is exact for every numerator in range.
+  uint32_t numerator = 32768u * centi_cel + 4375;
+  uint32_t raw       = (uint32_t)(((uint64_t)numerator * 125658472u) >> 40);
+  return raw > UINT16_MAX ? UINT16_MAX : (uint16_t)raw;
+}
+
+static inline void scd40_convert(const struct Scd40RawMeasurement *raw,
+                                 struct Scd40Measurement *measurement) {
+  measurement->co2_ppm                = raw->co2_ppm;
+  measurement->temperature_centi_cel  = scd40_temperature_centi_cel(raw->temperature_raw);
+  measurement->humidity_centi_percent = scd40_humidity_centi_percent(raw->humidity_raw);
+}
+
+// Converts `count` samples at once, for logging a backlog
+void scd40_convert_batch(const struct Scd40RawMeasurement *raw,
+                         struct Scd40Measurement *measurements, size_t count);
+
+#endif  // SCD40_CONVERT_H
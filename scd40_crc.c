@@ -0,0 +1,67 @@
+#include "scd40_crc.h"
+
+#include "pico/stdlib.h"
+
+// One step of the bitwise CRC, used to generate the tables at compile time
+#define CRC8_BIT(c)   ((((c) << 1) ^ (((c) & 0x80) ? CRC8_POLYNOMIAL : 0)) & 0xFF)
+#define CRC8_BITS2(c) CRC8_BIT(CRC8_BIT(c))
+#define CRC8_BITS4(c) CRC8_BITS2(CRC8_BITS2(c))
+#define CRC8_BITS8(c) CRC8_BITS4(CRC8_BITS4(c))
+
+#if SCD40_CRC_NIBBLE_TABLE
+
+#define CRC8_NIBBLE(n) CRC8_BITS4((n) << 4)
+
+static const uint8_t crc8_table[16] = {
+    CRC8_NIBBLE(0x0), CRC8_NIBBLE(0x1), CRC8_NIBBLE(0x2), CRC8_NIBBLE(0x3),
+    CRC8_NIBBLE(0x4), CRC8_NIBBLE(0x5), CRC8_NIBBLE(0x6), CRC8_NIBBLE(0x7),
+    CRC8_NIBBLE(0x8), CRC8_NIBBLE(0x9), CRC8_NIBBLE(0xA), CRC8_NIBBLE(0xB),
+    CRC8_NIBBLE(0xC), CRC8_NIBBLE(0xD), CRC8_NIBBLE(0xE), CRC8_NIBBLE(0xF),
+};
+
+static inline uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+  crc ^= byte;
+  crc = (crc << 4) ^ crc8_table[crc >> 4];
+  crc = (crc << 4) ^ crc8_table[crc >> 4];
+  return crc;
+}
+
+#else
+
+#define CRC8_ROW(n)                                                                     \
+  CRC8_BITS8((n) + 0x0), CRC8_BITS8((n) + 0x1), CRC8_BITS8((n) + 0x2),                  \
+      CRC8_BITS8((n) + 0x3), CRC8_BITS8((n) + 0x4), CRC8_BITS8((n) + 0x5),              \
+      CRC8_BITS8((n) + 0x6), CRC8_BITS8((n) + 0x7), CRC8_BITS8((n) + 0x8),              \
+      CRC8_BITS8((n) + 0x9), CRC8_BITS8((n) + 0xA), CRC8_BITS8((n) + 0xB),              \
+      CRC8_BITS8((n) + 0xC), CRC8_BITS8((n) + 0xD), CRC8_BITS8((n) + 0xE), CRC8_BITS8((n) + 0xF)
+
+static const uint8_t crc8_table[256] = {
+    CRC8_ROW(0x00), CRC8_ROW(0x10), CRC8_ROW(0x20), CRC8_ROW(0x30),
+    CRC8_ROW(0x40), CRC8_ROW(0x50), CRC8_ROW(0x60), CRC8_ROW(0x70),
+    CRC8_ROW(0x80), CRC8_ROW(0x90), CRC8_ROW(0xA0), CRC8_ROW(0xB0),
+    CRC8_ROW(0xC0), CRC8_ROW(0xD0), CRC8_ROW(0xE0), CRC8_ROW(0xF0),
+};
+
+static inline uint8_t crc8_update(uint8_t crc, uint8_t byte) { return crc8_table[crc ^ byte]; }
+
+#endif
+
+uint8_t scd40_crc(const uint8_t *data, uint16_t count) {
+  uint8_t crc = CRC8_INIT;
+  for (uint16_t i = 0; i < count; i++) {
+    crc = crc8_update(crc, data[i]);
+  }
+  return crc;
+}
+
+int32_t scd40_crc_unpack_words(const uint8_t *raw, uint8_t words, uint8_t *out) {
+  // Accumulate mismatches rather than bailing out early, so every block is a fixed cost
+  uint8_t mismatch = 0;
+  for (uint8_t i = 0; i < words; i++) {
+    const uint8_t *block = &raw[3 * i];
+    mismatch |= crc8_update(crc8_update(CRC8_INIT, block[0]), block[1]) ^ block[2];
+    out[2 * i]     = block[0];
+    out[2 * i + 1] = block[1];
+  }
+  return mismatch ? PICO_ERROR_INVALID_DATA : PICO_ERROR_NONE;
+}
@@ -0,0 +1,19 @@
+#ifndef SCD40_CRC_H
+#define SCD40_CRC_H
+
+#include "stdint.h"
+
+// CRC-8 used by the SCD4x for every 16 bit word (polynomial 0x31, init 0xFF, no reflection).
+// Table driven. Define SCD40_CRC_NIBBLE_TABLE to trade speed for a 16 byte table instead of
+// the 256 byte one.
+
+#define CRC8_POLYNOMIAL 0x31
+#define CRC8_INIT       0xFF
+
+uint8_t scd40_crc(const uint8_t *data, uint16_t count);
+
+// Checks a response made of `words` [MSB, LSB, CRC] blocks in one pass and copies the data bytes
+// to `out` (2 bytes per word). Returns PICO_ERROR_INVALID_DATA if any block's CRC is wrong.
+int32_t scd40_crc_unpack_words(const uint8_t *raw, uint8_t words, uint8_t *out);
+
+#endif  // SCD40_CRC_H
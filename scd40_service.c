@@ -0,0 +1,100 @@
+#include "scd40_service.h"
+
+#include "FreeRTOS.h"
+#include "event_log.h"
+#include "scd40.h"
+#include "scd40_cadence.h"
+#include "task.h"
+
+static struct Scd40Cadence scd40_service_cadence;
+static uint32_t            scd40_service_last_read_us;
+
+static struct Scd40ServiceStats scd40_service_counters;
+static struct Scd40SampleSlot   scd40_service_slot;
+
+bool scd40_service_latest(struct Scd40Sample *sample) {
+  return scd40_slot_latest(&scd40_service_slot, sample);
+}
+
+void scd40_service_stats(struct Scd40ServiceStats *stats) { *stats = scd40_service_counters; }
+
+int32_t scd40_service_start(enum Scd40ServiceMode mode) {
+  int32_t err = mode == SCD40_SERVICE_LOW_POWER_PERIODIC ?
+                    scd40_start_low_power_periodic_measurement() :
+                    scd40_start_periodic_measurement();
+
+  scd40_cadence_start(&scd40_service_cadence, mode);
+  scd40_service_last_read_us = time_us_32();
+  if (err) {
+    scd40_service_counters.errors++;
+  }
+
+  return err;
+}
+
+// The one sensor is bit 0 of the cadence's masks
+static uint32_t scd40_service_poll(uint32_t waiting, void *context) {
+  bool    ready = false;
+  int32_t err   = scd40_get_data_ready_status(&ready);
+  if (err) {
+    scd40_service_counters.errors++;
+  }
+  if (!ready) {
+    scd40_service_counters.not_ready++;
+  }
+  return ready;
+}
+
+int32_t scd40_service_step() {
+  if (scd40_cadence_next(&scd40_service_cadence, 1, scd40_service_poll, NULL)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+
+  struct Scd40Sample sample;
+  uint32_t           start_us = time_us_32();
+
+  int32_t err =
+      scd40_read_measurement_raw(&sample.co2_ppm, &sample.temperature_raw, &sample.humidity_raw);
+  if (err) {
+    scd40_service_counters.errors++;
+    return err;
+  }
+
+  uint32_t now_us = time_us_32();
+
+  sample.temperature_centi_cel  = scd40_temperature_centi_cel(sample.temperature_raw);
+  sample.humidity_centi_percent = scd40_humidity_centi_percent(sample.humidity_raw);
+
+  uint32_t latency = now_us - start_us;
+
+  scd40_service_counters.last_read_latency_us = latency;
+  if (latency > scd40_service_counters.max_read_latency_us) {
+    scd40_service_counters.max_read_latency_us = latency;
+  }
+
+  scd40_cadence_stamp(&scd40_service_cadence, &scd40_service_counters,
+                      &scd40_service_last_read_us, now_us, &sample);
+  scd40_slot_publish(&scd40_service_slot, &sample);
+  EVENT_LOG3(LOG_SCD40_SAMPLE, sample.co2_ppm, sample.temperature_raw, sample.humidity_raw);
+
+  return PICO_ERROR_NONE;
+}
+
+void scd40_service_task(void *params) {
+  enum Scd40ServiceMode mode = (enum Scd40ServiceMode)(uintptr_t)params;
+
+  scd40_init(false);
+  uint32_t backoff_ms = SCD40_CADENCE_RESTART_MS;
+  int32_t  err;
+  while ((err = scd40_service_start(mode)) != PICO_ERROR_NONE) {
+    // Measurement may still be running from before a reset, which rejects the start command. A
+    // sensor that's missing fails both, so don't hammer the bus while it stays away.
+    EVENT_LOG2(LOG_SCD40_START_FAILED, err, backoff_ms);
+    scd40_stop_periodic_measurement();
+    vTaskDelay(pdMS_TO_TICKS(scd40_cadence_backoff(&backoff_ms)));
+  }
+
+  while (1) {
+    scd40_service_step();
+  }
+}
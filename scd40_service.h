@@ -0,0 +1,52 @@
+#ifndef SCD40_SERVICE_H
+#define SCD40_SERVICE_H
+
+#include "pico/stdlib.h"
+#include "scd40_convert.h"
+#include "stdint.h"
+
+// Owns the SCD40. The service task keeps the sensor measuring, reads each new sample once and
+// publishes it, so any task on either core can get the latest values without touching the bus.
+
+enum Scd40ServiceMode {
+  SCD40_SERVICE_PERIODIC,            // A sample every 5s
+  SCD40_SERVICE_LOW_POWER_PERIODIC,  // A sample every 30s
+};
+
+struct Scd40Sample {
+  uint32_t timestamp_us;  // When the sample was read
+  uint32_t index;         // Samples published before this one
+  uint16_t co2_ppm;
+  uint16_t temperature_raw;  // As read, for logging
+  uint16_t humidity_raw;
+  int16_t  temperature_centi_cel;
+  uint16_t humidity_centi_percent;
+};
+
+struct Scd40ServiceStats {
+  uint32_t samples;         // Samples read and published
+  uint32_t missed_samples;  // Samples the sensor produced that were never read
+  uint32_t not_ready;       // Wakeups that found no new sample and had to poll again
+  uint32_t errors;          // Failed commands
+  uint32_t last_read_latency_us;
+  uint32_t max_read_latency_us;
+};
+
+// Copies out the latest sample without blocking. Returns false if nothing has been published yet.
+// Safe from any task or ISR on either core.
+bool scd40_service_latest(struct Scd40Sample *sample);
+
+// Counters are updated by the service task only, individually consistent
+void scd40_service_stats(struct Scd40ServiceStats *stats);
+
+// Starts measuring and aligns the service to the sensor's cadence
+int32_t scd40_service_start(enum Scd40ServiceMode mode);
+
+// One wakeup of the service: waits for the next sample, reads it and publishes it. The task
+// calls this in a loop. Exposed for harnesses that step the service themselves.
+int32_t scd40_service_step();
+
+// `params` is the enum Scd40ServiceMode, cast to a pointer
+void scd40_service_task(void *params);
+
+#endif  // SCD40_SERVICE_H
@@ -0,0 +1,336 @@
+#ifndef SCD4X_HPP
+#define SCD4X_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// The C modules and the host shims have no C++ guards of their own
+extern "C" {
+#include "event_log.h"
+#include "i2c_async.h"
+#include "pico/stdlib.h"
+#include "scd40_crc.h"
+}
+
+// SCD4x driver specialised at compile time for a bus and a sensor variant. Every command's
+// opcode, execution time and word counts come from a constexpr table, so a call compiles down to
+// immediates and a response decoder unrolled for its length. Commands the variant doesn't have
+// are a compile error. Whether a command is legal during periodic measurement depends on what ran
+// before, so that stays a runtime check, but it is only emitted for the commands it applies to.
+
+namespace scd4x {
+
+enum class Variant { kScd40, kScd41 };
+
+enum class CommandId : uint8_t {
+  // Basic Commands
+  kStartPeriodicMeasurement,
+  kReadMeasurement,
+  kStopPeriodicMeasurement,
+
+  // On-chip Output Signal Compensation
+  kSetTemperatureOffset,
+  kGetTemperatureOffset,
+  kSetSensorAltitude,
+  kGetSensorAltitude,
+  kSetAmbientPressure,
+
+  // Field Calibration
+  kPerformForcedRecalibration,
+  kSetAutomaticSelfCalibrationEnabled,
+  kGetAutomaticSelfCalibrationEnabled,
+
+  // Low Power
+  kStartLowPowerPeriodicMeasurement,
+  kGetDataReadyStatus,
+
+  // Advanced Features
+  kPersistSettings,
+  kGetSerialNumber,
+  kPerformSelfTest,
+  kPerformFactoryReset,
+  kReinit,
+
+  // Low Power Single Shot (SCD41 only)
+  kMeasureSingleShot,
+  kMeasureSingleShotRhtOnly,
+
+  kCount,
+};
+
+struct Command {
+  CommandId id;
+  uint16_t  opcode;
+  uint16_t  delay_ms;     // Execution time before the response or the next command
+  uint8_t   write_words;  // Data words sent after the opcode
+  uint8_t   read_words;   // Response words
+  bool      allowed_during_periodic;
+  bool      scd41_only;
+};
+
+// Execution times and restrictions from the datasheet
+inline constexpr Command kCommands[] = {
+    {CommandId::kStartPeriodicMeasurement, 0x21B1, 0, 0, 0, false, false},
+    {CommandId::kReadMeasurement, 0xEC05, 1, 0, 3, true, false},
+    {CommandId::kStopPeriodicMeasurement, 0x3F86, 500, 0, 0, true, false},
+    {CommandId::kSetTemperatureOffset, 0x241D, 1, 1, 0, false, false},
+    {CommandId::kGetTemperatureOffset, 0x2318, 1, 0, 1, false, false},
+    {CommandId::kSetSensorAltitude, 0x2427, 1, 1, 0, false, false},
+    {CommandId::kGetSensorAltitude, 0x2322, 1, 0, 1, false, false},
+    {CommandId::kSetAmbientPressure, 0xE000, 1, 1, 0, true, false},
+    {CommandId::kPerformForcedRecalibration, 0x362F, 400, 1, 1, false, false},
+    {CommandId::kSetAutomaticSelfCalibrationEnabled, 0x2416, 1, 1, 0, false, false},
+    {CommandId::kGetAutomaticSelfCalibrationEnabled, 0x2313, 1, 0, 1, false, false},
+    {CommandId::kStartLowPowerPeriodicMeasurement, 0x21AC, 0, 0, 0, false, false},
+    {CommandId::kGetDataReadyStatus, 0xE4B8, 1, 0, 1, true, false},
+    {CommandId::kPersistSettings, 0x3615, 800, 0, 0, false, false},
+    {CommandId::kGetSerialNumber, 0x3682, 1, 0, 3, false, false},
+    {CommandId::kPerformSelfTest, 0x3639, 10000, 0, 1, false, false},
+    {CommandId::kPerformFactoryReset, 0x3632, 1200, 0, 0, false, false},
+    {CommandId::kReinit, 0x3646, 30, 0, 0, false, false},
+    {CommandId::kMeasureSingleShot, 0x219D, 5000, 0, 0, false, true},
+    {CommandId::kMeasureSingleShotRhtOnly, 0x2196, 50, 0, 0, false, true},
+};
+
+constexpr bool commands_in_order() {
+  for (size_t i = 0; i < std::size(kCommands); i++) {
+    if (kCommands[i].id != static_cast<CommandId>(i)) {
+      return false;
+    }
+  }
+  return std::size(kCommands) == static_cast<size_t>(CommandId::kCount);
+}
+static_assert(commands_in_order(), "kCommands must list every command in CommandId order");
+
+template <CommandId kId>
+inline constexpr Command kCommand = kCommands[static_cast<size_t>(kId)];
+
+// get_data_ready_status: a sample is waiting when any of bits 10:0 of the status word is set.
+// The bits above are unspecified and may read as set either way.
+inline constexpr uint16_t kDataReadyMask = 0x07FF;
+
+constexpr bool data_ready(uint16_t status) { return (status & kDataReadyMask) != 0; }
+
+template <CommandId kId>
+using Request = std::array<uint16_t, kCommand<kId>.write_words>;
+template <CommandId kId>
+using Response = std::array<uint16_t, kCommand<kId>.read_words>;
+
+///////////
+// Buses //
+///////////
+
+// A bus is anything with init(baudrate) and submit(transaction), where submit queues the
+// transaction and returns. The driver waits for completion itself, so commands block the calling
+// task, not the CPU, and commands started on different buses run at the same time.
+
+// A controller fixed at compile time
+template <uint kIndex>
+struct I2cAsyncBus {
+  static i2c_inst_t *instance() { return kIndex == 0 ? i2c0 : i2c1; }
+
+  static void init(uint baudrate) { i2c_async_init(instance(), baudrate); }
+
+  static int32_t submit(I2cAsyncTransaction *transaction) {
+    return i2c_async_submit(instance(), transaction);
+  }
+};
+
+// A controller chosen at run time, for tables of sensors
+struct I2cAsyncPort {
+  i2c_inst_t *i2c = nullptr;
+
+  uint index() const { return i2c_hw_index(i2c); }
+
+  void init(uint baudrate) const { i2c_async_init(i2c, baudrate); }
+
+  int32_t submit(I2cAsyncTransaction *transaction) const {
+    return i2c_async_submit(i2c, transaction);
+  }
+};
+
+////////////
+// Driver //
+////////////
+
+template <typename Bus, Variant kVariant>
+class Scd4x {
+ public:
+  static constexpr uint8_t kAddress = 0x62;
+
+  Scd4x() = default;
+  explicit Scd4x(Bus bus) : bus_(bus) {}
+
+  const Bus &bus() const { return bus_; }
+  bool       periodic() const { return periodic_; }
+
+  // A command in flight, see start()
+  template <CommandId kId>
+  struct Pending {
+    I2cAsyncTransaction                             transaction;
+    std::array<uint8_t, 3 * kCommand<kId>.read_words> raw;
+  };
+
+  // Runs any command in the table. The request and response sizes are the command's own.
+  template <CommandId kId>
+  int32_t command(const Request<kId> &request, Response<kId> &response) {
+    Pending<kId> pending;
+    int32_t      err = start<kId>(pending, request);
+    return err ? err : finish<kId>(pending, response);
+  }
+
+  // command() in two halves. start() queues the transaction and returns, finish() blocks until
+  // it completes and decodes the response. Both must run on the same task, and `pending` must
+  // stay put in between. Sensors on different buses can be started together and finished in any
+  // order, so they are all sampled in about the time of one.
+  template <CommandId kId>
+  int32_t start(Pending<kId> &pending, const Request<kId> &request) {
+    constexpr Command kCmd = kCommand<kId>;
+    static_assert(!kCmd.scd41_only || kVariant == Variant::kScd41, "Command needs an SCD41");
+    static_assert(2 + 3 * kCmd.write_words <= I2C_ASYNC_MAX_WRITE, "Request too long");
+    static_assert(3 * kCmd.read_words <= I2C_ASYNC_MAX_READ, "Response too long");
+
+    if constexpr (!kCmd.allowed_during_periodic) {
+      if (periodic_) {
+        return illegal_state(kCmd.opcode);
+      }
+    }
+
+    I2cAsyncTransaction &transaction = pending.transaction;
+    transaction                      = {};
+    transaction.address              = kAddress;
+    transaction.write[0]             = kCmd.opcode >> 8;
+    transaction.write[1]             = kCmd.opcode & 0xFF;
+    transaction.write_len            = 2 + 3 * kCmd.write_words;
+    transaction.delay_us             = kCmd.delay_ms * 1000;
+    transaction.read                 = pending.raw.data();
+    transaction.read_len             = pending.raw.size();
+    pack(request, &transaction.write[2], std::make_index_sequence<kCmd.write_words>{});
+
+    return submit(kCmd.opcode, &transaction);
+  }
+
+  template <CommandId kId>
+  int32_t finish(Pending<kId> &pending, Response<kId> &response) {
+    constexpr Command kCmd = kCommand<kId>;
+
+    int32_t err = wait(kCmd.opcode, &pending.transaction);
+
+    if (err == PICO_ERROR_NONE &&
+        !unpack(pending.raw.data(), response, std::make_index_sequence<kCmd.read_words>{})) {
+      err = crc_error(kCmd.opcode, kCmd.read_words);
+    }
+
+    return err;
+  }
+
+  // Referred to as "send command" in the datasheet
+  template <CommandId kId>
+  int32_t send() {
+    static_assert(kCommand<kId>.write_words == 0 && kCommand<kId>.read_words == 0);
+    Response<kId> response;
+    return command<kId>({}, response);
+  }
+
+  // Referred to as "write" in the datasheet
+  template <CommandId kId>
+  int32_t write(uint16_t data) {
+    static_assert(kCommand<kId>.write_words == 1 && kCommand<kId>.read_words == 0);
+    Response<kId> response;
+    return command<kId>({data}, response);
+  }
+
+  // Referred to as "read" in the datasheet
+  template <CommandId kId>
+  int32_t read(Response<kId> &response) {
+    static_assert(kCommand<kId>.write_words == 0 && kCommand<kId>.read_words > 0);
+    return command<kId>({}, response);
+  }
+
+  int32_t start_periodic_measurement() {
+    int32_t err = send<CommandId::kStartPeriodicMeasurement>();
+    periodic_   = periodic_ || err == PICO_ERROR_NONE;
+    return err;
+  }
+
+  int32_t start_low_power_periodic_measurement() {
+    int32_t err = send<CommandId::kStartLowPowerPeriodicMeasurement>();
+    periodic_   = periodic_ || err == PICO_ERROR_NONE;
+    return err;
+  }
+
+  int32_t stop_periodic_measurement() {
+    int32_t err = send<CommandId::kStopPeriodicMeasurement>();
+    periodic_   = periodic_ && err != PICO_ERROR_NONE;
+    return err;
+  }
+
+  // Only instantiated when called, so an SCD40 build that calls these fails to compile
+  int32_t measure_single_shot() { return send<CommandId::kMeasureSingleShot>(); }
+  int32_t measure_single_shot_rht_only() { return send<CommandId::kMeasureSingleShotRhtOnly>(); }
+
+ private:
+  // The parts that don't depend on the command are shared by all of them, so every command only
+  // adds its own immediates and unrolled CRC checks
+  int32_t submit(uint16_t opcode, I2cAsyncTransaction *transaction) {
+    EVENT_LOG1(LOG_SCD40_COMMAND, opcode);
+    transaction->notify_task = xTaskGetCurrentTaskHandle();
+    int32_t err              = bus_.submit(transaction);
+    if (err) {
+      EVENT_LOG2(LOG_SCD40_ERROR, opcode, err);
+    }
+    return err;
+  }
+
+  static int32_t wait(uint16_t opcode, I2cAsyncTransaction *transaction) {
+    // Other notifications to this task may arrive first, so wait for the flag
+    while (!transaction->complete) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    int32_t err = transaction->result;
+    if (err) {
+      EVENT_LOG2(LOG_SCD40_ERROR, opcode, err);
+    }
+    return err;
+  }
+
+  static int32_t illegal_state(uint16_t opcode) {
+    EVENT_LOG1(LOG_SCD40_ILLEGAL_STATE, opcode);
+    EVENT_LOG2(LOG_SCD40_ERROR, opcode, PICO_ERROR_INVALID_STATE);
+    return PICO_ERROR_INVALID_STATE;
+  }
+
+  static int32_t crc_error(uint16_t opcode, uint8_t words) {
+    EVENT_LOG1(LOG_SCD40_CRC_ERROR, words);
+    EVENT_LOG2(LOG_SCD40_ERROR, opcode, PICO_ERROR_INVALID_DATA);
+    return PICO_ERROR_INVALID_DATA;
+  }
+
+  template <size_t... kWords>
+  static void pack(const std::array<uint16_t, sizeof...(kWords)> &words, uint8_t *out,
+                   std::index_sequence<kWords...>) {
+    // The CRC covers the word as sent on the wire, MSB first
+    ((out[3 * kWords]     = words[kWords] >> 8,
+      out[3 * kWords + 1] = words[kWords] & 0xFF,
+      out[3 * kWords + 2] = scd40_crc(&out[3 * kWords], 2),
+      EVENT_LOG2(LOG_SCD40_WRITE, words[kWords], out[3 * kWords + 2])),
+     ...);
+  }
+
+  template <size_t... kWords>
+  static bool unpack(const uint8_t *raw, std::array<uint16_t, sizeof...(kWords)> &words,
+                     std::index_sequence<kWords...>) {
+    bool valid = ((scd40_crc(&raw[3 * kWords], 2) == raw[3 * kWords + 2]) & ... & true);
+    ((words[kWords] = (uint16_t)(raw[3 * kWords] << 8) | raw[3 * kWords + 1]), ...);
+    return valid;
+  }
+
+  Bus  bus_{};
+  bool periodic_ = false;
+};
+
+}  // namespace scd4x
+
+#endif  // SCD4X_HPP
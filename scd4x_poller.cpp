@@ -0,0 +1,291 @@
+#include "scd4x.hpp"
+
+extern "C" {
+#include "FreeRTOS.h"
+#include "event_log.h"
+#include "scd40_cadence.h"
+#include "scd4x_poller.h"
+#include "task.h"
+}
+
+#define SCD4X_POLLER_BAUDRATE (400 * 1000)
+
+using Scd4xSensor = scd4x::Scd4x<scd4x::I2cAsyncPort, scd4x::Variant::kScd40>;
+using scd4x::CommandId;
+using scd4x::Response;
+
+struct Scd4xRoom {
+  Scd4xSensor                     sensor;
+  const struct Scd4xSensorConfig *config;
+  uint32_t                        last_read_us;
+  struct Scd40ServiceStats        counters;
+  struct Scd40SampleSlot          slot;
+};
+
+static Scd4xRoom scd4x_rooms[SCD4X_POLLER_MAX_SENSORS];
+static uint      scd4x_room_count;
+
+static struct Scd4xBusStats    scd4x_bus_counters[SCD4X_POLLER_MAX_SENSORS];
+static struct Scd4xPollerStats scd4x_poller_counters;
+
+static struct Scd40Cadence scd4x_poller_cadence;
+
+void scd4x_poller_init(const struct Scd4xSensorConfig *sensors, uint count) {
+  hard_assert(count <= SCD4X_POLLER_MAX_SENSORS);
+
+  for (uint i = 0; i < count; i++) {
+    const struct Scd4xSensorConfig *config = &sensors[i];
+    hard_assert(config->i2c_index < SCD4X_POLLER_MAX_SENSORS);
+
+    scd4x::I2cAsyncPort port;
+    port.i2c = config->i2c_index == 0 ? i2c0 : i2c1;
+
+    scd4x_rooms[i]        = {};
+    scd4x_rooms[i].sensor = Scd4xSensor(port);
+    scd4x_rooms[i].config = config;
+
+    port.init(SCD4X_POLLER_BAUDRATE);
+    gpio_set_function(config->sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(config->scl_pin, GPIO_FUNC_I2C);
+    if (config->enable_internal_pullup) {
+      gpio_pull_up(config->sda_pin);
+      gpio_pull_up(config->scl_pin);
+    }
+  }
+  scd4x_room_count = count;
+
+  sleep_ms(1000);  // Wait for powerup, once for all of them
+}
+
+uint scd4x_poller_sensor_count() { return scd4x_room_count; }
+
+const char *scd4x_poller_room(uint sensor) { return scd4x_rooms[sensor].config->room; }
+
+////////////////
+// Publishing //
+////////////////
+
+bool scd4x_poller_latest(uint sensor, struct Scd40Sample *sample) {
+  return scd40_slot_latest(&scd4x_rooms[sensor].slot, sample);
+}
+
+void scd4x_poller_sensor_stats(uint sensor, struct Scd40ServiceStats *stats) {
+  *stats = scd4x_rooms[sensor].counters;
+}
+
+void scd4x_poller_bus_stats(uint i2c_index, struct Scd4xBusStats *stats) {
+  *stats = scd4x_bus_counters[i2c_index];
+}
+
+void scd4x_poller_stats(struct Scd4xPollerStats *stats) { *stats = scd4x_poller_counters; }
+
+/////////////
+// Polling //
+/////////////
+
+static void scd4x_poller_account(Scd4xRoom *room, const I2cAsyncTransaction *transaction,
+                                 int32_t err) {
+  struct Scd4xBusStats *bus = &scd4x_bus_counters[room->sensor.bus().index()];
+  if (err) {
+    bus->errors++;
+    room->counters.errors++;
+  }
+  // A transaction that was never queued has no timestamps
+  if (err == PICO_ERROR_INVALID_STATE || err == PICO_ERROR_INVALID_ARG) {
+    return;
+  }
+
+  uint32_t latency = i2c_async_latency_us(transaction);
+  bus->transactions++;
+  bus->last_latency_us = latency;
+  bus->total_latency_us += latency;
+  if (latency > bus->max_latency_us) {
+    bus->max_latency_us = latency;
+  }
+}
+
+// Runs a read command on every sensor in `mask`: all of them are started, then each is waited
+// for. Returns the sensors that answered.
+template <CommandId kId>
+static uint32_t scd4x_poller_read_all(uint32_t mask, Response<kId> *responses) {
+  Scd4xSensor::Pending<kId> pending[SCD4X_POLLER_MAX_SENSORS];
+  int32_t                   errors[SCD4X_POLLER_MAX_SENSORS];
+
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    if (mask & (1u << i)) {
+      errors[i] = scd4x_rooms[i].sensor.start<kId>(pending[i], {});
+    }
+  }
+
+  uint32_t answered = 0;
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    if (!(mask & (1u << i))) {
+      continue;
+    }
+    if (errors[i] == PICO_ERROR_NONE) {
+      errors[i] = scd4x_rooms[i].sensor.finish<kId>(pending[i], responses[i]);
+    }
+    scd4x_poller_account(&scd4x_rooms[i], &pending[i].transaction, errors[i]);
+    if (errors[i] == PICO_ERROR_NONE) {
+      answered |= 1u << i;
+    }
+  }
+
+  return answered;
+}
+
+// Sensors that are measuring, as a mask of room indices
+static uint32_t scd4x_poller_measuring() {
+  uint32_t measuring = 0;
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    if (scd4x_rooms[i].sensor.periodic()) {
+      measuring |= 1u << i;
+    }
+  }
+  return measuring;
+}
+
+int32_t scd4x_poller_start(enum Scd40ServiceMode mode) {
+  bool low_power = mode == SCD40_SERVICE_LOW_POWER_PERIODIC;
+  bool first     = scd4x_poller_measuring() == 0;
+
+  // Starting takes no execution time, so the sensors begin their periods within a few hundred
+  // microseconds of each other and one wakeup serves them all
+  int32_t result = PICO_ERROR_NONE;
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    Scd4xRoom *room = &scd4x_rooms[i];
+    if (room->sensor.periodic()) {
+      continue;
+    }
+
+    int32_t err = low_power ? room->sensor.start_low_power_periodic_measurement() :
+                              room->sensor.start_periodic_measurement();
+    if (err) {
+      // Measurement may still be running from before a reset, which rejects the start command
+      room->counters.errors++;
+      room->sensor.stop_periodic_measurement();
+      result = err;
+    }
+    room->last_read_us = time_us_32();
+  }
+
+  // The first samples are ready one period after the start commands. Sensors started later are
+  // out of step with the rest until a round catches up with them, see scd4x_poller_step().
+  if (first) {
+    scd40_cadence_start(&scd4x_poller_cadence, mode);
+  }
+
+  return result;
+}
+
+using Scd4xMeasurement = Response<CommandId::kReadMeasurement>;
+
+static void scd4x_poller_publish_reading(uint index, const Scd4xMeasurement &words,
+                                         uint32_t now_us) {
+  Scd4xRoom         *room = &scd4x_rooms[index];
+  struct Scd40Sample sample;
+
+  sample.co2_ppm                = words[0];
+  sample.temperature_raw        = words[1];
+  sample.humidity_raw           = words[2];
+  sample.temperature_centi_cel  = scd40_temperature_centi_cel(sample.temperature_raw);
+  sample.humidity_centi_percent = scd40_humidity_centi_percent(sample.humidity_raw);
+
+  scd40_cadence_stamp(&scd4x_poller_cadence, &room->counters, &room->last_read_us, now_us,
+                      &sample);
+  scd40_slot_publish(&room->slot, &sample);
+  EVENT_LOG3(LOG_SCD4X_SAMPLE, index, sample.co2_ppm, sample.temperature_raw);
+}
+
+// One wakeup's polls, timed from the first data ready query to the last sample published
+struct Scd4xRound {
+  uint32_t polls;
+  uint32_t start_us;
+  uint32_t end_us;
+  uint32_t read;  // Sensors read and published
+};
+
+static uint32_t scd4x_poller_poll(uint32_t waiting, void *context) {
+  Scd4xRound *round = static_cast<Scd4xRound *>(context);
+  if (round->polls++ == 0) {
+    round->start_us = round->end_us = time_us_32();
+  }
+
+  Response<CommandId::kGetDataReadyStatus> status[SCD4X_POLLER_MAX_SENSORS];
+  uint32_t answered = scd4x_poller_read_all<CommandId::kGetDataReadyStatus>(waiting, status);
+
+  uint32_t ready = 0;
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    if ((answered & (1u << i)) && scd4x::data_ready(status[i][0])) {
+      ready |= 1u << i;
+    }
+  }
+
+  if (ready) {
+    Scd4xMeasurement words[SCD4X_POLLER_MAX_SENSORS];
+    uint32_t         got = scd4x_poller_read_all<CommandId::kReadMeasurement>(ready, words);
+
+    round->end_us = time_us_32();
+    for (uint i = 0; i < scd4x_room_count; i++) {
+      if (got & (1u << i)) {
+        scd4x_poller_publish_reading(i, words[i], round->end_us);
+      }
+    }
+    round->read |= got;
+  }
+
+  for (uint i = 0; i < scd4x_room_count; i++) {
+    if ((waiting & ~ready) & (1u << i)) {
+      scd4x_rooms[i].counters.not_ready++;
+    }
+  }
+  return ready;
+}
+
+int32_t scd4x_poller_step() {
+  Scd4xRound round   = {};
+  uint32_t   waiting = scd40_cadence_next(&scd4x_poller_cadence, scd4x_poller_measuring(),
+                                          scd4x_poller_poll, &round);
+
+  if (!round.read) {
+    return PICO_ERROR_TIMEOUT;
+  }
+
+  uint32_t round_us = round.end_us - round.start_us;
+
+  scd4x_poller_counters.rounds++;
+  scd4x_poller_counters.last_round_us = round_us;
+  if (round_us > scd4x_poller_counters.max_round_us) {
+    scd4x_poller_counters.max_round_us = round_us;
+  }
+  EVENT_LOG2(LOG_SCD4X_ROUND, __builtin_popcount(round.read), round_us);
+
+  return waiting ? PICO_ERROR_TIMEOUT : PICO_ERROR_NONE;
+}
+
+void scd4x_poller_task(void *params) {
+  enum Scd40ServiceMode mode = (enum Scd40ServiceMode)(uintptr_t)params;
+  uint32_t              all  = (1u << scd4x_room_count) - 1;
+
+  uint32_t   backoff_ms = SCD40_CADENCE_RESTART_MS;
+  TickType_t retry      = xTaskGetTickCount();
+  while (1) {
+    // Sensors that didn't start are retried between rounds, while the others are polled. One
+    // that's missing fails every time, so back off rather than hammer its bus.
+    if (scd4x_poller_measuring() != all && (int32_t)(xTaskGetTickCount() - retry) >= 0) {
+      int32_t err = scd4x_poller_start(mode);
+      if (err) {
+        EVENT_LOG3(LOG_SCD4X_START_FAILED, all & ~scd4x_poller_measuring(), err, backoff_ms);
+        retry = xTaskGetTickCount() + pdMS_TO_TICKS(scd40_cadence_backoff(&backoff_ms));
+      }
+    }
+
+    // With nothing to poll, sleep until the retry. It's already due if the start ran past it.
+    TickType_t now = xTaskGetTickCount();
+    if (scd4x_poller_measuring()) {
+      scd4x_poller_step();
+    } else if ((int32_t)(retry - now) > 0) {
+      vTaskDelay(retry - now);
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef SCD4X_POLLER_H
+#define SCD4X_POLLER_H
+
+#include "pico/stdlib.h"
+#include "scd40_service.h"
+#include "stdint.h"
+
+// Several SCD4x sensors, one per room. The address is fixed at 0x62, so each sensor needs a bus
+// of its own. The poller task starts every sensor's transaction before waiting on any of them, so
+// the buses work in parallel and a round costs about as long as one sensor. Readings are
+// published per sensor the same way scd40_service publishes its own.
+
+#define SCD4X_POLLER_MAX_SENSORS 2  // One per I2C controller
+
+struct Scd4xSensorConfig {
+  const char *room;
+  uint        i2c_index;  // 0 or 1
+  uint        sda_pin;
+  uint        scl_pin;
+  bool        enable_internal_pullup;
+};
+
+struct Scd4xBusStats {
+  uint32_t transactions;
+  uint32_t errors;
+  // Submit to completion, so they include the command's execution time and any queueing
+  uint32_t last_latency_us;
+  uint32_t max_latency_us;
+  uint64_t total_latency_us;
+};
+
+struct Scd4xPollerStats {
+  uint32_t rounds;         // Wakeups that read at least one sensor
+  uint32_t last_round_us;  // From the first data ready query to the last sample published
+  uint32_t max_round_us;
+};
+
+// Sets up each sensor's bus and waits for the sensors to power up. `sensors` must stay valid.
+void scd4x_poller_init(const struct Scd4xSensorConfig *sensors, uint count);
+
+uint        scd4x_poller_sensor_count();
+const char *scd4x_poller_room(uint sensor);
+
+// Copies out the sensor's latest sample without blocking. Returns false if nothing has been
+// published for it yet. Safe from any task or ISR on either core.
+bool scd4x_poller_latest(uint sensor, struct Scd40Sample *sample);
+
+// Counters are updated by the poller task only, individually consistent
+void scd4x_poller_sensor_stats(uint sensor, struct Scd40ServiceStats *stats);
+void scd4x_poller_bus_stats(uint i2c_index, struct Scd4xBusStats *stats);
+void scd4x_poller_stats(struct Scd4xPollerStats *stats);
+
+// Starts every sensor that isn't measuring yet. The first call to start any aligns the poller to
+// their cadence. Returns an error if any sensor didn't start; the ones that did are polled and
+// published all the same, so call again to retry the rest.
+int32_t scd4x_poller_start(enum Scd40ServiceMode mode);
+
+// One wakeup of the poller: waits for the next samples, reads them and publishes them. The task
+// calls this in a loop. Exposed for harnesses that step the poller themselves.
+int32_t scd4x_poller_step();
+
+// `params` is the enum Scd40ServiceMode, cast to a pointer. scd4x_poller_init() must have run.
+void scd4x_poller_task(void *params);
+
+#endif  // SCD4X_POLLER_H
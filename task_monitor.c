@@ -0,0 +1,256 @@
+#include "task_monitor.h"
+
+#include "event_log.h"
+#include "hardware/sync.h"
+#include "stdio.h"
+#include "string.h"
+
+// What the monitor remembers of each task between samples
+struct TaskMonitorHistory {
+  UBaseType_t number;
+  uint32_t    run_time_us;
+  bool        cpu_alarm;
+  bool        stack_alarm;
+};
+
+static struct TaskMonitorThresholds task_monitor_thresholds;
+static struct TaskMonitorStats      task_monitor_counters;
+
+// Static, the task only has configMINIMAL_STACK_SIZE
+static TaskStatus_t              task_monitor_status[TASK_MONITOR_MAX_TASKS];
+static struct TaskMonitorHistory task_monitor_history[TASK_MONITOR_MAX_TASKS];
+static struct TaskMonitorHistory task_monitor_next_history[TASK_MONITOR_MAX_TASKS];
+static uint32_t                  task_monitor_history_count;
+static uint32_t                  task_monitor_last_us;
+static bool                      task_monitor_heap_alarm;
+static TickType_t                task_monitor_wake;
+
+// The published sample, double buffered. The sequence counts samples published, and the latest is
+// in task_monitor_samples[task_monitor_sequence & 1]. The monitor task fills the other buffer
+// while readers copy this one, and publishes it by bumping the sequence, a single store. A sample
+// is too big to copy with interrupts masked the way scd40_service.c does.
+static volatile uint32_t        task_monitor_sequence;
+static struct TaskMonitorSample task_monitor_samples[2];
+
+#define TASK_MONITOR_COUNTER_READS 1024
+
+// Times the run time counter read the kernel makes on every context switch, loop included
+static uint32_t task_monitor_counter_read_ns() {
+  uint32_t status   = save_and_disable_interrupts();
+  uint32_t start_us = time_us_32();
+  for (uint32_t i = 0; i < TASK_MONITOR_COUNTER_READS; i++) {
+    (void)portGET_RUN_TIME_COUNTER_VALUE();
+  }
+  uint32_t elapsed_us = time_us_32() - start_us;
+  restore_interrupts(status);
+
+  return elapsed_us * 1000 / TASK_MONITOR_COUNTER_READS;
+}
+
+void task_monitor_init(const struct TaskMonitorThresholds *thresholds) {
+  if (thresholds != NULL) {
+    task_monitor_thresholds = *thresholds;
+  }
+  task_monitor_counters.counter_read_ns = task_monitor_counter_read_ns();
+  EVENT_LOG1(LOG_TASK_MONITOR_COUNTER, task_monitor_counters.counter_read_ns);
+  task_monitor_wake = xTaskGetTickCount();
+}
+
+// Stack checking is on in FreeRTOSConfig.h. Past this point the task has corrupted memory.
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name) {
+  panic("Stack overflow in task %s", name);
+}
+
+////////////////
+// Publishing //
+////////////////
+
+// The buffer readers aren't copying. Only the monitor task publishes, so it stays that way.
+static struct TaskMonitorSample *task_monitor_next() {
+  return &task_monitor_samples[(task_monitor_sequence + 1) & 1];
+}
+
+static void task_monitor_publish() {
+  __dmb();
+  task_monitor_sequence = task_monitor_sequence + 1;
+}
+
+bool task_monitor_latest(struct TaskMonitorSample *sample) {
+  // A reader held up past the next publish may have copied the buffer as it was being refilled
+  uint32_t sequence;
+  do {
+    sequence = task_monitor_sequence;
+    __dmb();
+    *sample = task_monitor_samples[sequence & 1];
+    __dmb();
+  } while (sequence != task_monitor_sequence);
+
+  return sequence != 0;
+}
+
+void task_monitor_stats(struct TaskMonitorStats *stats) { *stats = task_monitor_counters; }
+
+//////////////
+// Sampling //
+//////////////
+
+static bool task_monitor_is_idle(TaskHandle_t task) {
+  for (BaseType_t core = 0; core < configNUMBER_OF_CORES; core++) {
+    if (task == xTaskGetIdleTaskHandleForCore(core)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static const struct TaskMonitorHistory *task_monitor_find(UBaseType_t number) {
+  for (uint32_t i = 0; i < task_monitor_history_count; i++) {
+    if (task_monitor_history[i].number == number) {
+      return &task_monitor_history[i];
+    }
+  }
+  return NULL;
+}
+
+static void task_monitor_check(struct TaskMonitorHistory *history,
+                               const struct TaskMonitorTask *task, bool idle) {
+  const struct TaskMonitorThresholds *limits = &task_monitor_thresholds;
+
+  // Idle tasks take whatever is left over
+  bool cpu_alarm =
+      !idle && limits->cpu_permille != 0 && task->cpu_permille > limits->cpu_permille;
+  if (cpu_alarm && !history->cpu_alarm) {
+    task_monitor_counters.alarms++;
+    EVENT_LOG3(LOG_TASK_CPU_ALARM, task->number, task->cpu_permille, limits->cpu_permille);
+  }
+  history->cpu_alarm = cpu_alarm;
+
+  bool stack_alarm =
+      limits->stack_free_words != 0 && task->stack_free_words < limits->stack_free_words;
+  if (stack_alarm && !history->stack_alarm) {
+    task_monitor_counters.alarms++;
+    EVENT_LOG3(LOG_TASK_STACK_ALARM, task->number, task->stack_free_words,
+               limits->stack_free_words);
+  }
+  history->stack_alarm = stack_alarm;
+}
+
+static int32_t task_monitor_take(struct TaskMonitorSample *sample) {
+  // Suspends the scheduler while it walks the task lists
+  uint32_t    now_us = time_us_32();
+  UBaseType_t count  = uxTaskGetSystemState(task_monitor_status, TASK_MONITOR_MAX_TASKS, NULL);
+  if (count == 0) {
+    task_monitor_counters.overflows++;
+    return PICO_ERROR_BUFFER_TOO_SMALL;
+  }
+
+  // Without an earlier sample the counters cover everything since boot, so there are no shares
+  bool     first   = task_monitor_counters.samples == 0;
+  uint32_t elapsed = now_us - task_monitor_last_us;
+
+  memset(sample, 0, sizeof(*sample));
+  sample->timestamp_us        = now_us;
+  sample->index               = task_monitor_counters.samples;
+  sample->period_us           = first ? 0 : elapsed;
+  sample->heap_free_bytes     = xPortGetFreeHeapSize();
+  sample->heap_min_free_bytes = xPortGetMinimumEverFreeHeapSize();
+  sample->task_count          = count;
+
+  struct TaskMonitorHistory *history = task_monitor_next_history;
+  uint64_t                   idle_us = 0;
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t     *status = &task_monitor_status[i];
+    struct TaskMonitorTask *task   = &sample->tasks[i];
+
+    // Counters wrap with the timer, every 71 minutes, so only differences mean anything. A task
+    // new since the last sample has run for no longer than the period.
+    const struct TaskMonitorHistory *last = task_monitor_find(status->xTaskNumber);
+    uint32_t ran = status->ulRunTimeCounter - (last != NULL ? last->run_time_us : 0);
+
+    history[i]             = last != NULL ? *last : (struct TaskMonitorHistory){0};
+    history[i].number      = status->xTaskNumber;
+    history[i].run_time_us = status->ulRunTimeCounter;
+
+    strncpy(task->name, status->pcTaskName, sizeof(task->name) - 1);
+    task->number           = status->xTaskNumber;
+    task->stack_free_words = status->usStackHighWaterMark;
+    task->cpu_permille = first || elapsed == 0 ? 0 : (uint16_t)((uint64_t)ran * 1000 / elapsed);
+    bool idle = task_monitor_is_idle(status->xHandle);
+    if (idle) {
+      idle_us += ran;
+    }
+
+    task_monitor_check(&history[i], task, idle);
+  }
+
+  uint64_t capacity_us = (uint64_t)elapsed * configNUMBER_OF_CORES;
+  if (!first && elapsed > 0) {
+    sample->cpu_busy_permille =
+        idle_us >= capacity_us ? 0 : (uint16_t)((capacity_us - idle_us) * 1000 / capacity_us);
+  }
+
+  // Tasks that have been deleted drop out here
+  memcpy(task_monitor_history, history, count * sizeof(history[0]));
+  task_monitor_history_count = count;
+  task_monitor_last_us       = now_us;
+
+  const struct TaskMonitorThresholds *limits = &task_monitor_thresholds;
+  bool heap_alarm = limits->heap_free_bytes != 0 &&
+                    sample->heap_min_free_bytes < limits->heap_free_bytes;
+  if (heap_alarm && !task_monitor_heap_alarm) {
+    task_monitor_counters.alarms++;
+    EVENT_LOG2(LOG_HEAP_ALARM, sample->heap_min_free_bytes, limits->heap_free_bytes);
+  }
+  task_monitor_heap_alarm = heap_alarm;
+
+  return PICO_ERROR_NONE;
+}
+
+int32_t task_monitor_step() {
+  vTaskDelayUntil(&task_monitor_wake, pdMS_TO_TICKS(TASK_MONITOR_PERIOD_MS));
+
+  struct TaskMonitorSample *sample   = task_monitor_next();
+  uint32_t                  start_us = time_us_32();
+  int32_t                   err      = task_monitor_take(sample);
+  if (err) {
+    return err;
+  }
+  task_monitor_publish();
+  task_monitor_counters.samples++;
+
+  uint32_t cost_us                     = time_us_32() - start_us;
+  task_monitor_counters.last_sample_us = cost_us;
+  if (cost_us > task_monitor_counters.max_sample_us) {
+    task_monitor_counters.max_sample_us = cost_us;
+  }
+
+  // Shares in the first sample would be since boot, so there is nothing to log yet
+  if (sample->period_us != 0) {
+    for (uint32_t i = 0; i < sample->task_count; i++) {
+      EVENT_LOG3(LOG_TASK_MONITOR_TASK, sample->tasks[i].number, sample->tasks[i].cpu_permille,
+                 sample->tasks[i].stack_free_words);
+    }
+    EVENT_LOG2(LOG_TASK_MONITOR, sample->cpu_busy_permille, cost_us);
+  }
+  EVENT_LOG2(LOG_TASK_MONITOR_HEAP, sample->heap_free_bytes, sample->heap_min_free_bytes);
+
+  return PICO_ERROR_NONE;
+}
+
+void task_monitor_task(void *params) {
+  while (1) {
+    task_monitor_step();
+  }
+}
+
+void task_monitor_print(const struct TaskMonitorSample *sample) {
+  printf("Tasks over %u ms, %u.%u%% CPU busy, heap %u bytes free (%u at the lowest)\n",
+         sample->period_us / 1000, sample->cpu_busy_permille / 10, sample->cpu_busy_permille % 10,
+         sample->heap_free_bytes, sample->heap_min_free_bytes);
+  printf("%4s %-16s %8s %12s\n", "#", "name", "cpu %", "stack free");
+  for (uint32_t i = 0; i < sample->task_count; i++) {
+    const struct TaskMonitorTask *task = &sample->tasks[i];
+    printf("%4u %-16s %6u.%u %12u\n", (unsigned)task->number, task->name, task->cpu_permille / 10,
+           task->cpu_permille % 10, task->stack_free_words);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include "FreeRTOS.h"
+#include "pico/stdlib.h"
+#include "stdint.h"
+#include "task.h"
+
+// Per task CPU share and stack headroom, and the heap's low water mark. The kernel adds each
+// task's time to its run time counter on every context switch, reading the 1 MHz timer (see
+// FreeRTOSConfig.h). task_monitor_init() times that read and reports it in the stats; it is the
+// only cost outside the monitor's own task. Every period the monitor task walks the task list
+// with the scheduler suspended, publishes a sample, logs it and raises alarms when a threshold is
+// crossed. The walk is bounded by TASK_MONITOR_MAX_TASKS, and the monitor times it.
+
+#define TASK_MONITOR_MAX_TASKS 16
+#define TASK_MONITOR_PERIOD_MS 10000
+
+struct TaskMonitorTask {
+  char        name[configMAX_TASK_NAME_LEN];
+  UBaseType_t number;            // FreeRTOS task number, which the log uses in place of the name
+  uint16_t    cpu_permille;      // Of one core, over the last period
+  uint32_t    stack_free_words;  // Never touched since the task started
+};
+
+struct TaskMonitorSample {
+  uint32_t timestamp_us;
+  uint32_t index;      // Samples published before this one
+  uint32_t period_us;  // Covered by the CPU shares, 0 in the first sample
+  uint16_t cpu_busy_permille;  // Of both cores, time not spent in the idle tasks
+  uint32_t heap_free_bytes;
+  uint32_t heap_min_free_bytes;  // The lowest it has ever been
+  uint32_t task_count;
+  struct TaskMonitorTask tasks[TASK_MONITOR_MAX_TASKS];
+};
+
+// 0 disables a threshold. Each alarm is logged once when it's crossed, and again only after the
+// value has come back within the threshold.
+struct TaskMonitorThresholds {
+  uint16_t cpu_permille;      // Any task above this share of a core
+  uint32_t stack_free_words;  // Any task with less stack than this left
+  uint32_t heap_free_bytes;   // The heap's lowest free size under this
+};
+
+struct TaskMonitorStats {
+  uint32_t samples;
+  uint32_t alarms;
+  uint32_t overflows;  // Samples skipped because more than TASK_MONITOR_MAX_TASKS tasks exist
+  uint32_t last_sample_us;  // Walking the tasks and publishing, the monitor's own cost
+  uint32_t max_sample_us;
+  uint32_t counter_read_ns;  // What each context switch pays for the run time counter
+};
+
+// Call before the monitor task runs. `thresholds` may be NULL for no alarms. Times the run time
+// counter read with interrupts masked, for well under a millisecond.
+void task_monitor_init(const struct TaskMonitorThresholds *thresholds);
+
+// Copies out the latest sample without blocking. Returns false if nothing has been published yet.
+// Safe from any task on either core.
+bool task_monitor_latest(struct TaskMonitorSample *sample);
+
+// Counters are updated by the monitor task only, individually consistent
+void task_monitor_stats(struct TaskMonitorStats *stats);
+
+// One period: waits for it to end, then samples, publishes and logs. The task calls this in a
+// loop.
+int32_t task_monitor_step();
+
+void task_monitor_task(void *params);
+
+// A table with the task names, for the serial console
+void task_monitor_print(const struct TaskMonitorSample *sample);
+
+#endif  // TASK_MONITOR_H
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Builds and inspects IR trace files (see ir_trace.h for the format).
+
+Record raw captures by building the firmware with -DIR_RECV_TRACE=ON and saving the serial
+output, then convert every capture in the log into a trace file:
+
+    ./tools/ir_trace.py capture serial.log captures.irt
+
+Synthesise a corpus with one frame for every update type, mode and fan speed. Timings are exact
+unless --jitter is given, which is useful for probing the decoder's acceptance windows. The
+timings are read from the Shirokuma descriptor in ir_protocol.hpp. host/corpus/shirokuma.irt, which
+the host build replays, is regenerated with the first of these:
+
+    ./tools/ir_trace.py synth host/corpus/shirokuma.irt
+    ./tools/ir_trace.py synth jittered.irt --jitter 10 --seed 1
+
+Summarise a trace file:
+
+    ./tools/ir_trace.py info corpus.irt
+"""
+
+import argparse
+import pathlib
+import random
+import re
+import struct
+import sys
+
+MAGIC = 0x52545249  # "IRTR"
+VERSION = 1
+FILE_HEADER = struct.Struct("<IHHII")  # magic, version, header bytes, tick_hz, capture count
+CAPTURE_HEADER = struct.Struct("<II")  # run count, timestamp_us
+RUN_MASK = 0x7FFFFFFF
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+
+
+def protocol_timings(name="Shirokuma"):
+    """Nominal timings in microseconds of a protocol descriptor in ir_protocol.hpp, so traces are
+    synthesised from what the encoder sends: the leader as (mark, us) stages, then the bit mark and
+    the zero and one spaces"""
+    text = (ROOT / "ir_protocol.hpp").read_text()
+    body = re.search(rf"^struct {name} {{$(.*?)^}};$", text, re.M | re.S)
+    if not body:
+        sys.exit(f"struct {name} not found in ir_protocol.hpp")
+    body = body.group(1)
+    leader = re.search(r"kLeader\[\] = {(.*?)};", body, re.S).group(1)
+    stages = [(mark == "true", int(us))
+              for mark, us in re.findall(r"{(true|false), {(\d+),", leader)]
+
+    def timing(member):
+        return int(re.search(rf"{member}\s*= {{(\d+),", body).group(1))
+
+    return stages, timing("kBitMark"), timing("kZeroSpace"), timing("kOneSpace")
+
+
+LEADER, BIT_MARK_US, ZERO_SPACE_US, ONE_SPACE_US = protocol_timings()
+# The receiver ends a frame once the line has been idle this long
+FRAME_GAP_US = int(re.search(r"#define IR_RECV_FRAME_GAP_US\s+(\d+)",
+                             (ROOT / "ir_recv.c").read_text()).group(1))
+
+UPDATE_TYPES = {"mode": 0x13, "timer_on": 0x22, "timer_off": 0x24, "fan_speed": 0x42,
+                "temp_down": 0x43, "temp_up": 0x44, "fin_dir": 0x81}
+MODES = {"off": 0x0, "ventilation": 0x1, "cooling": 0x3, "dehumidify": 0x5, "heating": 0x6}
+FAN_SPEEDS = {"0": 0x1, "1": 0x2, "2": 0x3, "3": 0x4, "auto": 0x5, "5": 0x6}
+
+
+def run_word(level, ticks):
+    return (level << 31) | (ticks & RUN_MASK)
+
+
+def write_trace(path, tick_hz, captures):
+    """captures is a list of (timestamp_us, [run words])"""
+    data = bytearray(FILE_HEADER.pack(MAGIC, VERSION, FILE_HEADER.size, tick_hz, len(captures)))
+    for timestamp, runs in captures:
+        data += CAPTURE_HEADER.pack(len(runs), timestamp & 0xFFFFFFFF)
+        data += struct.pack(f"<{len(runs)}I", *runs)
+    path.write_bytes(data)
+
+
+def read_trace(path):
+    data = path.read_bytes()
+    magic, version, header_bytes, tick_hz, count = FILE_HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit(f"{path} is not a trace file")
+    if version > VERSION:
+        sys.exit(f"{path} is version {version}, this tool reads up to {VERSION}")
+    offset = header_bytes
+    captures = []
+    for _ in range(count):
+        run_count, timestamp = CAPTURE_HEADER.unpack_from(data, offset)
+        offset += CAPTURE_HEADER.size
+        captures.append((timestamp, list(struct.unpack_from(f"<{run_count}I", data, offset))))
+        offset += 4 * run_count
+    return tick_hz, captures
+
+
+def parse_log(text):
+    """Extracts the captures printed by ir_trace_print() from a serial log"""
+    tick_hz = None
+    captures = []
+    current = None
+    for line in text.splitlines():
+        line = line.strip()
+        start = re.match(r"irtrace (\d+) (\d+) (\d+)$", line)
+        if start:
+            rate, timestamp, _ = map(int, start.groups())
+            if tick_hz not in (None, rate):
+                sys.exit("captures with different tick rates can't share a trace file")
+            tick_hz = rate
+            current = (timestamp, [])
+        elif line == "irtrace end" and current is not None:
+            captures.append(current)
+            current = None
+        elif current is not None:
+            current[1].extend(int(word, 16) for word in line.split())
+    return tick_hz or 1000000, captures
+
+
+def encode_frame(update_type, mode, fan_speed, temperature, timer_on=0, timer_off=0):
+    """Mirrors aircon_frame_encode() in cmd_gen.c"""
+    data = [0x40, 0xFF, 0xCC, 0x92, update_type, (temperature << 2) & 0xFF, 0x00,
+            (timer_off & 0xF) << 4, (timer_off >> 4) & 0xFF, timer_on & 0xFF,
+            ((timer_on >> 8) & 0xF) | (timer_off > 0) << 4 | (timer_on > 0) << 5,
+            (fan_speed << 4) | (MODES["heating"] if mode == MODES["off"] else mode),
+            0xE1 if mode == MODES["off"] else 0xF1 if mode in (0x3, 0x6) else 0xF0,
+            0x00, 0x00, 0x80, 0x03, 0x01, 0x88, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF]
+    frame = [0x01, 0x10, 0x00]
+    for byte in data:
+        frame += [byte, ~byte & 0xFF]
+    return frame
+
+
+def frame_runs(frame, jitter_us, rng):
+    """Receiver output for one frame: low while carrier is present, ending on the idle gap"""
+    def run(level, us):
+        return run_word(level, max(1, us + rng.randint(-jitter_us, jitter_us)))
+
+    runs = [run(not mark, us) for mark, us in LEADER]
+    for byte in frame:
+        for bit in range(8):
+            runs.append(run(0, BIT_MARK_US))
+            runs.append(run(1, ONE_SPACE_US if byte >> bit & 1 else ZERO_SPACE_US))
+    runs.append(run(0, BIT_MARK_US))
+    runs.append(run_word(1, FRAME_GAP_US))
+    return runs
+
+
+def corpus_frames():
+    default = dict(update_type=UPDATE_TYPES["mode"], mode=MODES["cooling"],
+                   fan_speed=FAN_SPEEDS["auto"], temperature=25)
+    for update_type in UPDATE_TYPES.values():
+        yield dict(default, update_type=update_type)
+    for mode in MODES.values():
+        yield dict(default, mode=mode)
+    for fan_speed in FAN_SPEEDS.values():
+        yield dict(default, fan_speed=fan_speed)
+    yield dict(default, update_type=UPDATE_TYPES["timer_on"], timer_on=90)
+    yield dict(default, update_type=UPDATE_TYPES["timer_off"], timer_off=480)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    capture = commands.add_parser("capture", help="convert a serial log into a trace file")
+    capture.add_argument("log", type=pathlib.Path)
+    capture.add_argument("trace", type=pathlib.Path)
+
+    synth = commands.add_parser("synth", help="generate a corpus covering every field value")
+    synth.add_argument("trace", type=pathlib.Path)
+    synth.add_argument("--jitter", type=int, default=0, help="uniform jitter in us")
+    synth.add_argument("--seed", type=int, default=1)
+
+    info = commands.add_parser("info", help="summarise a trace file")
+    info.add_argument("trace", type=pathlib.Path)
+
+    args = parser.parse_args()
+
+    if args.command == "capture":
+        tick_hz, captures = parse_log(args.log.read_text(errors="replace"))
+        write_trace(args.trace, tick_hz, captures)
+        print(f"{len(captures)} captures written to {args.trace}")
+    elif args.command == "synth":
+        rng = random.Random(args.seed)
+        captures = []
+        timestamp = 0
+        for fields in corpus_frames():
+            runs = frame_runs(encode_frame(**fields), args.jitter, rng)
+            captures.append((timestamp, runs))
+            timestamp += sum(word & RUN_MASK for word in runs)
+        write_trace(args.trace, 1000000, captures)
+        print(f"{len(captures)} captures written to {args.trace}")
+    else:
+        tick_hz, captures = read_trace(args.trace)
+        print(f"tick rate {tick_hz} Hz, {len(captures)} captures")
+        for timestamp, runs in captures:
+            ticks = sum(word & RUN_MASK for word in runs)
+            print(f"  {timestamp:10d} us: {len(runs)} runs, {ticks * 1e3 / tick_hz:.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Decodes a binary dump of the firmware event log rings.
+
+The format table is generated from log_events.def, so the tool always matches the firmware it
+was built alongside. Dump the rings from a running board with gdb (see gdb_server.zsh):
+
+    (gdb) dump binary value events.bin event_log_rings
+
+and decode them with:
+
+    ./tools/log_decode.py events.bin
+"""
+
+import argparse
+import pathlib
+import re
+import struct
+import sys
+
+REPO = pathlib.Path(__file__).resolve().parent.parent
+
+RING_HEADER = struct.Struct("<III")  # head, tail, dropped
+RECORD = struct.Struct("<IHBB3I")  # timestamp_us, id, core, arg_count, args[3]
+
+
+def load_formats(def_path):
+    formats = []
+    for line in def_path.read_text().splitlines():
+        match = re.match(r'\s*LOG_EVENT\((\w+),\s*(".*")\)', line)
+        if match:
+            # The format is a C string literal, which Python reads the same way for our escapes
+            formats.append((match.group(1), eval(match.group(2))))
+    return formats
+
+
+def load_ring_records(header_path):
+    match = re.search(r"#define\s+EVENT_LOG_RING_RECORDS\s+(\d+)", header_path.read_text())
+    if not match:
+        sys.exit(f"EVENT_LOG_RING_RECORDS not found in {header_path}")
+    return int(match.group(1))
+
+
+def c_format(fmt, args):
+    """Applies the subset of C conversions used in log_events.def to 32 bit arguments."""
+    values = iter(args)
+
+    def convert(match):
+        flags, conversion = match.group(1), match.group(2)
+        if conversion == "%":
+            return "%"
+        value = next(values)
+        if conversion == "d":
+            value = struct.unpack("<i", struct.pack("<I", value))[0]
+            conversion = "d"
+        elif conversion == "u":
+            conversion = "d"
+        return ("%" + flags + conversion) % value
+
+    return re.sub(r"%(\d*)([uxXd%])", convert, fmt)
+
+
+def decode(dump, formats, ring_records):
+    ring_size = RING_HEADER.size + ring_records * RECORD.size
+    events = []
+    for core in range(len(dump) // ring_size):
+        base = core * ring_size
+        head, tail, dropped = RING_HEADER.unpack_from(dump, base)
+        if dropped:
+            events.append((0, core, f"{dropped} records dropped"))
+        # Everything between tail and head is still undrained. Older records that were already
+        # printed are still in the ring too, so decode the whole ring ending at head.
+        count = min(head, ring_records)
+        for seq in range(head - count, head):
+            offset = base + RING_HEADER.size + (seq % ring_records) * RECORD.size
+            timestamp, event_id, rec_core, arg_count, *args = RECORD.unpack_from(dump, offset)
+            if event_id < len(formats):
+                text = c_format(formats[event_id][1], args)
+            else:
+                text = f"unknown event {event_id}"
+            pending = "" if seq < tail else " (undrained)"
+            events.append((timestamp, rec_core, text + pending))
+    return sorted(events)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("dump", type=pathlib.Path, help="binary dump of event_log_rings")
+    parser.add_argument("--defs", type=pathlib.Path, default=REPO / "log_events.def")
+    parser.add_argument("--header", type=pathlib.Path, default=REPO / "event_log.h")
+    args = parser.parse_args()
+
+    formats = load_formats(args.defs)
+    ring_records = load_ring_records(args.header)
+    for timestamp, core, text in decode(args.dump.read_bytes(), formats, ring_records):
+        print(f"[{timestamp:10d}] core {core}: {text}")
+
+
+if __name__ == "__main__":
+    main()
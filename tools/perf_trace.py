@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Converts perf trace dumps from a serial log into Chrome trace JSON (see perf_trace.h).
+
+Build the firmware with -DPERF_TRACE=ON, type t on the serial console whenever the last moments
+are worth keeping, save the serial output and convert every dump in it:
+
+    ./tools/perf_trace.py serial.log trace.json
+
+Open the result in ui.perfetto.dev or chrome://tracing. Each core is a thread on one timeline.
+Spans show on the core they began on, even if they ended in an interrupt on the other one.
+"""
+
+import argparse
+import json
+import pathlib
+import re
+import sys
+
+REPO = pathlib.Path(__file__).resolve().parent.parent
+
+WRAP = 1 << 32  # The timestamps are time_us_32()
+
+
+def load_names(def_path):
+    names = []
+    for line in def_path.read_text().splitlines():
+        match = re.match(r'\s*PERF_TRACE_EVENT\((\w+),\s*(".*")\)', line)
+        if match:
+            names.append(eval(match.group(2)))
+    return names
+
+
+def parse_log(text):
+    """Extracts (core, overwritten, records) for every ring printed by perf_trace_dump()"""
+    rings = []
+    current = None
+    for line in text.splitlines():
+        line = line.strip()
+        start = re.match(r"perftrace (\d+) (\d+) (\d+)$", line)
+        if start:
+            core, _, overwritten = map(int, start.groups())
+            current = (core, overwritten, [])
+        elif line == "perftrace end" and current is not None:
+            rings.append(current)
+            current = None
+        elif current is not None:
+            fields = line.split()
+            if len(fields) == 4:
+                timestamp, event_id, phase, arg = (int(field, 16) for field in fields)
+                current[2].append((timestamp, event_id, chr(phase), arg))
+    return rings
+
+
+def unwrap(timestamp, reference):
+    """The value of a 32 bit timestamp nearest to an already unwrapped reference"""
+    value = reference - reference % WRAP + timestamp
+    if value - reference > WRAP // 2:
+        value -= WRAP
+    elif reference - value > WRAP // 2:
+        value += WRAP
+    return value
+
+
+def merge(rings):
+    """Every record on one timeline as (timestamp, core, id, phase, arg), oldest first"""
+    merged = []
+    latest = None
+    for core, _, records in rings:
+        # Each ring is in order, and all of them count the same timer
+        reference = latest if latest is not None else (records[0][0] if records else 0)
+        for timestamp, event_id, phase, arg in records:
+            reference = unwrap(timestamp, reference)
+            merged.append((reference, core, event_id, phase, arg))
+        if records:
+            latest = reference
+    # Stable, so records from one core keep their order even within a microsecond
+    return sorted(merged, key=lambda record: record[0])
+
+
+def convert(rings, names):
+    events = []
+    open_spans = {}
+    unmatched = 0
+
+    for timestamp, core, event_id, phase, arg in merge(rings):
+        name = names[event_id] if event_id < len(names) else f"event {event_id}"
+        if phase == "B":
+            open_spans.setdefault((event_id, arg), []).append((timestamp, core))
+        elif phase == "E":
+            begun = open_spans.get((event_id, arg))
+            if not begun:
+                unmatched += 1  # Its begin was overwritten or recorded before the last dump
+                continue
+            start, start_core = begun.pop()
+            events.append({
+                "name": name, "ph": "X", "ts": start, "dur": timestamp - start, "pid": 0,
+                "tid": start_core, "args": {"arg": arg, "end core": core},
+            })
+        else:
+            events.append({
+                "name": name, "ph": "i", "s": "t", "ts": timestamp, "pid": 0, "tid": core,
+                "args": {"arg": arg},
+            })
+
+    # Still running when the rings were dumped
+    for (event_id, arg), begun in open_spans.items():
+        for start, core in begun:
+            name = names[event_id] if event_id < len(names) else f"event {event_id}"
+            events.append({
+                "name": name, "ph": "B", "ts": start, "pid": 0, "tid": core, "args": {"arg": arg},
+            })
+
+    cores = sorted({core for core, _, _ in rings})
+    metadata = [{"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "shirokuma"}}]
+    metadata += [
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": f"core {core}"}}
+        for core in cores
+    ]
+    return metadata + sorted(events, key=lambda event: event["ts"]), unmatched
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("log", type=pathlib.Path, help="serial output with perftrace dumps")
+    parser.add_argument("trace", type=pathlib.Path, help="Chrome trace JSON to write")
+    parser.add_argument("--defs", type=pathlib.Path, default=REPO / "perf_trace_events.def")
+    args = parser.parse_args()
+
+    rings = parse_log(args.log.read_text(errors="replace"))
+    if not rings:
+        sys.exit(f"no perftrace dumps in {args.log}")
+
+    events, unmatched = convert(rings, load_names(args.defs))
+    args.trace.write_text(json.dumps({"traceEvents": events, "displayTimeUnit": "ms"}))
+
+    records = sum(len(records) for _, _, records in rings)
+    overwritten = sum(overwritten for _, overwritten, _ in rings)
+    print(f"{records} records from {len(rings)} rings written to {args.trace}")
+    if overwritten or unmatched:
+        print(f"{overwritten} records were overwritten before their dump, "
+              f"{unmatched} span ends had no begin")
+
+
+if __name__ == "__main__":
+    main()